@@ -1,9 +1,9 @@
 #version 140
-in vec3 aPos;
-in vec3 aNormal;
+// Packed vertex layout, decoded the same way as in modelView.vs
+in vec4 aPos;
+in vec2 aNormal;
 in vec2 aTexCoords;
-in vec3 aTangent;
-in vec3 aBitangent;
+in vec4 aTangent;
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -11,14 +11,29 @@ out vec2 TexCoords;
 out float Depth;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec3 _CameraPosition;
+};
+
+vec3 DecodeOctahedral(vec2 encoded);
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    FragPos = vec3(model * vec4(aPos.xyz / aPos.w, 1.0));
+    Normal = mat3(transpose(inverse(model))) * DecodeOctahedral(aNormal);
     TexCoords = aTexCoords;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 	Depth = gl_Position.z;
+}
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.x += (direction.x >= 0.0) ? -fold : fold;
+	direction.y += (direction.y >= 0.0) ? -fold : fold;
+	return normalize(direction);
 }
\ No newline at end of file
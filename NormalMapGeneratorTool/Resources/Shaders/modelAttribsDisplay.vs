@@ -1,30 +1,23 @@
 #version 150
+// Normal and tangent lines built by ModelObject::drawAttributeLines
 in vec3 aPos;
-in vec3 aNormal;
-in vec2 aTexCoords;
-in vec3 aTangent;
-in vec3 aBitangent;
+in vec4 aOffset;
 
-out vec3 FragPos;
-out vec3 Normal;
-out mat3 TBN;
+out vec3 AttribColour;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform float _NormalsLength;
+layout(std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec3 _CameraPosition;
+};
 
 void main()
 {
-    vec3 _aPos = aPos + aNormal * 0.01;
-    FragPos = (model * vec4(_aPos, 1.0)).xyz;
-    Normal =  (model * view * vec4(aNormal,0.0)).xyz;
-
-    vec3 T = (model * vec4(aTangent,0.0)).xyz;
-    vec3 N = (model * vec4(aNormal, 0.0)).xyz;
-    T = normalize(T - dot(T, N) * N);
-    vec3 B = (model * vec4(aBitangent, 0.0)).xyz;
-
-    TBN = mat3(T, B, N);
-
-    gl_Position = projection * view * vec4(FragPos, 1.0);
-}
\ No newline at end of file
+	AttribColour = (aOffset.w > 0.5) ? vec3(1,0,0) : vec3(0,1,0);
+	vec3 direction = (model * vec4(aOffset.xyz, 0.0)).xyz;
+	vec3 position = (model * vec4(aPos, 1.0)).xyz + direction * _NormalsLength;
+	gl_Position = projection * view * vec4(position, 1.0);
+}
@@ -1,4 +1,5 @@
 #version 140
+// Mode uniforms become constants when ShaderVariantSet defines them, so each variant only keeps the branches it uses
 out vec4 FragColor;
 
 in vec3 FragPos;
@@ -7,54 +8,64 @@ in vec2 TexCoords;
 in mat3 TBN;
 
 uniform sampler2D heightmapTexture;
+//Tangent space normals baked from the heightmap, or the blended layer output
+uniform sampler2D normalmapTexture;
 uniform sampler2D albedomapTexture;
 uniform sampler2D metalnessmapTexture;
 uniform sampler2D roughnessmapTexture;
 uniform sampler2D mapcapTexture;
 
-uniform samplerCube skybox;
-uniform vec3 diffuseColour;
-uniform vec3 lightColour;
-uniform vec3 lightPos;
-uniform vec3 _CameraPosition;
-uniform float _HeightmapStrength;
-uniform float _HeightmapDimX;
-uniform float _HeightmapDimY;
-uniform float _Roughness;
-uniform float _Metalness;
-uniform float _LightIntensity;
+//Environment convolved with GGX lobes, roughness goes from 0 at the base mip to 1 at _PrefilteredMaxLod
+uniform samplerCube prefilteredEnvironment;
+//Split sum scale and bias to F0 by NdotV and roughness
+uniform sampler2D brdfLUT;
+layout(std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec3 _CameraPosition;
+};
+layout(std140) uniform PreviewLightingBlock
+{
+	vec3 lightPos;
+	float _LightIntensity;
+	vec3 lightColour;
+	float _Roughness;
+	vec3 diffuseColour;
+	float _Metalness;
+	float _HeightmapStrength;
+	float _HeightmapDimX;
+	float _HeightmapDimY;
+	//Diffuse irradiance / PI of the environment as spherical harmonics, see IrradianceSH
+	vec4 _IrradianceSH[9];
+	float _PrefilteredMaxLod;
+};
+#ifdef NORMAL_MAP_MODE
+const int _normalMapModeOn = NORMAL_MAP_MODE;
+#else
 uniform int _normalMapModeOn;
-uniform bool _flipX_Ydir;
+#endif
+#ifdef USE_MATCAP
+const bool _Use_Matcap = (USE_MATCAP != 0);
+#else
 uniform bool _Use_Matcap;
-uniform int _MethodIndex; // 0 - Method 1, 1 - Method 2
+#endif
 
 const float PI = 3.14159265359;
 float DistributionGGX(vec3 N, vec3 H, float roughness);
 float GeometrySchlickGGX(float NdotV, float roughness);
 float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
 vec3 fresnelSchlick(float cosTheta, vec3 F0);
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness);
+vec3 IrradianceSH(vec3 n);
 vec4 PBR_Colour(vec3 Normal, vec3 camPos, vec3 WorldPos, vec3 albedo, float metallic, float roughness, vec3 lightPositions);
-vec3 TriSample(sampler2D inTexture ,vec2 TexCoords, float xOffset, float yOffset);
-vec3 SobelNormal(sampler2D inTexture, vec2 TexCoords, float xOffset, float yOffset);
 vec4 LightingRamp(vec3 lightDir, vec3 viewDir, vec3 normal, sampler2D tex, float atten);
 
 void main()
 {
 	if(_normalMapModeOn == 2 || _normalMapModeOn == 3)
     {
-		float xOffset = 1.0/_HeightmapDimX;
-		float yOffset = 1.0/_HeightmapDimY;
-        vec3 norm;
-		if(_MethodIndex == 0) //For method 1
-			norm = TriSample(heightmapTexture, TexCoords, xOffset, yOffset);
-		else if(_MethodIndex == 1)//For method 2
-			norm = SobelNormal(heightmapTexture, TexCoords, xOffset, yOffset);
-		else if(_MethodIndex == 2)
-			norm = texture(heightmapTexture, TexCoords).rgb * 2.0 - 1.0;
-
-		norm = normalize(norm);
-		if(_flipX_Ydir == true)
-			norm = norm.grb;
+        vec3 norm = normalize(texture(normalmapTexture, TexCoords).rgb * 2.0 - 1.0);
 
         if(_normalMapModeOn == 3)
 		{
@@ -89,90 +100,6 @@ void main()
 	}
 }
 
-vec3 TriSample(sampler2D inTexture ,vec2 TexCoords, float xOffset, float yOffset)
-{
-	float currentPx = texture(inTexture,TexCoords).x;
-
-    float n = texture(inTexture,vec2(TexCoords.x, TexCoords.y + yOffset)).r;
-    float s = texture(inTexture,vec2(TexCoords.x, TexCoords.y - yOffset)).r;
-    float e = texture(inTexture,vec2(TexCoords.x - xOffset, TexCoords.y)).r;
-    float w = texture(inTexture,vec2(TexCoords.x + xOffset, TexCoords.y)).r;
-
-     vec3 norm;
-
-	n *= _HeightmapStrength * 0.01;
-	s *= _HeightmapStrength * 0.01;
-	e *= _HeightmapStrength * 0.01;
-	w *= _HeightmapStrength * 0.01;
-
-	yOffset = xOffset = 0.002;//Uniform distance for triangle points
-	//Point 1 north
-	vec3 point1 = vec3(0, n, 0);
-	point1.xz = vec2(TexCoords.x, TexCoords.y + yOffset);
-	//Point 2 west
-	vec3 point2 = vec3(0, w, 0);
-	point2.xz = vec2(TexCoords.x + xOffset, TexCoords.y);
-	//Point 3 center
-	vec3 point3 = vec3(0, currentPx, 0);
-	point3.xz = TexCoords;
-	//Point 4 south
-	vec3 point4 = vec3(0, s, 0);
-	point4.xz = vec2(TexCoords.x, TexCoords.y - yOffset);
-	//Point 5 east
-	vec3 point5 = vec3(0, e, 0);
-	point5.xz = vec2(TexCoords.x - xOffset, TexCoords.y);
-
-	vec3 v1 = point1 - point3;
-	vec3 v2 = point2 - point3;
-
-	vec3 v3 = point4 - point3;
-	vec3 v4 = point5 - point3;
-
-	vec3 v5 = point5 - point3;
-	vec3 v6 = point1 - point3;
-
-	vec3 v7 = point2 - point3;
-	vec3 v8 = point4 - point3;
-
-	vec3 frNorm = normalize(cross(v1, v2));
-	vec3 secNorm = normalize(cross(v3, v4));
-	vec3 thrNorm = normalize(cross(v5, v6));
-	vec3 fourNorm = normalize(cross(v7, v8));
-
-	norm = frNorm + secNorm + thrNorm + fourNorm;
-	norm.rgb = norm.rbg;
-	norm.rg = -norm.rg;
-
-	return norm;
-}
-vec3 SobelNormal(sampler2D inTexture, vec2 TexCoords, float xOffset, float yOffset)
-{
-	vec3 norm;
-	float currentPx = texture(inTexture,TexCoords).x;
-	float n = texture(inTexture,vec2(TexCoords.x, TexCoords.y + yOffset)).r;
-    float s = texture(inTexture,vec2(TexCoords.x, TexCoords.y - yOffset)).r;
-    float e = texture(inTexture,vec2(TexCoords.x - xOffset, TexCoords.y)).r;
-    float w = texture(inTexture,vec2(TexCoords.x + xOffset, TexCoords.y)).r;
-
-	float ne = texture(inTexture,vec2(TexCoords.x - xOffset, TexCoords.y + yOffset)).r;
-	float nw = texture(inTexture,vec2(TexCoords.x + xOffset, TexCoords.y + yOffset)).r;
-	float se = texture(inTexture,vec2(TexCoords.x - xOffset, TexCoords.y - yOffset)).r;
-	float sw = texture(inTexture,vec2(TexCoords.x + xOffset, TexCoords.y - yOffset)).r;
-	//           -1 0 1
-	//           -2 0 2
-	//           -1 0 1
-	float dX = nw + 2*w + sw -ne - 2*e - se;
-	//           -1-2-1
-	//            0 0 0
-	//            1 2 1
-	float dY = se + 2*s + sw -ne - 2*n - nw;
-	dX *= _HeightmapStrength * currentPx;
-	dY *= _HeightmapStrength * currentPx;
-	norm = vec3(dX, dY, 1.0);
-	norm.g = -norm.g;
-
-	return norm;
-}
 float DistributionGGX(vec3 N, vec3 H, float roughness)
 {
     float a = roughness*roughness;
@@ -209,9 +136,19 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0)
 {
     return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
 }
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
+{
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(1.0 - cosTheta, 5.0);
+}
+vec3 IrradianceSH(vec3 n)
+{
+    return _IrradianceSH[0].rgb + _IrradianceSH[1].rgb * n.y + _IrradianceSH[2].rgb * n.z + _IrradianceSH[3].rgb * n.x +
+        _IrradianceSH[4].rgb * (n.x * n.y) + _IrradianceSH[5].rgb * (n.y * n.z) + _IrradianceSH[6].rgb * (3.0 * n.z * n.z - 1.0) +
+        _IrradianceSH[7].rgb * (n.x * n.z) + _IrradianceSH[8].rgb * (n.x * n.x - n.y * n.y);
+}
 vec4 PBR_Colour(vec3 Normal, vec3 camPos, vec3 WorldPos, vec3 albedo, float metallic, float roughness, vec3 lightPositions)
 {
-    float ao = 5.0;//texture(aoMap, TexCoords).r;
+    float ao = 1.0;//texture(aoMap, TexCoords).r;
 
     vec3 N = Normal;
     vec3 V = normalize(camPos - WorldPos);
@@ -258,9 +195,15 @@ vec4 PBR_Colour(vec3 Normal, vec3 camPos, vec3 WorldPos, vec3 albedo, float meta
         Lo += (kD * albedo / PI + specular) * radiance * NdotL;  // note that we already multiplied the BRDF by the Fresnel (kS) so we won't multiply by kS again
     }   
     
-    // ambient lighting (note that the next IBL tutorial will replace 
-    // this ambient lighting with environment lighting).
-    vec3 ambient = vec3(0.03) * albedo * ao;
+    // ambient lighting from the environment, split sum specular with the baked lobes
+    float NdotV = max(dot(N, V), 0.0);
+    float iblRoughness = clamp(roughness, 0.0, 1.0);
+    vec3 F = fresnelSchlickRoughness(NdotV, F0, iblRoughness);
+    vec3 kD = (vec3(1.0) - F) * (1.0 - metallic);
+    vec3 diffuse = kD * albedo * max(IrradianceSH(N), vec3(0.0));
+    vec3 prefilteredColour = textureLod(prefilteredEnvironment, reflect(-V, N), iblRoughness * _PrefilteredMaxLod).rgb;
+    vec2 brdf = texture(brdfLUT, vec2(NdotV, iblRoughness)).rg;
+    vec3 ambient = (diffuse + prefilteredColour * (F * brdf.x + brdf.y)) * ao;
     
     vec3 color = ambient + Lo;
 
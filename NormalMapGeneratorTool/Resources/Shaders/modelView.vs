@@ -1,9 +1,10 @@
 #version 150
-in vec3 aPos;
-in vec3 aNormal;
+// Packed vertex : position / w (w is 1 for float positions), octahedral normal, half float uv,
+// octahedral tangent with the bitangent sign in w
+in vec4 aPos;
+in vec2 aNormal;
 in vec2 aTexCoords;
-in vec3 aTangent;
-in vec3 aBitangent;
+in vec4 aTangent;
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -11,21 +12,41 @@ out vec2 TexCoords;
 out mat3 TBN;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec3 _CameraPosition;
+};
+
+vec3 DecodeOctahedral(vec2 encoded);
 
 void main()
 {
-    FragPos = (model * vec4(aPos, 1.0)).xyz;
-    Normal =  (model * view * vec4(aNormal,0.0)).xyz;
+    vec3 normal = DecodeOctahedral(aNormal);
+    vec3 tangent = DecodeOctahedral(aTangent.xy);
+    vec3 bitangent = cross(normal, tangent) * aTangent.w;
+
+    FragPos = (model * vec4(aPos.xyz / aPos.w, 1.0)).xyz;
+    Normal =  (model * view * vec4(normal,0.0)).xyz;
     TexCoords = aTexCoords;
 
-    vec3 T = (model * vec4(aTangent,0.0)).xyz;
-    vec3 N = (model * vec4(aNormal, 0.0)).xyz;
+    vec3 T = (model * vec4(tangent,0.0)).xyz;
+    vec3 N = (model * vec4(normal, 0.0)).xyz;
     T = normalize(T - dot(T, N) * N);
-    vec3 B = (model * vec4(aBitangent, 0.0)).xyz;//cross(N, T);
+    vec3 B = (model * vec4(bitangent, 0.0)).xyz;
 
     TBN = mat3(T, B, N);
 
     gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+
+//Inverse of VertexPacking::encodeOctahedral
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-direction.z, 0.0);
+	direction.x += (direction.x >= 0.0) ? -fold : fold;
+	direction.y += (direction.y >= 0.0) ? -fold : fold;
+	return normalize(direction);
 }
\ No newline at end of file
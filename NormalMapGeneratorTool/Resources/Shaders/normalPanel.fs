@@ -1,24 +1,44 @@
 #version 140
+// Mode uniforms become constants when ShaderVariantSet defines them, so each variant only keeps the branches it uses
 in vec2 textureUV;
 in vec3 worldPos;
 out vec4 color;
 uniform sampler2D textureOne;
 uniform sampler2D textureTwo;
-uniform vec3 lightDir;
 uniform float _HeightmapStrength;
-uniform float _HeightmapDimX;
-uniform float _HeightmapDimY;
-uniform float _Specularity;
-uniform float _SpecularStrength;
-uniform float _LightIntensity;
+layout(std140) uniform NormalViewBlock
+{
+	vec3 lightDir;
+	float _HeightmapDimX;
+	float _HeightmapDimY;
+	float _Specularity;
+	float _SpecularStrength;
+	float _LightIntensity;
+	bool _flipX_Ydir;
+	int _Channel_R;
+	int _Channel_G;
+	int _Channel_B;
+};
+#ifdef NORMAL_MAP_MODE
+const int _normalMapModeOn = NORMAL_MAP_MODE;
+#else
 uniform int _normalMapModeOn;
-uniform bool _flipX_Ydir;
-uniform int _Channel_R;
-uniform int _Channel_G;
-uniform int _Channel_B;
+#endif
+#ifdef METHOD_INDEX
+const int _MethodIndex = METHOD_INDEX;
+#else
 uniform int _MethodIndex; // 0 - Method 1, 1 - Method 2
+#endif
+#ifdef USE_NORMAL_INPUT
+const int _UseNormalInput = USE_NORMAL_INPUT;
+#else
 uniform int _UseNormalInput; // 1 - true, 0 - false;
+#endif
+#ifdef NORMAL_BLENDING_METHOD
+const int _NormalBlendingMethod = NORMAL_BLENDING_METHOD;
+#else
 uniform int _NormalBlendingMethod; //-0:- RNB, 1:- UB, 2:- PDB
+#endif
 
 // Inputs will be in -1.0 to +1.0 range for blending methods
 vec3 blend_rnm(vec3 n1, vec3 n2);
@@ -44,7 +64,8 @@ void main()
 	}
 	else
 	{
-		if(_normalMapModeOn == 1 || _normalMapModeOn == 2)
+		//Mode 4 is mode 1 without the channel mask, it bakes the normals sampled by the 3D preview
+		if(_normalMapModeOn == 1 || _normalMapModeOn == 2 || _normalMapModeOn == 4)
 		{
 			float xOffset = 1.0/_HeightmapDimX;
 			float yOffset = 1.0/_HeightmapDimY;
@@ -76,7 +97,8 @@ void main()
 			else
 			{
 				color = vec4(norm * 0.5 + 0.5,1.0);
-				color.rgb *= vec3(_Channel_R, _Channel_G, _Channel_B);
+				if(_normalMapModeOn == 1)
+					color.rgb *= vec3(_Channel_R, _Channel_G, _Channel_B);
 			}
 		}
 		else
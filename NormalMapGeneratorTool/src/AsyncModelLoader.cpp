@@ -0,0 +1,186 @@
+#include "AsyncModelLoader.h"
+#include <iostream>
+#include <algorithm>
+
+AsyncModelLoader::AsyncModelLoader() : generation(0), isBusy(false), progress(0.0f)
+{
+}
+
+void AsyncModelLoader::init(const std::function<void()>& onLoadFinished)
+{
+	this->onLoadFinished = onLoadFinished;
+	isStopping = false;
+	workerThread = std::thread(&AsyncModelLoader::workerLoop, this);
+}
+
+void AsyncModelLoader::loadModel(const std::string& path, const MeshLoadingSystem::MeshLoader& meshLoader)
+{
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		generation++;
+		requestedPath = path;
+		requestedLoader = meshLoader;
+		loadingPath = path;
+		hasRequest = true;
+		hasResult = false;
+		loadedMesh = PackedMesh();
+		hasLods = false;
+		loadedLods = PackedMesh();
+		progress = 0.0f;
+		isBusy = true;
+	}
+	requestCondition.notify_one();
+}
+
+void AsyncModelLoader::cancel()
+{
+	std::lock_guard<std::mutex> lock(loadMutex);
+	generation++;
+	hasRequest = false;
+	hasResult = false;
+	loadedMesh = PackedMesh();
+	hasLods = false;
+	loadedLods = PackedMesh();
+	isBusy = false;
+}
+
+bool AsyncModelLoader::isLoading()const noexcept
+{
+	return isBusy;
+}
+
+float AsyncModelLoader::getProgress()const noexcept
+{
+	return progress;
+}
+
+std::string AsyncModelLoader::getLoadingPath()
+{
+	std::lock_guard<std::mutex> lock(loadMutex);
+	return loadingPath;
+}
+
+ModelObject* AsyncModelLoader::takeLoadedModel()
+{
+	PackedMesh packedMesh;
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		if (!hasResult)
+			return nullptr;
+		packedMesh = std::move(loadedMesh);
+		hasResult = false;
+	}
+	ModelObject* model = new ModelObject();
+	model->updateMeshData(packedMesh.vertices.data(), packedMesh.vertexCount, packedMesh.format,
+		packedMesh.indices.data(), static_cast<int>(packedMesh.indices.size()));
+	model->setParts(packedMesh.parts.data(), packedMesh.parts.size(), packedMesh.lodCount);
+	return model;
+}
+
+bool AsyncModelLoader::takeLoadedLods(ModelObject& model)
+{
+	PackedMesh lods;
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		if (!hasLods)
+			return false;
+		lods = std::move(loadedLods);
+		hasLods = false;
+	}
+	model.updateIndices(lods.indices.data(), static_cast<int>(lods.indices.size()));
+	model.setParts(lods.parts.data(), lods.parts.size(), lods.lodCount);
+	return true;
+}
+
+void AsyncModelLoader::shutDown()
+{
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		generation++;
+		isStopping = true;
+		hasRequest = false;
+	}
+	requestCondition.notify_all();
+	if (workerThread.joinable())
+		workerThread.join();
+	hasResult = false;
+	loadedMesh = PackedMesh();
+	hasLods = false;
+	loadedLods = PackedMesh();
+	isBusy = false;
+}
+
+AsyncModelLoader::~AsyncModelLoader()
+{
+	shutDown();
+}
+
+void AsyncModelLoader::workerLoop()
+{
+	while (true)
+	{
+		std::string path;
+		MeshLoadingSystem::MeshLoader meshLoader;
+		unsigned int loadGeneration;
+		{
+			std::unique_lock<std::mutex> lock(loadMutex);
+			requestCondition.wait(lock, [this]() { return isStopping || hasRequest; });
+			if (isStopping)
+				return;
+			path = std::move(requestedPath);
+			meshLoader = requestedLoader;
+			hasRequest = false;
+			loadGeneration = generation;
+		}
+
+		auto updateProgress = [this, loadGeneration](float fraction)
+		{
+			if (generation != loadGeneration)
+				return false;
+			if (fraction >= 0.0f)
+				progress = std::max(progress.load(), fraction);
+			return true;
+		};
+		PackedMesh packedMesh;
+		const bool isLoaded = meshLoader.loadPackedMesh(path, packedMesh, updateProgress);
+		//The mesh is kept to simplify once the full detail copy has been handed over
+		const bool shouldBuildLods = isLoaded && MeshSimplifier::needsLods(packedMesh);
+
+		{
+			std::lock_guard<std::mutex> lock(loadMutex);
+			//Cancelled or replaced by a newer request while importing
+			if (generation != loadGeneration)
+				continue;
+			isBusy = false;
+			if (isLoaded)
+			{
+				loadedMesh = (shouldBuildLods) ? packedMesh : std::move(packedMesh);
+				hasResult = true;
+			}
+			else
+				std::cout << "\nCould not load model : " << path;
+		}
+		if (onLoadFinished)
+			onLoadFinished();
+		if (!shouldBuildLods)
+			continue;
+
+		auto isCurrentLoad = [this, loadGeneration](float)
+		{
+			return generation == loadGeneration;
+		};
+		if (!meshLoader.buildLods(path, packedMesh, isCurrentLoad))
+			continue;
+		{
+			std::lock_guard<std::mutex> lock(loadMutex);
+			if (generation != loadGeneration)
+				continue;
+			loadedLods.lodCount = packedMesh.lodCount;
+			loadedLods.indices = std::move(packedMesh.indices);
+			loadedLods.parts = std::move(packedMesh.parts);
+			hasLods = true;
+		}
+		if (onLoadFinished)
+			onLoadFinished();
+	}
+}
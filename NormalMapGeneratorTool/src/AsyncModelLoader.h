@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include "MeshLoadingSystem.h"
+/*
+Imports preview models on a worker thread so picking a large custom model does not stall the UI
+Only the latest requested model matters, starting a new load cancels the one in flight. The finished mesh is
+uploaded into a ModelObject on the GL thread when it is taken. Heavy models are handed over at full detail first and
+their LODs are built afterwards on the same thread
+*/
+class AsyncModelLoader
+{
+private:
+	std::thread workerThread;
+	std::mutex loadMutex;
+	std::condition_variable requestCondition;
+	std::string requestedPath;
+	MeshLoadingSystem::MeshLoader requestedLoader;
+	bool hasRequest = false;
+	bool hasResult = false;
+	bool isStopping = false;
+	PackedMesh loadedMesh;
+	bool hasLods = false;
+	//Indices and parts of every LOD of the model that was taken last
+	PackedMesh loadedLods;
+	//Incremented by every request and cancel, a load whose generation is outdated stops at its next progress update
+	std::atomic<unsigned int> generation;
+	std::atomic<bool> isBusy;
+	std::atomic<float> progress;
+	std::string loadingPath;
+	std::function<void()> onLoadFinished;
+public:
+	AsyncModelLoader();
+	AsyncModelLoader(const AsyncModelLoader&) = delete;
+	AsyncModelLoader& operator=(const AsyncModelLoader&) = delete;
+	//Start the import thread, onLoadFinished is called from it whenever a load succeeds or fails and when LODs are ready
+	void init(const std::function<void()>& onLoadFinished = nullptr);
+	//Import path with a copy of meshLoader's settings, so changing them later does not affect this load
+	void loadModel(const std::string& path, const MeshLoadingSystem::MeshLoader& meshLoader);
+	void cancel();
+	//True while a model is queued or being imported
+	bool isLoading()const noexcept;
+	//Fraction of the current load that is done
+	float getProgress()const noexcept;
+	//Path of the model being loaded, only valid while isLoading
+	std::string getLoadingPath();
+	//Upload the finished model, returns nullptr if no model finished since the last call. Called from the GL thread
+	ModelObject* takeLoadedModel();
+	//Give model, the one last returned by takeLoadedModel, the LODs built for it. Returns false if there are none yet
+	bool takeLoadedLods(ModelObject& model);
+	void shutDown();
+	~AsyncModelLoader();
+private:
+	void workerLoop();
+};
@@ -0,0 +1,223 @@
+#include "AsyncTextureLoader.h"
+#include <GL\glew.h>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include "Stb\stb_image.h"
+
+void AsyncTextureLoader::init(unsigned int workerCount, const std::function<void()>& onImageDecoded)
+{
+	isStopping = false;
+	this->onImageDecoded = onImageDecoded;
+	workerCount = std::max(1u, workerCount);
+	for (unsigned int i = 0; i < workerCount; i++)
+		workerThreads.emplace_back(&AsyncTextureLoader::workerLoop, this);
+}
+
+unsigned int AsyncTextureLoader::loadTexture(const std::string& path, bool linearColourSpace, TextureFilterType textureFilterType, const ColourData& placeholderColour)
+{
+	unsigned int textureId;
+	glGenTextures(1, &textureId);
+	const glm::vec4 colour = placeholderColour.getColour_8_Bit();
+	const unsigned char placeholder[4] = { static_cast<unsigned char>(colour.r), static_cast<unsigned char>(colour.g),
+		static_cast<unsigned char>(colour.b), static_cast<unsigned char>(colour.a) };
+	GL::bindTexture(TextureType::TEXTURE_2D, textureId);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureFilterType);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureFilterType);
+	GL::bindTexture(TextureType::TEXTURE_2D, 0);
+
+	Request request;
+	request.textureId = textureId;
+	request.linearColourSpace = linearColourSpace;
+	request.textureFilterType = textureFilterType;
+	request.paths.push_back(path);
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		activeTextureIds.insert(textureId);
+		pendingRequests.push_back(request);
+	}
+	requestCondition.notify_one();
+	return textureId;
+}
+
+unsigned int AsyncTextureLoader::loadCubemap(const std::vector<std::string>& paths)
+{
+	unsigned int textureId;
+	glGenTextures(1, &textureId);
+	const unsigned char placeholder[3] = { 128, 128, 128 };
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, textureId);
+	for (unsigned int i = 0; i < 6; i++)
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, 0);
+
+	Request request;
+	request.textureId = textureId;
+	request.isCubemap = true;
+	request.paths = paths;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		activeTextureIds.insert(textureId);
+		pendingRequests.push_back(request);
+	}
+	requestCondition.notify_one();
+	return textureId;
+}
+
+void AsyncTextureLoader::cancel(unsigned int textureId)
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	if (activeTextureIds.find(textureId) == activeTextureIds.end())
+		return;
+	const auto requestIt = std::find_if(pendingRequests.begin(), pendingRequests.end(), [textureId](const Request& request) { return request.textureId == textureId; });
+	if (requestIt != pendingRequests.end())
+	{
+		pendingRequests.erase(requestIt);
+		activeTextureIds.erase(textureId);
+		return;
+	}
+	//Already being decoded or waiting for upload, it is dropped once it reaches processUploads
+	cancelledTextureIds.insert(textureId);
+}
+
+bool AsyncTextureLoader::processUploads(double timeBudgetMs)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	bool hasUploaded = false;
+	do
+	{
+		Result result;
+		bool isCancelled;
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if (finishedResults.empty())
+				return hasUploaded;
+			result = std::move(finishedResults.front());
+			finishedResults.pop_front();
+			isCancelled = cancelledTextureIds.erase(result.request.textureId) != 0;
+			activeTextureIds.erase(result.request.textureId);
+		}
+		if (!isCancelled)
+		{
+			upload(result);
+			hasUploaded = true;
+		}
+		for (DecodedImage& image : result.images)
+			stbi_image_free(image.data);
+	} while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() < timeBudgetMs);
+	return hasUploaded;
+}
+
+bool AsyncTextureLoader::isIdle()
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return activeTextureIds.empty();
+}
+
+void AsyncTextureLoader::shutDown()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		isStopping = true;
+		pendingRequests.clear();
+	}
+	requestCondition.notify_all();
+	for (std::thread& workerThread : workerThreads)
+	{
+		if (workerThread.joinable())
+			workerThread.join();
+	}
+	workerThreads.clear();
+	for (Result& result : finishedResults)
+	{
+		for (DecodedImage& image : result.images)
+			stbi_image_free(image.data);
+	}
+	finishedResults.clear();
+	activeTextureIds.clear();
+	cancelledTextureIds.clear();
+}
+
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+	shutDown();
+}
+
+void AsyncTextureLoader::workerLoop()
+{
+	//TextureManager changes the global flip flag on the main thread, so workers set their own to load textures bottom row first
+	stbi_set_flip_vertically_on_load_thread(1);
+	while (true)
+	{
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			requestCondition.wait(lock, [this]() { return isStopping || !pendingRequests.empty(); });
+			if (isStopping)
+				return;
+			request = std::move(pendingRequests.front());
+			pendingRequests.pop_front();
+		}
+
+		Result result;
+		result.request = std::move(request);
+		for (const std::string& path : result.request.paths)
+		{
+			DecodedImage image;
+			int componentCount;
+			image.data = stbi_load(path.c_str(), &image.width, &image.height, &componentCount, result.request.isCubemap ? 3 : 4);
+			if (image.data == nullptr)
+				std::cout << "\nTexture failed to load at path: " << path;
+			result.images.push_back(image);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if (isStopping)
+			{
+				for (DecodedImage& image : result.images)
+					stbi_image_free(image.data);
+				return;
+			}
+			finishedResults.push_back(std::move(result));
+		}
+		if (onImageDecoded)
+			onImageDecoded();
+	}
+}
+
+void AsyncTextureLoader::upload(Result& result)
+{
+	const Request& request = result.request;
+	if (request.isCubemap)
+	{
+		GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, request.textureId);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (unsigned int i = 0; i < result.images.size() && i < 6; i++)
+		{
+			const DecodedImage& image = result.images[i];
+			if (image.data != nullptr)
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_SRGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, 0);
+		return;
+	}
+	const DecodedImage& image = result.images.front();
+	if (image.data == nullptr)
+		return;
+	GL::bindTexture(TextureType::TEXTURE_2D, request.textureId);
+	glTexImage2D(GL_TEXTURE_2D, 0, request.linearColourSpace ? GL_RGBA : GL_SRGB_ALPHA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	GL::bindTexture(TextureType::TEXTURE_2D, 0);
+}
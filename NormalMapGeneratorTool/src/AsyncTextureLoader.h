@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
+#include <functional>
+#include "GLutil.h"
+#include "ColourData.h"
+/*
+Decodes image files on worker threads and uploads them from the GL thread
+Texture ids are handed out straight away and hold a 1x1 placeholder until the decoded image is uploaded into them,
+so callers can store and bind the id as if the texture had been loaded synchronously
+*/
+class AsyncTextureLoader
+{
+private:
+	struct Request
+	{
+		unsigned int textureId = 0;
+		bool isCubemap = false;
+		bool linearColourSpace = false;
+		TextureFilterType textureFilterType = TextureFilterType::LINEAR;
+		std::vector<std::string> paths;
+	};
+	struct DecodedImage
+	{
+		unsigned char* data = nullptr;
+		int width = 0;
+		int height = 0;
+	};
+	struct Result
+	{
+		Request request;
+		std::vector<DecodedImage> images;
+	};
+
+	std::vector<std::thread> workerThreads;
+	std::mutex queueMutex;
+	std::condition_variable requestCondition;
+	std::deque<Request> pendingRequests;
+	std::deque<Result> finishedResults;
+	//Ids with a request that has not been uploaded or dropped yet
+	std::unordered_set<unsigned int> activeTextureIds;
+	std::unordered_set<unsigned int> cancelledTextureIds;
+	bool isStopping = false;
+	std::function<void()> onImageDecoded;
+public:
+	AsyncTextureLoader() = default;
+	AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+	AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+	//Start the decoding threads, onImageDecoded is called from a decoding thread whenever an image is ready for upload
+	void init(unsigned int workerCount, const std::function<void()>& onImageDecoded = nullptr);
+	//Queue a 2D texture, the returned id shows placeholderColour until the image has been uploaded
+	unsigned int loadTexture(const std::string& path, bool linearColourSpace = false, TextureFilterType textureFilterType = TextureFilterType::LINEAR,
+		const ColourData& placeholderColour = ColourData(1, 1, 1, 1));
+	//Queue a cubemap from 6 face images in +X, -X, +Y, -Y, +Z, -Z order
+	unsigned int loadCubemap(const std::vector<std::string>& paths);
+	//Stop a queued texture from being uploaded, has to be called before the texture id is deleted
+	void cancel(unsigned int textureId);
+	//Upload decoded images until timeBudgetMs runs out, at least one image is uploaded per call. Called once per frame from the GL thread
+	//Returns true if any image was uploaded
+	bool processUploads(double timeBudgetMs);
+	//True when nothing is queued, being decoded or waiting for upload
+	bool isIdle();
+	//Stop the decoding threads, images that were not uploaded yet keep their placeholder
+	void shutDown();
+	~AsyncTextureLoader();
+private:
+	void workerLoop();
+	void upload(Result& result);
+};
@@ -0,0 +1,366 @@
+#include "AutosaveJournal.h"
+#include <iostream>
+#include <cstring>
+#include <filesystem>
+#include "HashUtility.h"
+#include "NoraFileHandler.h"
+
+namespace
+{
+	const uint32_t JOURNAL_VERSION = 1;
+	const uint32_t TILE_RECORD_MAGIC = 0x454C4954; // "TILE"
+	//The journal is compacted once it is this many times larger than the latest version of every tile
+	const uint64_t COMPACTION_RATIO = 3;
+	const uint64_t COMPACTION_MIN_SIZE = 16 * 1024 * 1024;
+}
+
+AutosaveJournal::AutosaveJournal()
+{
+	std::memset(&currentHeader, 0, sizeof(AutosaveJournalHeader));
+}
+
+void AutosaveJournal::init(const std::string& journalPath)
+{
+	this->journalPath = journalPath;
+	isStopping = false;
+	writerThread = std::thread(&AutosaveJournal::writerLoop, this);
+}
+
+void AutosaveJournal::reset(const std::string& basePath, const TextureData& texData)
+{
+	width = texData.getRes().x;
+	height = texData.getRes().y;
+	componentCount = texData.getComponentCount();
+	tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	dirtyTiles.assign(static_cast<size_t>(tileCountX) * tileCountY, 0);
+	hasDirtyTiles = false;
+
+	Job job;
+	job.type = JobType::RESET;
+	std::memcpy(job.header.magic, "NRAJ", 4);
+	job.header.version = JOURNAL_VERSION;
+	job.header.width = static_cast<uint32_t>(width);
+	job.header.height = static_cast<uint32_t>(height);
+	job.header.componentCount = static_cast<uint32_t>(componentCount);
+	job.header.tileSize = TILE_SIZE;
+	job.header.basePathLength = static_cast<uint32_t>(basePath.size());
+	job.header.checksum = computeHeaderChecksum(job.header, basePath);
+	job.basePath = basePath;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		pendingJobs.push_back(std::move(job));
+	}
+	jobCondition.notify_one();
+}
+
+void AutosaveJournal::markDirtyRegion(int startX, int endX, int startY, int endY)
+{
+	startX = glm::max(startX, 0);
+	startY = glm::max(startY, 0);
+	endX = glm::min(endX, width);
+	endY = glm::min(endY, height);
+	if (startX >= endX || startY >= endY)
+		return;
+	for (int ty = startY / TILE_SIZE; ty <= (endY - 1) / TILE_SIZE; ty++)
+	{
+		for (int tx = startX / TILE_SIZE; tx <= (endX - 1) / TILE_SIZE; tx++)
+			dirtyTiles[ty * tileCountX + tx] = 1;
+	}
+	hasDirtyTiles = true;
+}
+
+void AutosaveJournal::markAllDirty()
+{
+	std::fill(dirtyTiles.begin(), dirtyTiles.end(), 1);
+	hasDirtyTiles = !dirtyTiles.empty();
+}
+
+void AutosaveJournal::update(double currentTime, const TextureData& texData)
+{
+	if (!hasDirtyTiles || currentTime - lastCaptureTime < captureInterval)
+		return;
+	lastCaptureTime = currentTime;
+	capture(texData);
+}
+
+void AutosaveJournal::capture(const TextureData& texData)
+{
+	if (!hasDirtyTiles || texData.getTextureData() == nullptr)
+		return;
+	if (texData.getRes().x != width || texData.getRes().y != height || texData.getComponentCount() != componentCount)
+	{
+		std::cout << "\nAutosave journal does not match the heightmap, reset it when loading a new one";
+		return;
+	}
+	//Only the copy happens here, compression and disk access are done by the writer thread
+	Job job;
+	job.type = JobType::APPEND_TILES;
+	const unsigned char* const data = texData.getTextureData();
+	for (int ty = 0; ty < tileCountY; ty++)
+	{
+		for (int tx = 0; tx < tileCountX; tx++)
+		{
+			unsigned char& isDirty = dirtyTiles[ty * tileCountX + tx];
+			if (!isDirty)
+				continue;
+			isDirty = 0;
+			Tile tile;
+			tile.tileX = tx;
+			tile.tileY = ty;
+			tile.width = glm::min(TILE_SIZE, width - tx * TILE_SIZE);
+			tile.height = glm::min(TILE_SIZE, height - ty * TILE_SIZE);
+			const size_t rowSize = static_cast<size_t>(tile.width) * componentCount;
+			tile.pixels.resize(rowSize * tile.height);
+			for (uint32_t row = 0; row < tile.height; row++)
+			{
+				const size_t sourceOffset = (static_cast<size_t>(ty * TILE_SIZE + row) * width + tx * TILE_SIZE) * componentCount;
+				std::memcpy(&tile.pixels[row * rowSize], data + sourceOffset, rowSize);
+			}
+			job.tiles.push_back(std::move(tile));
+		}
+	}
+	hasDirtyTiles = false;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		pendingJobs.push_back(std::move(job));
+	}
+	jobCondition.notify_one();
+}
+
+void AutosaveJournal::shutDown(bool discardJournal)
+{
+	if (!writerThread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		if (discardJournal)
+		{
+			pendingJobs.clear();
+			Job job;
+			job.type = JobType::DISCARD;
+			pendingJobs.push_back(std::move(job));
+		}
+		isStopping = true;
+	}
+	jobCondition.notify_one();
+	writerThread.join();
+	if (journalFile.is_open())
+		journalFile.close();
+}
+
+void AutosaveJournal::writerLoop()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobCondition.wait(lock, [this] { return isStopping || !pendingJobs.empty(); });
+			if (pendingJobs.empty())
+				return;
+			job = std::move(pendingJobs.front());
+			pendingJobs.pop_front();
+		}
+		processJob(job);
+	}
+}
+
+void AutosaveJournal::processJob(Job& job)
+{
+	switch (job.type)
+	{
+	case JobType::RESET:
+		openJournal(job.header, job.basePath);
+		break;
+	case JobType::APPEND_TILES:
+		if (!journalFile.is_open())
+			return;
+		for (const Tile& tile : job.tiles)
+			appendTile(tile);
+		journalFile.flush();
+		if (journalSize > COMPACTION_MIN_SIZE && journalSize > COMPACTION_RATIO * liveRecordSize)
+			compact();
+		break;
+	case JobType::DISCARD:
+	{
+		if (journalFile.is_open())
+			journalFile.close();
+		latestRecords.clear();
+		std::error_code errorCode;
+		std::filesystem::remove(journalPath, errorCode);
+		break;
+	}
+	}
+}
+
+void AutosaveJournal::openJournal(const AutosaveJournalHeader& header, const std::string& basePath)
+{
+	if (journalFile.is_open())
+		journalFile.close();
+	latestRecords.clear();
+	liveRecordSize = 0;
+	sequence = 0;
+	currentHeader = header;
+	currentBasePath = basePath;
+
+	std::error_code errorCode;
+	const std::filesystem::path parentPath = std::filesystem::path(journalPath).parent_path();
+	if (!parentPath.empty())
+		std::filesystem::create_directories(parentPath, errorCode);
+	journalFile.open(journalPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!journalFile)
+	{
+		std::cout << "\nCould not create autosave journal : " << journalPath;
+		return;
+	}
+	journalFile.write(reinterpret_cast<const char*>(&header), sizeof(AutosaveJournalHeader));
+	journalFile.write(basePath.data(), basePath.size());
+	journalFile.flush();
+	journalSize = sizeof(AutosaveJournalHeader) + basePath.size();
+}
+
+void AutosaveJournal::appendTile(const Tile& tile)
+{
+	std::vector<unsigned char> compressed = NoraFileHandler::compressData(tile.pixels.data(), tile.pixels.size());
+	if (compressed.empty())
+		return;
+	AutosaveTileRecord record;
+	record.magic = TILE_RECORD_MAGIC;
+	record.sequence = sequence++;
+	record.tileX = tile.tileX;
+	record.tileY = tile.tileY;
+	record.width = tile.width;
+	record.height = tile.height;
+	record.storedSize = static_cast<uint32_t>(compressed.size());
+	record.checksum = computeRecordChecksum(record, compressed.data());
+
+	std::vector<unsigned char> recordBytes(sizeof(AutosaveTileRecord) + compressed.size());
+	std::memcpy(recordBytes.data(), &record, sizeof(AutosaveTileRecord));
+	std::memcpy(recordBytes.data() + sizeof(AutosaveTileRecord), compressed.data(), compressed.size());
+	journalFile.write(reinterpret_cast<const char*>(recordBytes.data()), recordBytes.size());
+	journalSize += recordBytes.size();
+
+	//Keep the latest record of every tile so the journal can be compacted without reading it back
+	const uint32_t tileCountX = (currentHeader.width + currentHeader.tileSize - 1) / currentHeader.tileSize;
+	std::vector<unsigned char>& latestRecord = latestRecords[tile.tileY * tileCountX + tile.tileX];
+	liveRecordSize -= latestRecord.size();
+	liveRecordSize += recordBytes.size();
+	latestRecord = std::move(recordBytes);
+}
+
+void AutosaveJournal::compact()
+{
+	const std::string tempPath = journalPath + ".tmp";
+	std::ofstream compactedFile(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!compactedFile)
+		return;
+	compactedFile.write(reinterpret_cast<const char*>(&currentHeader), sizeof(AutosaveJournalHeader));
+	compactedFile.write(currentBasePath.data(), currentBasePath.size());
+	for (const auto& latestRecord : latestRecords)
+		compactedFile.write(reinterpret_cast<const char*>(latestRecord.second.data()), latestRecord.second.size());
+	compactedFile.close();
+	if (compactedFile.fail())
+	{
+		std::filesystem::remove(tempPath);
+		return;
+	}
+
+	journalFile.close();
+	std::error_code errorCode;
+	std::filesystem::rename(tempPath, journalPath, errorCode);
+	if (errorCode)
+		std::cout << "\nCould not compact autosave journal : " << errorCode.message();
+	else
+		journalSize = sizeof(AutosaveJournalHeader) + currentBasePath.size() + liveRecordSize;
+	journalFile.open(journalPath.c_str(), std::ios::binary | std::ios::app);
+}
+
+bool AutosaveJournal::readJournalInfo(const std::string& journalPath, std::string& basePath, glm::ivec2& resolution, int& componentCount)
+{
+	std::ifstream file(journalPath.c_str(), std::ios::binary);
+	if (!file)
+		return false;
+	AutosaveJournalHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(AutosaveJournalHeader));
+	if (!file || std::memcmp(header.magic, "NRAJ", 4) != 0 || header.version != JOURNAL_VERSION || header.basePathLength > 4096)
+		return false;
+	basePath.resize(header.basePathLength);
+	file.read(&basePath[0], header.basePathLength);
+	if (!file || computeHeaderChecksum(header, basePath) != header.checksum)
+		return false;
+	//Nothing to recover when no tile was written after the header
+	if (file.peek() == std::ifstream::traits_type::eof())
+		return false;
+	resolution = glm::ivec2(header.width, header.height);
+	componentCount = static_cast<int>(header.componentCount);
+	return true;
+}
+
+int AutosaveJournal::replay(const std::string& journalPath, TextureData& texData)
+{
+	std::string basePath;
+	glm::ivec2 resolution;
+	int componentCount;
+	if (!readJournalInfo(journalPath, basePath, resolution, componentCount))
+		return 0;
+	if (texData.getRes() != resolution || texData.getComponentCount() != componentCount || texData.getTextureData() == nullptr)
+	{
+		std::cout << "\nAutosave journal does not match " << basePath;
+		return 0;
+	}
+	std::ifstream file(journalPath.c_str(), std::ios::binary);
+	file.seekg(sizeof(AutosaveJournalHeader) + basePath.size(), std::ios::beg);
+
+	unsigned char* const data = texData.getTextureData();
+	std::vector<unsigned char> payload;
+	std::vector<unsigned char> pixels;
+	int appliedTileCount = 0;
+	while (true)
+	{
+		AutosaveTileRecord record;
+		file.read(reinterpret_cast<char*>(&record), sizeof(AutosaveTileRecord));
+		if (!file || record.magic != TILE_RECORD_MAGIC)
+			break;
+		const uint32_t tileStartX = record.tileX * TILE_SIZE;
+		const uint32_t tileStartY = record.tileY * TILE_SIZE;
+		if (record.width > TILE_SIZE || record.height > TILE_SIZE || tileStartX + record.width > static_cast<uint32_t>(resolution.x) ||
+			tileStartY + record.height > static_cast<uint32_t>(resolution.y) || record.storedSize > TILE_SIZE * TILE_SIZE * 8)
+			break;
+		payload.resize(record.storedSize);
+		file.read(reinterpret_cast<char*>(payload.data()), record.storedSize);
+		//A record cut short by a crash or one that does not match its checksum ends the replay
+		if (!file || computeRecordChecksum(record, payload.data()) != record.checksum)
+			break;
+		const size_t rowSize = static_cast<size_t>(record.width) * componentCount;
+		pixels.resize(rowSize * record.height);
+		if (!NoraFileHandler::decompressData(payload.data(), payload.size(), pixels.data(), pixels.size()))
+			break;
+		for (uint32_t row = 0; row < record.height; row++)
+		{
+			const size_t destinationOffset = (static_cast<size_t>(tileStartY + row) * resolution.x + tileStartX) * componentCount;
+			std::memcpy(data + destinationOffset, &pixels[row * rowSize], rowSize);
+		}
+		appliedTileCount++;
+	}
+	return appliedTileCount;
+}
+
+uint32_t AutosaveJournal::computeHeaderChecksum(AutosaveJournalHeader header, const std::string& basePath)
+{
+	header.checksum = 0;
+	const uint32_t crc = HashUtility::crc32(&header, sizeof(AutosaveJournalHeader));
+	return HashUtility::crc32(basePath.data(), basePath.size(), crc);
+}
+
+uint32_t AutosaveJournal::computeRecordChecksum(AutosaveTileRecord record, const unsigned char* payload)
+{
+	record.checksum = 0;
+	const uint32_t crc = HashUtility::crc32(&record, sizeof(AutosaveTileRecord));
+	return HashUtility::crc32(payload, record.storedSize, crc);
+}
+
+AutosaveJournal::~AutosaveJournal()
+{
+	shutDown(false);
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include "TextureData.h"
+/*
+Autosave journal : .norajournal
+Edits to the heightmap since the last save are recorded as tiles and appended to the journal by a background thread,
+so an autosave never rewrites the whole project. On start up the journal is replayed over the file it was based on.
+[JOURNAL HEADER] (AutosaveJournalHeader) followed by the base file path
+[TILE RECORD] (AutosaveTileRecord) followed by the zlib compressed tile pixels, repeated
+Every record carries a CRC-32, replay stops at the first record that is incomplete or does not match
+*/
+
+struct AutosaveJournalHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t componentCount;
+	uint32_t tileSize;
+	uint32_t basePathLength;
+	uint32_t checksum;
+};
+
+struct AutosaveTileRecord
+{
+	uint32_t magic;
+	uint32_t sequence;
+	uint32_t tileX;
+	uint32_t tileY;
+	uint32_t width;
+	uint32_t height;
+	uint32_t storedSize;
+	uint32_t checksum;
+};
+
+class AutosaveJournal
+{
+public:
+	static const int TILE_SIZE = 128;
+private:
+	enum class JobType { RESET, APPEND_TILES, DISCARD };
+	struct Tile
+	{
+		uint32_t tileX;
+		uint32_t tileY;
+		uint32_t width;
+		uint32_t height;
+		std::vector<unsigned char> pixels;
+	};
+	struct Job
+	{
+		JobType type;
+		AutosaveJournalHeader header;
+		std::string basePath;
+		std::vector<Tile> tiles;
+	};
+
+	//Main thread state
+	std::string journalPath;
+	int width = 0;
+	int height = 0;
+	int componentCount = 0;
+	int tileCountX = 0;
+	int tileCountY = 0;
+	std::vector<unsigned char> dirtyTiles;
+	bool hasDirtyTiles = false;
+	double lastCaptureTime = 0.0;
+
+	//Shared with the writer thread
+	std::thread writerThread;
+	std::mutex jobMutex;
+	std::condition_variable jobCondition;
+	std::deque<Job> pendingJobs;
+	bool isStopping = false;
+
+	//Writer thread state
+	std::ofstream journalFile;
+	AutosaveJournalHeader currentHeader;
+	std::string currentBasePath;
+	std::unordered_map<uint32_t, std::vector<unsigned char>> latestRecords;
+	uint64_t journalSize = 0;
+	uint64_t liveRecordSize = 0;
+	uint32_t sequence = 0;
+public:
+	//Seconds between two captures of the dirty tiles
+	double captureInterval = 2.0;
+
+	AutosaveJournal();
+	AutosaveJournal(const AutosaveJournal&) = delete;
+	AutosaveJournal& operator=(const AutosaveJournal&) = delete;
+	//Start the writer thread, journalPath is where the journal is kept
+	void init(const std::string& journalPath);
+	//Start a fresh journal for a project based on basePath (.nora file or heightmap image), any previous journal is dropped
+	void reset(const std::string& basePath, const TextureData& texData);
+	//Record that pixels in [startX, endX) x [startY, endY) were changed
+	void markDirtyRegion(int startX, int endX, int startY, int endY);
+	void markAllDirty();
+	//Hand the dirty tiles to the writer thread once captureInterval has passed, called from the main loop
+	void update(double currentTime, const TextureData& texData);
+	//Capture the dirty tiles right away
+	void capture(const TextureData& texData);
+	//Stop the writer thread, the journal is deleted when discardJournal is true (clean exit)
+	void shutDown(bool discardJournal);
+
+	//Read the header of a journal left behind by a previous session, returns false if there is nothing to recover
+	static bool readJournalInfo(const std::string& journalPath, std::string& basePath, glm::ivec2& resolution, int& componentCount);
+	//Apply the journaled tiles over texData, returns the number of tiles applied
+	static int replay(const std::string& journalPath, TextureData& texData);
+	~AutosaveJournal();
+private:
+	void writerLoop();
+	void processJob(Job& job);
+	void openJournal(const AutosaveJournalHeader& header, const std::string& basePath);
+	void appendTile(const Tile& tile);
+	void compact();
+	static uint32_t computeHeaderChecksum(AutosaveJournalHeader header, const std::string& basePath);
+	static uint32_t computeRecordChecksum(AutosaveTileRecord record, const unsigned char* payload);
+};
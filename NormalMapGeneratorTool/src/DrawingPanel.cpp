@@ -1,5 +1,6 @@
 #include "DrawingPanel.h"
 #include <GL\glew.h>
+#include "GLutil.h"
 
 DrawingPanel::DrawingPanel()
 {
@@ -15,7 +16,7 @@ DrawingPanel::~DrawingPanel()
 	if (vboID != 0)
 		glDeleteBuffers(1, &vboID);
 	if (vaoID != 0)
-		glDeleteVertexArrays(1, &vaoID);
+		GL::deleteVertexArray(vaoID);
 }
 
 void DrawingPanel::init(float width, float height) noexcept
@@ -66,7 +67,7 @@ void DrawingPanel::init(float width, float height) noexcept
 	vertexData[22] = 1.0f;
 	vertexData[23] = 1.0f;
 
-	glBindVertexArray(vaoID);
+	GL::bindVertexArray(vaoID);
 	glBindBuffer(GL_ARRAY_BUFFER, vboID);
 
 	glEnableVertexAttribArray(0);
@@ -75,7 +76,7 @@ void DrawingPanel::init(float width, float height) noexcept
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	GL::bindVertexArray(0);
 }
 
 Transform * DrawingPanel::getTransform() noexcept
@@ -88,7 +89,7 @@ void DrawingPanel::setTextureID(unsigned int textureID, bool deleteAndReplace) n
 	if (deleteAndReplace)
 	{
 		if (this->textureID != textureID)
-			glDeleteTextures(1, &this->textureID);
+			GL::deleteTexture(this->textureID);
 	}
 	this->textureID = textureID;
 }
@@ -123,18 +124,10 @@ glm::vec4 DrawingPanel::getPanelWorldDimension()const noexcept
 
 void DrawingPanel::draw(int additionalTextureId)noexcept
 {
+	//Bindings are left in place, the state cache skips them when the next draw uses the same ones
 	if (additionalTextureId != -1)
-	{
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, additionalTextureId);
-	}
-	else
-		glBindTexture(GL_TEXTURE_2D, textureID);
-	glBindVertexArray(vaoID);
+		GL::bindTexture(TextureType::TEXTURE_2D, additionalTextureId, 1);
+	GL::bindTexture(TextureType::TEXTURE_2D, textureID, 0);
+	GL::bindVertexArray(vaoID);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
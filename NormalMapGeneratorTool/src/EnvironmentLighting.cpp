@@ -0,0 +1,173 @@
+#include "EnvironmentLighting.h"
+#include <GL\glew.h>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include "Stb\stb_image.h"
+#include "GLutil.h"
+#include "IblCache.h"
+
+EnvironmentLighting::EnvironmentLighting() : isStopping(false)
+{
+}
+
+void EnvironmentLighting::init(const std::vector<std::string>& facePaths, const std::function<void()>& onBakeFinished)
+{
+	if (workerThread.joinable() || facePaths.size() != 6)
+		return;
+	this->onBakeFinished = onBakeFinished;
+
+	const unsigned char placeholder[3] = { 0, 0, 0 };
+	glGenTextures(1, &prefilteredTextureId);
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, prefilteredTextureId);
+	for (unsigned int i = 0; i < 6; i++)
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, 0);
+
+	glGenTextures(1, &brdfLutTextureId);
+	GL::bindTexture(TextureType::TEXTURE_2D, brdfLutTextureId);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, 1, 1, 0, GL_RG, GL_UNSIGNED_BYTE, placeholder);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GL::bindTexture(TextureType::TEXTURE_2D, 0);
+
+	workerThread = std::thread(&EnvironmentLighting::bake, this, facePaths);
+}
+
+bool EnvironmentLighting::processUpload()
+{
+	IblData data;
+	{
+		std::lock_guard<std::mutex> lock(resultMutex);
+		if (!hasResult)
+			return false;
+		data = std::move(bakedData);
+		hasResult = false;
+	}
+
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, prefilteredTextureId);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (unsigned int mip = 0; mip < data.prefilteredMipCount; mip++)
+	{
+		const int size = static_cast<int>(data.prefilteredSize >> mip);
+		for (unsigned int face = 0; face < 6; face++)
+		{
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mip, GL_RGB16F, size, size, 0, GL_RGB, GL_HALF_FLOAT,
+				data.prefilteredTexels.data() + IblBaker::getPrefilteredOffset(mip, face));
+		}
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, data.prefilteredMipCount - 1);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, 0);
+
+	GL::bindTexture(TextureType::TEXTURE_2D, brdfLutTextureId);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, data.brdfLutSize, data.brdfLutSize, 0, GL_RG, GL_HALF_FLOAT, data.brdfLutTexels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GL::bindTexture(TextureType::TEXTURE_2D, 0);
+
+	std::copy(data.irradianceSH, data.irradianceSH + IblData::SH_COEFFICIENT_COUNT, irradianceSH);
+	prefilteredMaxLod = static_cast<float>(data.prefilteredMipCount - 1);
+	return true;
+}
+
+unsigned int EnvironmentLighting::getPrefilteredTexture() const noexcept
+{
+	return prefilteredTextureId;
+}
+
+unsigned int EnvironmentLighting::getBrdfLutTexture() const noexcept
+{
+	return brdfLutTextureId;
+}
+
+float EnvironmentLighting::getPrefilteredMaxLod() const noexcept
+{
+	return prefilteredMaxLod;
+}
+
+const glm::vec4* EnvironmentLighting::getIrradianceSH() const noexcept
+{
+	return irradianceSH;
+}
+
+void EnvironmentLighting::shutDown()
+{
+	isStopping = true;
+	if (workerThread.joinable())
+		workerThread.join();
+	if (prefilteredTextureId != 0)
+		GL::deleteTexture(prefilteredTextureId);
+	if (brdfLutTextureId != 0)
+		GL::deleteTexture(brdfLutTextureId);
+	prefilteredTextureId = 0;
+	brdfLutTextureId = 0;
+}
+
+EnvironmentLighting::~EnvironmentLighting()
+{
+	isStopping = true;
+	if (workerThread.joinable())
+		workerThread.join();
+}
+
+void EnvironmentLighting::bake(const std::vector<std::string>& facePaths)
+{
+	uint64_t sourceHash = 0;
+	const bool canCache = IblCache::hashSourceFaces(facePaths, sourceHash);
+	IblData data;
+	if (!canCache || !IblCache::read(sourceHash, data))
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+		//TextureManager changes the global flip flag on the main thread, so the worker sets its own to load the faces
+		//in the same row order AsyncTextureLoader uploads them in
+		stbi_set_flip_vertically_on_load_thread(1);
+		unsigned char* faces[6] = {};
+		int faceSize = 0;
+		bool isValid = true;
+		for (size_t i = 0; i < 6 && isValid && !isStopping; i++)
+		{
+			int width, height, componentCount;
+			faces[i] = stbi_load(facePaths[i].c_str(), &width, &height, &componentCount, 3);
+			if (faces[i] == nullptr)
+			{
+				std::cout << "\nCould not load environment face : " << facePaths[i];
+				isValid = false;
+			}
+			else if (width != height || (i > 0 && width != faceSize))
+			{
+				std::cout << "\nEnvironment faces have to be square and of one size : " << facePaths[i];
+				isValid = false;
+			}
+			faceSize = width;
+		}
+		isValid = isValid && !isStopping && IblBaker::bake(faces, faceSize, data);
+		for (unsigned char* face : faces)
+		{
+			if (face != nullptr)
+				stbi_image_free(face);
+		}
+		if (!isValid)
+			return;
+		const auto bakeTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+		std::cout << "\nBaked image based lighting in " << bakeTime.count() << " ms";
+		if (canCache)
+			IblCache::save(sourceHash, data);
+	}
+	{
+		std::lock_guard<std::mutex> lock(resultMutex);
+		bakedData = std::move(data);
+		hasResult = true;
+	}
+	if (onBakeFinished)
+		onBakeFinished();
+}
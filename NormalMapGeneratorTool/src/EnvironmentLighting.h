@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include "IblBaker.h"
+/*
+Image based lighting of the PBR preview, made from the faces of an environment cubemap
+A worker thread hashes the faces and reads the bake from IblCache, or bakes it with IblBaker and caches it when there
+is no entry yet. The textures are uploaded on the GL thread once the bake is ready and show black until then
+*/
+class EnvironmentLighting
+{
+private:
+	std::thread workerThread;
+	std::mutex resultMutex;
+	std::atomic<bool> isStopping;
+	bool hasResult = false;
+	IblData bakedData;
+	std::function<void()> onBakeFinished;
+	unsigned int prefilteredTextureId = 0;
+	unsigned int brdfLutTextureId = 0;
+	float prefilteredMaxLod = 0.0f;
+	glm::vec4 irradianceSH[IblData::SH_COEFFICIENT_COUNT] = {};
+public:
+	EnvironmentLighting();
+	EnvironmentLighting(const EnvironmentLighting&) = delete;
+	EnvironmentLighting& operator=(const EnvironmentLighting&) = delete;
+	//Create the placeholder textures and start baking the faces, given in +X, -X, +Y, -Y, +Z, -Z order
+	//onBakeFinished is called from the worker once the bake is ready to upload
+	void init(const std::vector<std::string>& facePaths, const std::function<void()>& onBakeFinished = nullptr);
+	//Upload the finished bake, returns true if the textures changed. Called from the GL thread
+	bool processUpload();
+	unsigned int getPrefilteredTexture()const noexcept;
+	unsigned int getBrdfLutTexture()const noexcept;
+	//Mip of the prefiltered cubemap that holds the roughest lobe
+	float getPrefilteredMaxLod()const noexcept;
+	const glm::vec4* getIrradianceSH()const noexcept;
+	void shutDown();
+	~EnvironmentLighting();
+private:
+	void bake(const std::vector<std::string>& facePaths);
+};
@@ -1,5 +1,8 @@
 #include "FileExplorer.h"
 #include "ImGui\imgui.h"
+#include "NoraFileHandler.h"
+#include "TextureLoader.h"
+#include "FrameScheduler.h"
 #include <vector>
 #include <filesystem>
 #include <iostream>
@@ -87,8 +90,10 @@ void FileOpenDialog::display()
 					paths.push_back(p.path().generic_string());
 			}
 		}
+		clearThumbnails();
 		isDirty = false;
 	}
+	thumbnailLoadsThisFrame = 0;
 	ImGui::OpenPopup("File Explorer");
 	ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoScrollbar;
 	ImGui::SetNextWindowSizeConstraints(ImVec2(540, 540), ImVec2(1920, 1080));
@@ -149,6 +154,24 @@ void FileOpenDialog::display()
 					float width = (ImGui::GetContentRegionAvailWidth() * 1.0f / columnCount) - 5;
 					if (i % columnCount != 0)
 						ImGui::SameLine();
+					const FileThumbnail* thumbnail = (fileFilter == FileType::NORA && getFileExtension(strPath) == ".nora") ? getThumbnail(strPath) : nullptr;
+					if (thumbnail != nullptr && thumbnail->normalTexId != 0)
+					{
+						//Texture rows run bottom to top so the previews are flipped
+						ImGui::Image((ImTextureID)thumbnail->normalTexId, ImVec2(30, 30), ImVec2(0, 1), ImVec2(1, 0));
+						if (ImGui::IsItemHovered())
+						{
+							ImGui::BeginTooltip();
+							ImGui::Image((ImTextureID)thumbnail->normalTexId, ImVec2(NoraFileHandler::THUMBNAIL_SIZE, NoraFileHandler::THUMBNAIL_SIZE), ImVec2(0, 1), ImVec2(1, 0));
+							ImGui::SameLine();
+							ImGui::Image((ImTextureID)thumbnail->heightTexId, ImVec2(NoraFileHandler::THUMBNAIL_SIZE, NoraFileHandler::THUMBNAIL_SIZE), ImVec2(0, 1), ImVec2(1, 0));
+							ImGui::EndTooltip();
+						}
+						ImGui::SameLine();
+						ImGui::Image((ImTextureID)thumbnail->heightTexId, ImVec2(30, 30), ImVec2(0, 1), ImVec2(1, 0));
+						ImGui::SameLine();
+						width -= 68;
+					}
 					if (ImGui::Button(strPath.c_str(), ImVec2(width, 30)))
 					{
 						//if (!pathTypeCheck(filterEnd, strPath))
@@ -217,6 +240,62 @@ void FileOpenDialog::displayDialog(FileType filter, std::function<void(std::stri
 	functionToCall = func;
 }
 
+const FileThumbnail* FileOpenDialog::getThumbnail(const std::string& filePath)
+{
+	const auto thumbnailIt = thumbnails.find(filePath);
+	if (thumbnailIt != thumbnails.end())
+		return &thumbnailIt->second;
+	//Spread the reads over a few frames so large directories do not stall the dialog
+	if (thumbnailLoadsThisFrame >= MAX_THUMBNAIL_LOADS_PER_FRAME)
+	{
+		FrameScheduler::invalidate(REDRAW_UI);
+		return nullptr;
+	}
+	thumbnailLoadsThisFrame++;
+
+	FileThumbnail& thumbnail = thumbnails[filePath];
+	NoraThumbnails noraThumbnails;
+	if (!NoraFileReader::readThumbnails(filePath, noraThumbnails))
+		return &thumbnail;
+	const size_t pixelCount = static_cast<size_t>(noraThumbnails.width) * noraThumbnails.height;
+	std::vector<unsigned char> normalPixels(pixelCount * 4);
+	std::vector<unsigned char> heightPixels(pixelCount * 4);
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		normalPixels[i * 4] = noraThumbnails.normalPixels[i * 3];
+		normalPixels[i * 4 + 1] = noraThumbnails.normalPixels[i * 3 + 1];
+		normalPixels[i * 4 + 2] = noraThumbnails.normalPixels[i * 3 + 2];
+		normalPixels[i * 4 + 3] = 255;
+		heightPixels[i * 4] = noraThumbnails.heightPixels[i];
+		heightPixels[i * 4 + 1] = noraThumbnails.heightPixels[i];
+		heightPixels[i * 4 + 2] = noraThumbnails.heightPixels[i];
+		heightPixels[i * 4 + 3] = 255;
+	}
+	TextureData texData;
+	texData.setTextureData(normalPixels.data(), noraThumbnails.width, noraThumbnails.height, 4);
+	thumbnail.normalTexId = TextureManager::createTextureFromData(texData);
+	texData.setTextureData(heightPixels.data(), noraThumbnails.width, noraThumbnails.height, 4);
+	thumbnail.heightTexId = TextureManager::createTextureFromData(texData);
+	return &thumbnail;
+}
+
+void FileOpenDialog::clearThumbnails()
+{
+	for (auto& thumbnailPair : thumbnails)
+	{
+		if (thumbnailPair.second.normalTexId != 0)
+			GL::deleteTexture(thumbnailPair.second.normalTexId);
+		if (thumbnailPair.second.heightTexId != 0)
+			GL::deleteTexture(thumbnailPair.second.heightTexId);
+	}
+	thumbnails.clear();
+}
+
+FileOpenDialog::~FileOpenDialog()
+{
+	clearThumbnails();
+}
+
 bool FileOpenDialog::pathTypeCheck(std::vector<std::string> endTypes, std::string& _path)
 {
 	for (unsigned int endTypeIndex = 0; endTypeIndex < endTypes.size(); endTypeIndex++)
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <unordered_map>
 enum class FileType
 {
 	IMAGE, TEXT, MODEL, NORA, NONE
@@ -17,9 +18,18 @@ public:
 	unsigned long getFileSize(const std::string path)const;
 };
 
+//Preview textures of a .nora file, both are 0 when the file has no previews
+struct FileThumbnail
+{
+	unsigned int normalTexId = 0;
+	unsigned int heightTexId = 0;
+};
+
 class FileOpenDialog : public FileExplorer
 {
 public:
+	//Number of .nora files whose previews are read in a single frame
+	static const int MAX_THUMBNAIL_LOADS_PER_FRAME = 4;
 	static FileOpenDialog* instance;
 	bool isDirty = true;
 	bool shouldDisplay = false;
@@ -29,12 +39,18 @@ public:
 	void display() override;
 	void displayDialog( FileType filter = FileType::NONE) noexcept;
 	void displayDialog( FileType filter, std::function<void(std::string)> func) noexcept;
+	~FileOpenDialog();
 private:
 	std::vector<std::string> paths;
 	std::vector<std::string> roots;
 	std::function<void(std::string)> functionToCall = nullptr;
 	FileType fileFilter = FileType::NONE;
+	std::unordered_map<std::string, FileThumbnail> thumbnails;
+	int thumbnailLoadsThisFrame = 0;
 	bool pathTypeCheck(std::vector<std::string> endTypes, std::string& _path);
+	//Get the previews of a .nora file, they are read from the file the first time they are asked for
+	const FileThumbnail* getThumbnail(const std::string& filePath);
+	void clearThumbnails();
 };
 
 class FileSaveDialog : public FileExplorer
@@ -1,6 +1,7 @@
 #include "FrameBufferSystem.h"
 #include <iostream>
 #include <GL\glew.h>
+#include "GLutil.h"
 unsigned int FrameBufferSystem::currentlyBoundFBO;
 FrameBufferSystem::FrameBufferSystem() {}
 
@@ -15,12 +16,12 @@ void FrameBufferSystem::init(int windowWidth, int windowHeight, int maxBufferWid
 	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
 	glGenTextures(1, &textureColorbuffer);
-	glBindTexture(GL_TEXTURE_2D, textureColorbuffer);
+	GL::bindTexture(TextureType::TEXTURE_2D, textureColorbuffer);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, windowWidth, windowHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glGenTextures(1, &textureDepthBuffer);
-	glBindTexture(GL_TEXTURE_2D, textureDepthBuffer);
+	GL::bindTexture(TextureType::TEXTURE_2D, textureDepthBuffer);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, maxBufferWidth, maxBufferHeight, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureColorbuffer, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, textureDepthBuffer, 0);
@@ -38,7 +39,7 @@ void FrameBufferSystem::bindFrameBuffer() const noexcept
 
 void FrameBufferSystem::bindColourTexture() noexcept
 {
-	glBindTexture(GL_TEXTURE_2D, textureColorbuffer);
+	GL::bindTexture(TextureType::TEXTURE_2D, textureColorbuffer);
 }
 
 unsigned int FrameBufferSystem::getColourTexture()const noexcept
@@ -46,9 +47,16 @@ unsigned int FrameBufferSystem::getColourTexture()const noexcept
 	return textureColorbuffer;
 }
 
+void FrameBufferSystem::generateColourMipmaps() noexcept
+{
+	GL::bindTexture(TextureType::TEXTURE_2D, textureColorbuffer);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glGenerateMipmap(GL_TEXTURE_2D);
+}
+
 void FrameBufferSystem::bindDepthTexture() noexcept
 {
-	glBindTexture(GL_TEXTURE_2D, textureDepthBuffer);
+	GL::bindTexture(TextureType::TEXTURE_2D, textureDepthBuffer);
 }
 
 unsigned int FrameBufferSystem::getDepthTexture()const noexcept
@@ -58,9 +66,9 @@ unsigned int FrameBufferSystem::getDepthTexture()const noexcept
 
 void FrameBufferSystem::updateTextureDimensions(int windowWidth, int windowHeight) noexcept
 {
-	glBindTexture(GL_TEXTURE_2D, textureColorbuffer);
+	GL::bindTexture(TextureType::TEXTURE_2D, textureColorbuffer);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, windowWidth, windowHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GL::bindTexture(TextureType::TEXTURE_2D, 0);
 }
 
 void FrameBufferSystem::updateTextureDimensions(const glm::ivec2 & windowRes) noexcept
@@ -102,6 +110,20 @@ void FrameBufferSystem::bindDefaultFrameBuffer()noexcept
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
+void FrameBufferSystem::destroy() noexcept
+{
+	if (textureColorbuffer != 0)
+		GL::deleteTexture(textureColorbuffer);
+	if (textureDepthBuffer != 0)
+		GL::deleteTexture(textureDepthBuffer);
+	if (framebuffer != 0)
+		glDeleteFramebuffers(1, &framebuffer);
+	if (currentlyBoundFBO == framebuffer)
+		currentlyBoundFBO = 0;
+	textureColorbuffer = 0;
+	textureDepthBuffer = 0;
+	framebuffer = 0;
+}
 FrameBufferSystem::~FrameBufferSystem()
 {
 }
@@ -19,6 +19,8 @@ public:
 	void bindColourTexture() noexcept;
 	//Get colour buffer texture
 	unsigned int getColourTexture()const noexcept;
+	//Rebuild the mipmaps of the colour buffer from its current content, the texture is sampled with trilinear filtering afterwards
+	void generateColourMipmaps() noexcept;
 	//Bind the depth buffer texture which is linked with the framebuffer
 	void bindDepthTexture() noexcept;
 	//Get depth buffer texture
@@ -36,6 +38,8 @@ public:
 		const glm::ivec2& destEndCoord)noexcept;
 	static void blit(const FrameBufferSystem& source, const FrameBufferSystem& destination, const glm::ivec2 screenRes)noexcept;
 	static void bindDefaultFrameBuffer() noexcept;
+	//Delete the frame buffer and its textures, copies are not tracked so only the owner may call this
+	void destroy() noexcept;
 	~FrameBufferSystem();
 };
 
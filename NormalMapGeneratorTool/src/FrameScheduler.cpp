@@ -0,0 +1,172 @@
+#include "FrameScheduler.h"
+
+unsigned int FrameScheduler::dirtyFlags = REDRAW_ALL;
+unsigned int FrameScheduler::frameFlags = REDRAW_NONE;
+int FrameScheduler::settleFramesLeft = INPUT_SETTLE_FRAME_COUNT;
+unsigned int FrameScheduler::settleFlags = REDRAW_ALL;
+std::atomic<bool> FrameScheduler::isWakeRequested(false);
+GLFWwindow* FrameScheduler::window = nullptr;
+GLFWcursorposfun FrameScheduler::previousCursorPosCallback = nullptr;
+GLFWmousebuttonfun FrameScheduler::previousMouseButtonCallback = nullptr;
+GLFWscrollfun FrameScheduler::previousScrollCallback = nullptr;
+GLFWkeyfun FrameScheduler::previousKeyCallback = nullptr;
+GLFWcharfun FrameScheduler::previousCharCallback = nullptr;
+GLFWwindowsizefun FrameScheduler::previousWindowSizeCallback = nullptr;
+GLFWwindowfocusfun FrameScheduler::previousWindowFocusCallback = nullptr;
+GLFWwindowiconifyfun FrameScheduler::previousWindowIconifyCallback = nullptr;
+GLFWwindowrefreshfun FrameScheduler::previousWindowRefreshCallback = nullptr;
+GLFWcursorenterfun FrameScheduler::previousCursorEnterCallback = nullptr;
+GLFWdropfun FrameScheduler::previousDropCallback = nullptr;
+
+void FrameScheduler::init(GLFWwindow* window)
+{
+	FrameScheduler::window = window;
+	//The previous callbacks (ImGui and the application) are chained so they still get every event
+	previousCursorPosCallback = glfwSetCursorPosCallback(window, cursorPosCallback);
+	previousMouseButtonCallback = glfwSetMouseButtonCallback(window, mouseButtonCallback);
+	previousScrollCallback = glfwSetScrollCallback(window, scrollCallback);
+	previousKeyCallback = glfwSetKeyCallback(window, keyCallback);
+	previousCharCallback = glfwSetCharCallback(window, charCallback);
+	previousWindowSizeCallback = glfwSetWindowSizeCallback(window, windowSizeCallback);
+	previousWindowFocusCallback = glfwSetWindowFocusCallback(window, windowFocusCallback);
+	previousWindowIconifyCallback = glfwSetWindowIconifyCallback(window, windowIconifyCallback);
+	previousWindowRefreshCallback = glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+	previousCursorEnterCallback = glfwSetCursorEnterCallback(window, cursorEnterCallback);
+	previousDropCallback = glfwSetDropCallback(window, dropCallback);
+	onInput(REDRAW_ALL);
+}
+
+void FrameScheduler::invalidate(unsigned int flags) noexcept
+{
+	dirtyFlags |= flags;
+}
+
+double FrameScheduler::waitForEvents(double timeoutSeconds)
+{
+	//A held mouse button keeps painting and orbiting without generating events
+	const bool isMouseButtonHeld = window != nullptr && (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS ||
+		glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS || glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS);
+	if (isMouseButtonHeld)
+		onInput(REDRAW_ALL);
+	if (isWakeRequested.exchange(false))
+		invalidate(REDRAW_ALL);
+	if (dirtyFlags != REDRAW_NONE || settleFramesLeft > 0)
+	{
+		glfwPollEvents();
+		return 0.0;
+	}
+	const double waitStartTime = glfwGetTime();
+	glfwWaitEventsTimeout(timeoutSeconds);
+	if (isWakeRequested.exchange(false))
+		invalidate(REDRAW_ALL);
+	return glfwGetTime() - waitStartTime;
+}
+
+bool FrameScheduler::beginFrame() noexcept
+{
+	frameFlags = dirtyFlags;
+	if (settleFramesLeft > 0)
+	{
+		frameFlags |= settleFlags;
+		if (--settleFramesLeft == 0)
+			settleFlags = REDRAW_NONE;
+	}
+	dirtyFlags = REDRAW_NONE;
+	return frameFlags != REDRAW_NONE;
+}
+
+bool FrameScheduler::needsRedraw(unsigned int flags) noexcept
+{
+	return (frameFlags & flags) != 0;
+}
+
+void FrameScheduler::wake() noexcept
+{
+	isWakeRequested = true;
+	glfwPostEmptyEvent();
+}
+
+void FrameScheduler::onInput(unsigned int flags) noexcept
+{
+	dirtyFlags |= flags;
+	settleFlags |= flags;
+	settleFramesLeft = INPUT_SETTLE_FRAME_COUNT;
+}
+
+void FrameScheduler::cursorPosCallback(GLFWwindow* window, double x, double y)
+{
+	//Hovering only changes ImGui state and the brush overlay, drags are covered by the held button check in waitForEvents
+	onInput(REDRAW_UI);
+	if (previousCursorPosCallback != nullptr)
+		previousCursorPosCallback(window, x, y);
+}
+
+void FrameScheduler::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+	onInput(REDRAW_ALL);
+	if (previousMouseButtonCallback != nullptr)
+		previousMouseButtonCallback(window, button, action, mods);
+}
+
+void FrameScheduler::scrollCallback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	onInput(REDRAW_ALL);
+	if (previousScrollCallback != nullptr)
+		previousScrollCallback(window, xOffset, yOffset);
+}
+
+void FrameScheduler::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	onInput(REDRAW_ALL);
+	if (previousKeyCallback != nullptr)
+		previousKeyCallback(window, key, scancode, action, mods);
+}
+
+void FrameScheduler::charCallback(GLFWwindow* window, unsigned int codepoint)
+{
+	onInput(REDRAW_ALL);
+	if (previousCharCallback != nullptr)
+		previousCharCallback(window, codepoint);
+}
+
+void FrameScheduler::windowSizeCallback(GLFWwindow* window, int width, int height)
+{
+	onInput(REDRAW_ALL);
+	if (previousWindowSizeCallback != nullptr)
+		previousWindowSizeCallback(window, width, height);
+}
+
+void FrameScheduler::windowFocusCallback(GLFWwindow* window, int isFocused)
+{
+	onInput(REDRAW_ALL);
+	if (previousWindowFocusCallback != nullptr)
+		previousWindowFocusCallback(window, isFocused);
+}
+
+void FrameScheduler::windowIconifyCallback(GLFWwindow* window, int isIconified)
+{
+	onInput(REDRAW_ALL);
+	if (previousWindowIconifyCallback != nullptr)
+		previousWindowIconifyCallback(window, isIconified);
+}
+
+void FrameScheduler::windowRefreshCallback(GLFWwindow* window)
+{
+	onInput(REDRAW_ALL);
+	if (previousWindowRefreshCallback != nullptr)
+		previousWindowRefreshCallback(window);
+}
+
+void FrameScheduler::cursorEnterCallback(GLFWwindow* window, int hasEntered)
+{
+	onInput(REDRAW_UI);
+	if (previousCursorEnterCallback != nullptr)
+		previousCursorEnterCallback(window, hasEntered);
+}
+
+void FrameScheduler::dropCallback(GLFWwindow* window, int count, const char** paths)
+{
+	onInput(REDRAW_ALL);
+	if (previousDropCallback != nullptr)
+		previousDropCallback(window, count, paths);
+}
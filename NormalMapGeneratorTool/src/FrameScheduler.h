@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <GLFW/glfw3.h>
+//Parts of a frame that can be redrawn on their own
+enum RedrawFlags : unsigned int
+{
+	REDRAW_NONE = 0,
+	REDRAW_NORMAL_MAP = 1, //Layer passes and the composited normal map
+	REDRAW_PREVIEW = 2, //3D preview frame buffer
+	REDRAW_UI = 4, //Default frame buffer, the panels, the brush overlay and ImGui
+	REDRAW_ALL = REDRAW_NORMAL_MAP | REDRAW_PREVIEW | REDRAW_UI
+};
+
+/*
+Renders frames on demand instead of every loop iteration
+Window input marks everything dirty and keeps frames coming for a few more iterations so ImGui can settle hover
+and animation state. Moving the cursor without a held button only marks the UI, content under it is redrawn by the
+handlers that change it. Other systems mark the parts they change, worker threads call wake() when they finish.
+While nothing is dirty the main loop sleeps in glfwWaitEventsTimeout
+*/
+class FrameScheduler
+{
+private:
+	//Frames rendered after the last input event
+	static const int INPUT_SETTLE_FRAME_COUNT = 3;
+	static unsigned int dirtyFlags;
+	static unsigned int frameFlags;
+	static int settleFramesLeft;
+	//Parts redrawn by the remaining settle frames
+	static unsigned int settleFlags;
+	static std::atomic<bool> isWakeRequested;
+	static GLFWwindow* window;
+	static GLFWcursorposfun previousCursorPosCallback;
+	static GLFWmousebuttonfun previousMouseButtonCallback;
+	static GLFWscrollfun previousScrollCallback;
+	static GLFWkeyfun previousKeyCallback;
+	static GLFWcharfun previousCharCallback;
+	static GLFWwindowsizefun previousWindowSizeCallback;
+	static GLFWwindowfocusfun previousWindowFocusCallback;
+	static GLFWwindowiconifyfun previousWindowIconifyCallback;
+	static GLFWwindowrefreshfun previousWindowRefreshCallback;
+	static GLFWcursorenterfun previousCursorEnterCallback;
+	static GLFWdropfun previousDropCallback;
+public:
+	FrameScheduler() = delete;
+	//Hook the window callbacks, has to be called after every other callback on the window is installed
+	static void init(GLFWwindow* window);
+	static void invalidate(unsigned int flags) noexcept;
+	//Wait for events while nothing is dirty, at most timeoutSeconds. Returns the seconds spent sleeping
+	static double waitForEvents(double timeoutSeconds);
+	//Take the dirty flags for the frame about to be drawn, returns false when there is nothing to draw
+	static bool beginFrame() noexcept;
+	//True if any of flags has to be drawn this frame
+	static bool needsRedraw(unsigned int flags) noexcept;
+	//Wake the main loop and redraw everything, safe to call from any thread
+	static void wake() noexcept;
+private:
+	static void onInput(unsigned int flags) noexcept;
+	static void cursorPosCallback(GLFWwindow* window, double x, double y);
+	static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+	static void scrollCallback(GLFWwindow* window, double xOffset, double yOffset);
+	static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	static void charCallback(GLFWwindow* window, unsigned int codepoint);
+	static void windowSizeCallback(GLFWwindow* window, int width, int height);
+	static void windowFocusCallback(GLFWwindow* window, int isFocused);
+	static void windowIconifyCallback(GLFWwindow* window, int isIconified);
+	static void windowRefreshCallback(GLFWwindow* window);
+	static void cursorEnterCallback(GLFWwindow* window, int hasEntered);
+	static void dropCallback(GLFWwindow* window, int count, const char** paths);
+};
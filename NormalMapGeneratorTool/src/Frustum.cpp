@@ -0,0 +1,37 @@
+#include "Frustum.h"
+#include <GLM\gtc\matrix_access.hpp>
+
+Frustum::Frustum() noexcept
+{
+	//Planes that accept everything
+	for (glm::vec4& plane : planes)
+		plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection) noexcept
+{
+	//Gribb and Hartmann : each clip space plane is the last row of the matrix plus or minus one of the others
+	const glm::vec4 rowX = glm::row(viewProjection, 0);
+	const glm::vec4 rowY = glm::row(viewProjection, 1);
+	const glm::vec4 rowZ = glm::row(viewProjection, 2);
+	const glm::vec4 rowW = glm::row(viewProjection, 3);
+	planes[0] = rowW + rowX;
+	planes[1] = rowW - rowX;
+	planes[2] = rowW + rowY;
+	planes[3] = rowW - rowY;
+	planes[4] = rowW + rowZ;
+	planes[5] = rowW - rowZ;
+}
+
+bool Frustum::isBoxVisible(const glm::vec3& boundsMin, const glm::vec3& boundsMax)const noexcept
+{
+	for (const glm::vec4& plane : planes)
+	{
+		//The corner furthest along the plane normal decides if the box is fully outside
+		const glm::vec3 farthestCorner(plane.x >= 0.0f ? boundsMax.x : boundsMin.x, plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+			plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+		if (glm::dot(glm::vec3(plane), farthestCorner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
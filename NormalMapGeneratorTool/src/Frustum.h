@@ -0,0 +1,13 @@
+#pragma once
+#include <GLM\glm.hpp>
+//View frustum planes taken from a view projection matrix, used to skip geometry that is off screen
+class Frustum
+{
+private:
+	//Left, right, bottom, top, near, far. xyz is the inward facing normal
+	glm::vec4 planes[6];
+public:
+	Frustum() noexcept;
+	explicit Frustum(const glm::mat4& viewProjection) noexcept;
+	bool isBoxVisible(const glm::vec3& boundsMin, const glm::vec3& boundsMax)const noexcept;
+};
@@ -89,9 +89,134 @@ enum BlendParam
 	ONE_MINUS_SRC1_ALPHA = GL_ONE_MINUS_SRC1_ALPHA
 };
 
+//GL calls made through the GL class during a frame, skipped calls were dropped because the state was already set
+struct GLStateCounters
+{
+	unsigned int issuedCalls = 0;
+	unsigned int skippedCalls = 0;
+};
+
+/*
+Thin wrapper over the GL state calls that remembers the state it last set and skips calls that would not change it
+Code that changes GL state without going through this class has to call invalidateStateCache afterwards
+*/
 class GL
 {
+private:
+	static const int CACHED_TEXTURE_UNIT_COUNT = 16;
+	static const int CAPABILITY_COUNT = 9;
+	static const int UNKNOWN = -1;
+	struct StateCache
+	{
+		int capabilities[CAPABILITY_COUNT];
+		int blendSource, blendDestination;
+		int depthTestMode;
+		int faceCullingMode;
+		int activeTextureIndex;
+		long long boundTextures2D[CACHED_TEXTURE_UNIT_COUNT];
+		long long boundCubeMaps[CACHED_TEXTURE_UNIT_COUNT];
+		long long vertexArray;
+		long long program;
+		glm::ivec4 viewport;
+		glm::vec3 clearColour;
+		bool isViewportKnown, isClearColourKnown;
+	};
+	static inline StateCache state = {};
+	static inline bool isStateInitialized = false;
+	static inline GLStateCounters frameCounters;
+	static inline GLStateCounters lastFrameCounters;
+
+	static inline StateCache& getState() noexcept
+	{
+		if (!isStateInitialized)
+			invalidateStateCache();
+		return state;
+	}
+
+	//Returns true when the cached value already matches, otherwise stores the new value
+	template<typename T>
+	static inline bool isCached(T& cachedValue, T value) noexcept
+	{
+		if (cachedValue == value)
+		{
+			frameCounters.skippedCalls++;
+			return true;
+		}
+		cachedValue = value;
+		frameCounters.issuedCalls++;
+		return false;
+	}
+
+	static inline int getCapabilityIndex(Capability capability) noexcept
+	{
+		switch (capability)
+		{
+		case Capability::ALPHA_TEST: return 0;
+		case Capability::AUTO_NORMAL: return 1;
+		case Capability::BLEND: return 2;
+		case Capability::LOGIC_OP: return 3;
+		case Capability::CULL_FACE: return 4;
+		case Capability::DEPTH_TEST: return 5;
+		case Capability::SCISSOR_TEST: return 6;
+		case Capability::STENCIL_TEST: return 7;
+		default: return 8;
+		}
+	}
+
+	static inline long long* getCachedTextureBinding(TextureType textureType, int textureIndex) noexcept
+	{
+		if (textureIndex < 0 || textureIndex >= CACHED_TEXTURE_UNIT_COUNT)
+			return nullptr;
+		if (textureType == TextureType::TEXTURE_2D)
+			return &getState().boundTextures2D[textureIndex];
+		if (textureType == TextureType::TEXTURE_CUBE_MAP)
+			return &getState().boundCubeMaps[textureIndex];
+		return nullptr;
+	}
+
+	//Deleting a bound object makes GL fall back to 0, the cache has to follow so a reused id is bound again
+	static inline void forgetTexture(unsigned int textureId) noexcept
+	{
+		StateCache& cache = getState();
+		for (int i = 0; i < CACHED_TEXTURE_UNIT_COUNT; i++)
+		{
+			if (cache.boundTextures2D[i] == textureId)
+				cache.boundTextures2D[i] = 0;
+			if (cache.boundCubeMaps[i] == textureId)
+				cache.boundCubeMaps[i] = 0;
+		}
+	}
 public:
+	//Forget every cached value, the next call for each state is issued to GL
+	static inline void invalidateStateCache() noexcept
+	{
+		for (int& capability : state.capabilities)
+			capability = UNKNOWN;
+		state.blendSource = state.blendDestination = UNKNOWN;
+		state.depthTestMode = UNKNOWN;
+		state.faceCullingMode = UNKNOWN;
+		state.activeTextureIndex = UNKNOWN;
+		for (int i = 0; i < CACHED_TEXTURE_UNIT_COUNT; i++)
+			state.boundTextures2D[i] = state.boundCubeMaps[i] = UNKNOWN;
+		state.vertexArray = UNKNOWN;
+		state.program = UNKNOWN;
+		state.isViewportKnown = false;
+		state.isClearColourKnown = false;
+		isStateInitialized = true;
+	}
+
+	//Keep the counters of the frame that just ended and start counting a new one
+	static inline void beginFrame() noexcept
+	{
+		lastFrameCounters = frameCounters;
+		frameCounters = GLStateCounters();
+	}
+
+	static inline const GLStateCounters& getLastFrameCounters() noexcept
+	{
+		return lastFrameCounters;
+	}
+
 	static inline void clear(FrameBufferAttachment frameBufferAttachement) noexcept
 	{
 		glClear(frameBufferAttachement);
@@ -99,32 +224,53 @@ public:
 
 	static inline void setClearColour(const glm::vec3& colour) noexcept
 	{
+		StateCache& cache = getState();
+		if (cache.isClearColourKnown && cache.clearColour == colour)
+		{
+			frameCounters.skippedCalls++;
+			return;
+		}
+		cache.clearColour = colour;
+		cache.isClearColourKnown = true;
+		frameCounters.issuedCalls++;
 		glClearColor(colour.r, colour.g, colour.b, 1.0);
 	}
 
 	static inline void setClearColour(float r, float g, float b) noexcept
 	{
-		glClearColor(r, g, b, 1.0);
+		setClearColour(glm::vec3(r, g, b));
 	}
 
 	static inline void setViewport(int x, int y, int width, int height) noexcept
 	{
+		StateCache& cache = getState();
+		const glm::ivec4 viewport(x, y, width, height);
+		if (cache.isViewportKnown && cache.viewport == viewport)
+		{
+			frameCounters.skippedCalls++;
+			return;
+		}
+		cache.viewport = viewport;
+		cache.isViewportKnown = true;
+		frameCounters.issuedCalls++;
 		glViewport(x, y, width, height);
 	}
 
 	static inline void setViewport(const glm::ivec2& position, const glm::ivec2& dimension) noexcept
 	{
-		glViewport(position.x, position.y, dimension.x, dimension.y);
+		setViewport(position.x, position.y, dimension.x, dimension.y);
 	}
 
 	static inline void enableCapability(Capability capability) noexcept
 	{
-		glEnable(capability);
+		if (!isCached(getState().capabilities[getCapabilityIndex(capability)], 1))
+			glEnable(capability);
 	}
 
 	static inline void disableCapability(Capability capability) noexcept
 	{
-		glDisable(capability);
+		if (!isCached(getState().capabilities[getCapabilityIndex(capability)], 0))
+			glDisable(capability);
 	}
 
 	static inline void enableFaceCulling() noexcept
@@ -139,47 +285,102 @@ public:
 
 	static inline void setFaceCullingMode(FaceCullingMode faceCullingMode) noexcept
 	{
-		glCullFace(faceCullingMode);
+		if (!isCached(getState().faceCullingMode, static_cast<int>(faceCullingMode)))
+			glCullFace(faceCullingMode);
 	}
 
 	static inline void enableBlending() noexcept
 	{
-		glEnable(GL_BLEND);
+		enableCapability(Capability::BLEND);
 	}
 
 	static inline void disableBlending() noexcept
 	{
-		glDisable(GL_BLEND);
+		disableCapability(Capability::BLEND);
 	}
 
 	static inline void setBlendingMethod(BlendParam srcParam, BlendParam destParam) noexcept
 	{
+		StateCache& cache = getState();
+		if (cache.blendSource == srcParam && cache.blendDestination == destParam)
+		{
+			frameCounters.skippedCalls++;
+			return;
+		}
+		cache.blendSource = srcParam;
+		cache.blendDestination = destParam;
+		frameCounters.issuedCalls++;
 		glBlendFunc(srcParam, destParam);
 	}
 
 	static inline void enableDepthTest() noexcept
 	{
-		glEnable(GL_DEPTH_TEST);
+		enableCapability(Capability::DEPTH_TEST);
 	}
 
 	static inline void disableDepthTest() noexcept
 	{
-		glDisable(GL_DEPTH_TEST);
+		disableCapability(Capability::DEPTH_TEST);
 	}
 
 	static inline void setDepthTestMode(DepthTestMode depthTestMode) noexcept
 	{
-		glDepthFunc(depthTestMode);
+		if (!isCached(getState().depthTestMode, static_cast<int>(depthTestMode)))
+			glDepthFunc(depthTestMode);
 	}
 
 	static inline void setActiveTextureIndex(unsigned char textureIndex)noexcept
 	{
-		glActiveTexture(GL_TEXTURE0 + textureIndex);
+		if (!isCached(getState().activeTextureIndex, static_cast<int>(textureIndex)))
+			glActiveTexture(GL_TEXTURE0 + textureIndex);
+	}
+
+	//Bind a texture to the active texture unit
+	static inline void bindTexture(TextureType textureType, unsigned int textureId) noexcept
+	{
+		long long* cachedTexture = getCachedTextureBinding(textureType, getState().activeTextureIndex);
+		if (cachedTexture == nullptr)
+		{
+			frameCounters.issuedCalls++;
+			glBindTexture(textureType, textureId);
+		}
+		else if (!isCached(*cachedTexture, static_cast<long long>(textureId)))
+			glBindTexture(textureType, textureId);
+	}
+
+	//Bind a texture to the given texture unit, the unit stays active afterwards
+	static inline void bindTexture(TextureType textureType, unsigned int textureId, unsigned char textureIndex) noexcept
+	{
+		setActiveTextureIndex(textureIndex);
+		bindTexture(textureType, textureId);
+	}
+
+	static inline void deleteTexture(unsigned int textureId) noexcept
+	{
+		if (textureId == 0)
+			return;
+		forgetTexture(textureId);
+		glDeleteTextures(1, &textureId);
 	}
 
 	static inline void bindVertexArray(unsigned int vaoId) noexcept
 	{
-		glBindVertexArray(vaoId);
+		if (!isCached(getState().vertexArray, static_cast<long long>(vaoId)))
+			glBindVertexArray(vaoId);
+	}
+
+	static inline void deleteVertexArray(unsigned int vaoId) noexcept
+	{
+		if (vaoId == 0)
+			return;
+		if (getState().vertexArray == vaoId)
+			state.vertexArray = 0;
+		glDeleteVertexArrays(1, &vaoId);
 	}
 
-};
\ No newline at end of file
+	static inline void useProgram(unsigned int programId) noexcept
+	{
+		if (!isCached(getState().program, static_cast<long long>(programId)))
+			glUseProgram(programId);
+	}
+};
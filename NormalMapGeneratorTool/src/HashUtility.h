@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+//Checksums and hashes used for validating data written to disk and for building cache keys
+class HashUtility
+{
+public:
+	HashUtility() = delete;
+	//CRC-32 (IEEE 802.3 polynomial), pass the previous result as crc to continue a running checksum
+	static uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) noexcept
+	{
+		static const uint32_t* const table = createCrcTable();
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+	//64 bit FNV-1a, pass the previous result as hash to continue a running hash
+	static uint64_t fnv1a64(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+	static uint64_t fnv1a64(const std::string& str, uint64_t hash = 14695981039346656037ULL) noexcept
+	{
+		return fnv1a64(str.data(), str.size(), hash);
+	}
+	//Hex string of a 64 bit hash, used for naming cache files
+	static std::string toHexString(uint64_t hash)
+	{
+		const char* digits = "0123456789abcdef";
+		std::string str(16, '0');
+		for (int i = 15; i >= 0; i--, hash >>= 4)
+			str[i] = digits[hash & 0xF];
+		return str;
+	}
+private:
+	static const uint32_t* createCrcTable() noexcept
+	{
+		static uint32_t table[256];
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+			table[i] = c;
+		}
+		return table;
+	}
+};
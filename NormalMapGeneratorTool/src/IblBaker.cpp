@@ -0,0 +1,396 @@
+#include "IblBaker.h"
+#include <cmath>
+#include <algorithm>
+#include <GLM\gtc\packing.hpp>
+#include "ParallelUtility.h"
+
+namespace
+{
+	const float PI = 3.14159265358979f;
+	//The irradiance is projected from the first source mip at most this large, it is smooth enough not to need more
+	const int SH_MAX_SOURCE_SIZE = 64;
+
+	//Linear RGB cubemap face images of one size
+	struct FloatCubemap
+	{
+		int size;
+		std::vector<glm::vec3> texels;
+
+		const glm::vec3& at(int face, int x, int y) const noexcept
+		{
+			return texels[(static_cast<size_t>(face) * size + y) * size + x];
+		}
+	};
+
+	struct PrefilterSample
+	{
+		glm::vec3 direction;
+		float weight;
+		float lod;
+	};
+
+	struct PrefilterRow
+	{
+		unsigned int mip;
+		unsigned int face;
+		unsigned int row;
+	};
+
+	//Direction through the point (s, t) of face, following the face orientation table of the GL specification
+	glm::vec3 faceToDirection(int face, float s, float t) noexcept
+	{
+		const float u = 2.0f * s - 1.0f;
+		const float v = 2.0f * t - 1.0f;
+		glm::vec3 direction;
+		switch (face)
+		{
+		case 0: direction = glm::vec3(1.0f, -v, -u); break;
+		case 1: direction = glm::vec3(-1.0f, -v, u); break;
+		case 2: direction = glm::vec3(u, 1.0f, v); break;
+		case 3: direction = glm::vec3(u, -1.0f, -v); break;
+		case 4: direction = glm::vec3(u, -v, 1.0f); break;
+		default: direction = glm::vec3(-u, -v, -1.0f); break;
+		}
+		return glm::normalize(direction);
+	}
+
+	void directionToFace(const glm::vec3& direction, int& face, float& s, float& t) noexcept
+	{
+		const glm::vec3 absolute = glm::abs(direction);
+		float majorAxis, sc, tc;
+		if (absolute.x >= absolute.y && absolute.x >= absolute.z)
+		{
+			face = (direction.x > 0.0f) ? 0 : 1;
+			majorAxis = absolute.x;
+			sc = (direction.x > 0.0f) ? -direction.z : direction.z;
+			tc = -direction.y;
+		}
+		else if (absolute.y >= absolute.z)
+		{
+			face = (direction.y > 0.0f) ? 2 : 3;
+			majorAxis = absolute.y;
+			sc = direction.x;
+			tc = (direction.y > 0.0f) ? direction.z : -direction.z;
+		}
+		else
+		{
+			face = (direction.z > 0.0f) ? 4 : 5;
+			majorAxis = absolute.z;
+			sc = (direction.z > 0.0f) ? direction.x : -direction.x;
+			tc = -direction.y;
+		}
+		s = 0.5f * (sc / majorAxis + 1.0f);
+		t = 0.5f * (tc / majorAxis + 1.0f);
+	}
+
+	//Bilinear lookup clamped to the edges of the face
+	glm::vec3 sampleFace(const FloatCubemap& cubemap, int face, float s, float t) noexcept
+	{
+		const float x = s * cubemap.size - 0.5f;
+		const float y = t * cubemap.size - 0.5f;
+		const float floorX = std::floor(x);
+		const float floorY = std::floor(y);
+		const float fractionX = x - floorX;
+		const float fractionY = y - floorY;
+		const int maxIndex = cubemap.size - 1;
+		const int x0 = std::clamp(static_cast<int>(floorX), 0, maxIndex);
+		const int y0 = std::clamp(static_cast<int>(floorY), 0, maxIndex);
+		const int x1 = std::min(static_cast<int>(floorX) + 1, maxIndex);
+		const int y1 = std::min(static_cast<int>(floorY) + 1, maxIndex);
+		const glm::vec3 top = glm::mix(cubemap.at(face, x0, y0), cubemap.at(face, x1, y0), fractionX);
+		const glm::vec3 bottom = glm::mix(cubemap.at(face, x0, y1), cubemap.at(face, x1, y1), fractionX);
+		return glm::mix(top, bottom, fractionY);
+	}
+
+	//Trilinear lookup in the source mip chain
+	glm::vec3 sampleChain(const std::vector<FloatCubemap>& chain, const glm::vec3& direction, float lod) noexcept
+	{
+		int face;
+		float s, t;
+		directionToFace(direction, face, s, t);
+		lod = std::clamp(lod, 0.0f, static_cast<float>(chain.size() - 1));
+		const size_t level = static_cast<size_t>(lod);
+		const float fraction = lod - static_cast<float>(level);
+		const glm::vec3 colour = sampleFace(chain[level], face, s, t);
+		if (fraction <= 0.0f || level + 1 >= chain.size())
+			return colour;
+		return glm::mix(colour, sampleFace(chain[level + 1], face, s, t), fraction);
+	}
+
+	std::vector<FloatCubemap> buildSourceChain(const unsigned char* const faces[6], int faceSize)
+	{
+		float srgbToLinear[256];
+		for (int i = 0; i < 256; i++)
+		{
+			const float value = i / 255.0f;
+			srgbToLinear[i] = (value <= 0.04045f) ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+		std::vector<FloatCubemap> chain(1);
+		chain[0].size = faceSize;
+		chain[0].texels.resize(static_cast<size_t>(faceSize) * faceSize * 6);
+		const size_t faceTexelCount = static_cast<size_t>(faceSize) * faceSize;
+		for (int face = 0; face < 6; face++)
+		{
+			for (size_t i = 0; i < faceTexelCount; i++)
+			{
+				const unsigned char* const rgb = faces[face] + i * 3;
+				chain[0].texels[face * faceTexelCount + i] = glm::vec3(srgbToLinear[rgb[0]], srgbToLinear[rgb[1]], srgbToLinear[rgb[2]]);
+			}
+		}
+		while (chain.back().size > 1)
+		{
+			const FloatCubemap& previous = chain.back();
+			FloatCubemap next;
+			next.size = previous.size / 2;
+			next.texels.resize(static_cast<size_t>(next.size) * next.size * 6);
+			const int maxIndex = previous.size - 1;
+			for (int face = 0; face < 6; face++)
+			{
+				for (int y = 0; y < next.size; y++)
+				{
+					const int y0 = y * 2;
+					const int y1 = std::min(y0 + 1, maxIndex);
+					for (int x = 0; x < next.size; x++)
+					{
+						const int x0 = x * 2;
+						const int x1 = std::min(x0 + 1, maxIndex);
+						next.texels[(static_cast<size_t>(face) * next.size + y) * next.size + x] = 0.25f * (previous.at(face, x0, y0) + previous.at(face, x1, y0) +
+							previous.at(face, x0, y1) + previous.at(face, x1, y1));
+					}
+				}
+			}
+			chain.push_back(std::move(next));
+		}
+		return chain;
+	}
+
+	glm::vec2 hammersley(unsigned int index, unsigned int count) noexcept
+	{
+		unsigned int bits = index;
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+		return glm::vec2(static_cast<float>(index) / count, bits * 2.3283064365386963e-10f);
+	}
+
+	//Half vector around +Z distributed by the GGX normal distribution of alpha
+	glm::vec3 importanceSampleGGX(const glm::vec2& xi, float alpha) noexcept
+	{
+		const float phi = 2.0f * PI * xi.x;
+		const float cosTheta = std::sqrt((1.0f - xi.y) / (1.0f + (alpha * alpha - 1.0f) * xi.y));
+		const float sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+		return glm::vec3(std::cos(phi) * sinTheta, std::sin(phi) * sinTheta, cosTheta);
+	}
+
+	float distributionGGX(float NdotH, float alpha) noexcept
+	{
+		const float alphaSquared = alpha * alpha;
+		const float denominator = NdotH * NdotH * (alphaSquared - 1.0f) + 1.0f;
+		return alphaSquared / (PI * denominator * denominator);
+	}
+
+	//Light directions around +Z for a view along the normal, with the source mip each should read so that the samples
+	//together cover the lobe instead of aliasing (GPU Gems 3, chapter 20)
+	std::vector<PrefilterSample> createPrefilterSamples(float roughness, int sourceSize)
+	{
+		const float alpha = roughness * roughness;
+		const float texelSolidAngle = 4.0f * PI / (6.0f * sourceSize * sourceSize);
+		std::vector<PrefilterSample> samples;
+		samples.reserve(IblBaker::PREFILTERED_SAMPLE_COUNT);
+		for (unsigned int i = 0; i < IblBaker::PREFILTERED_SAMPLE_COUNT; i++)
+		{
+			const glm::vec3 halfVector = importanceSampleGGX(hammersley(i, IblBaker::PREFILTERED_SAMPLE_COUNT), alpha);
+			const glm::vec3 direction = 2.0f * halfVector.z * halfVector - glm::vec3(0.0f, 0.0f, 1.0f);
+			if (direction.z <= 0.0f)
+				continue;
+			const float pdf = distributionGGX(halfVector.z, alpha) * 0.25f;
+			const float sampleSolidAngle = 1.0f / (IblBaker::PREFILTERED_SAMPLE_COUNT * pdf + 0.0001f);
+			const float lod = std::max(0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f, 0.0f);
+			samples.push_back({ direction, direction.z, lod });
+		}
+		return samples;
+	}
+
+	void writeHalfRGB(uint16_t* destination, const glm::vec3& colour) noexcept
+	{
+		destination[0] = glm::packHalf1x16(colour.r);
+		destination[1] = glm::packHalf1x16(colour.g);
+		destination[2] = glm::packHalf1x16(colour.b);
+	}
+
+	void prefilterRow(const std::vector<FloatCubemap>& chain, const std::vector<PrefilterSample>& samples, const PrefilterRow& row, uint16_t* texels) noexcept
+	{
+		const int size = static_cast<int>(IblBaker::PREFILTERED_SIZE >> row.mip);
+		uint16_t* destination = texels + IblBaker::getPrefilteredOffset(row.mip, row.face) + static_cast<size_t>(row.row) * size * 3;
+		const float t = (row.row + 0.5f) / size;
+		//The sharpest mip is a mirror, it only needs the source filtered down to its resolution
+		const float mirrorLod = std::max(std::log2(static_cast<float>(chain[0].size) / size), 0.0f);
+		for (int x = 0; x < size; x++, destination += 3)
+		{
+			const glm::vec3 normal = faceToDirection(row.face, (x + 0.5f) / size, t);
+			if (row.mip == 0)
+			{
+				writeHalfRGB(destination, sampleChain(chain, normal, mirrorLod));
+				continue;
+			}
+			const glm::vec3 up = (std::abs(normal.z) < 0.999f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+			const glm::vec3 tangent = glm::normalize(glm::cross(up, normal));
+			const glm::vec3 bitangent = glm::cross(normal, tangent);
+			glm::vec3 colour(0.0f);
+			float totalWeight = 0.0f;
+			for (const PrefilterSample& sample : samples)
+			{
+				const glm::vec3 direction = tangent * sample.direction.x + bitangent * sample.direction.y + normal * sample.direction.z;
+				colour += sampleChain(chain, direction, sample.lod) * sample.weight;
+				totalWeight += sample.weight;
+			}
+			writeHalfRGB(destination, (totalWeight > 0.0f) ? colour / totalWeight : colour);
+		}
+	}
+
+	void projectIrradianceSH(const std::vector<FloatCubemap>& chain, glm::vec4 coefficients[IblData::SH_COEFFICIENT_COUNT])
+	{
+		size_t level = 0;
+		while (chain[level].size > SH_MAX_SOURCE_SIZE && level + 1 < chain.size())
+			level++;
+		const FloatCubemap& source = chain[level];
+		glm::vec3 faceSums[6][IblData::SH_COEFFICIENT_COUNT] = {};
+		ParallelUtility::parallelFor(6, [&](size_t face)
+		{
+			glm::vec3* const sums = faceSums[face];
+			for (int y = 0; y < source.size; y++)
+			{
+				const float t = (y + 0.5f) / source.size;
+				const float v = 2.0f * t - 1.0f;
+				for (int x = 0; x < source.size; x++)
+				{
+					const float s = (x + 0.5f) / source.size;
+					const float u = 2.0f * s - 1.0f;
+					const float distanceSquared = 1.0f + u * u + v * v;
+					const float solidAngle = 4.0f / (source.size * source.size * distanceSquared * std::sqrt(distanceSquared));
+					const glm::vec3 radiance = source.at(static_cast<int>(face), x, y) * solidAngle;
+					const glm::vec3 n = faceToDirection(static_cast<int>(face), s, t);
+					sums[0] += radiance;
+					sums[1] += radiance * n.y;
+					sums[2] += radiance * n.z;
+					sums[3] += radiance * n.x;
+					sums[4] += radiance * (n.x * n.y);
+					sums[5] += radiance * (n.y * n.z);
+					sums[6] += radiance * (3.0f * n.z * n.z - 1.0f);
+					sums[7] += radiance * (n.x * n.z);
+					sums[8] += radiance * (n.x * n.x - n.y * n.y);
+				}
+			}
+		});
+		//Squared basis constants times the clamped cosine convolution of each band divided by PI (Ramamoorthi and Hanrahan)
+		const float scales[IblData::SH_COEFFICIENT_COUNT] = {
+			0.282095f * 0.282095f,
+			0.488603f * 0.488603f * 2.0f / 3.0f, 0.488603f * 0.488603f * 2.0f / 3.0f, 0.488603f * 0.488603f * 2.0f / 3.0f,
+			1.092548f * 1.092548f * 0.25f, 1.092548f * 1.092548f * 0.25f, 0.315392f * 0.315392f * 0.25f,
+			1.092548f * 1.092548f * 0.25f, 0.546274f * 0.546274f * 0.25f
+		};
+		for (unsigned int k = 0; k < IblData::SH_COEFFICIENT_COUNT; k++)
+		{
+			glm::vec3 sum(0.0f);
+			for (int face = 0; face < 6; face++)
+				sum += faceSums[face][k];
+			coefficients[k] = glm::vec4(sum * scales[k], 0.0f);
+		}
+	}
+
+	//Scale and bias to F0 of the GGX specular integrated over the hemisphere under a white environment
+	void integrateBrdfRow(unsigned int row, uint16_t* texels) noexcept
+	{
+		const unsigned int size = IblBaker::BRDF_LUT_SIZE;
+		const float roughness = (row + 0.5f) / size;
+		const float alpha = roughness * roughness;
+		const float k = alpha * 0.5f;
+		uint16_t* destination = texels + static_cast<size_t>(row) * size * 2;
+		for (unsigned int column = 0; column < size; column++, destination += 2)
+		{
+			const float NdotV = (column + 0.5f) / size;
+			const glm::vec3 view(std::sqrt(1.0f - NdotV * NdotV), 0.0f, NdotV);
+			const float viewVisibility = NdotV / (NdotV * (1.0f - k) + k);
+			float scale = 0.0f;
+			float bias = 0.0f;
+			for (unsigned int i = 0; i < IblBaker::BRDF_LUT_SAMPLE_COUNT; i++)
+			{
+				const glm::vec3 halfVector = importanceSampleGGX(hammersley(i, IblBaker::BRDF_LUT_SAMPLE_COUNT), alpha);
+				const float VdotH = glm::dot(view, halfVector);
+				const float NdotL = 2.0f * VdotH * halfVector.z - NdotV;
+				if (NdotL <= 0.0f)
+					continue;
+				const float geometry = viewVisibility * NdotL / (NdotL * (1.0f - k) + k);
+				const float visibility = geometry * std::max(VdotH, 0.0f) / (halfVector.z * NdotV);
+				const float fresnel = std::pow(1.0f - std::max(VdotH, 0.0f), 5.0f);
+				scale += (1.0f - fresnel) * visibility;
+				bias += fresnel * visibility;
+			}
+			destination[0] = glm::packHalf1x16(scale / IblBaker::BRDF_LUT_SAMPLE_COUNT);
+			destination[1] = glm::packHalf1x16(bias / IblBaker::BRDF_LUT_SAMPLE_COUNT);
+		}
+	}
+}
+
+bool IblBaker::bake(const unsigned char* const faces[6], int faceSize, IblData& data)
+{
+	if (faceSize <= 0)
+		return false;
+	for (int face = 0; face < 6; face++)
+	{
+		if (faces[face] == nullptr)
+			return false;
+	}
+	const std::vector<FloatCubemap> chain = buildSourceChain(faces, faceSize);
+	projectIrradianceSH(chain, data.irradianceSH);
+
+	data.prefilteredSize = PREFILTERED_SIZE;
+	data.prefilteredMipCount = PREFILTERED_MIP_COUNT;
+	data.prefilteredTexels.assign(getPrefilteredTexelCount(), 0);
+	std::vector<std::vector<PrefilterSample>> mipSamples(PREFILTERED_MIP_COUNT);
+	std::vector<PrefilterRow> rows;
+	for (unsigned int mip = 0; mip < PREFILTERED_MIP_COUNT; mip++)
+	{
+		const float roughness = static_cast<float>(mip) / (PREFILTERED_MIP_COUNT - 1);
+		if (mip > 0)
+			mipSamples[mip] = createPrefilterSamples(roughness, faceSize);
+		for (unsigned int face = 0; face < 6; face++)
+		{
+			for (unsigned int row = 0; row < (PREFILTERED_SIZE >> mip); row++)
+				rows.push_back({ mip, face, row });
+		}
+	}
+	//The rough mips are small but sample much more per texel, so rows of every mip share one pass
+	ParallelUtility::parallelFor(rows.size(), [&](size_t index)
+	{
+		const PrefilterRow& row = rows[index];
+		prefilterRow(chain, mipSamples[row.mip], row, data.prefilteredTexels.data());
+	});
+
+	data.brdfLutSize = BRDF_LUT_SIZE;
+	data.brdfLutTexels.assign(static_cast<size_t>(BRDF_LUT_SIZE) * BRDF_LUT_SIZE * 2, 0);
+	ParallelUtility::parallelFor(BRDF_LUT_SIZE, [&](size_t row)
+	{
+		integrateBrdfRow(static_cast<unsigned int>(row), data.brdfLutTexels.data());
+	});
+	return true;
+}
+
+size_t IblBaker::getPrefilteredOffset(unsigned int mip, unsigned int face) noexcept
+{
+	size_t offset = 0;
+	for (unsigned int i = 0; i < mip; i++)
+	{
+		const size_t size = PREFILTERED_SIZE >> i;
+		offset += size * size * 6 * 3;
+	}
+	const size_t size = PREFILTERED_SIZE >> mip;
+	return offset + size * size * face * 3;
+}
+
+size_t IblBaker::getPrefilteredTexelCount() noexcept
+{
+	return getPrefilteredOffset(PREFILTERED_MIP_COUNT, 0);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM\glm.hpp>
+//Image based lighting baked from an environment cubemap for the PBR preview
+//Texels are linear half floats, faces follow GL's +X, -X, +Y, -Y, +Z, -Z order with rows in the order they are uploaded
+struct IblData
+{
+	static const unsigned int SH_COEFFICIENT_COUNT = 9;
+	//Diffuse irradiance as order 2 spherical harmonics with the basis constants and the cosine lobe folded in, so summing
+	//the coefficients times the plain basis polynomials of the normal gives irradiance / PI
+	glm::vec4 irradianceSH[SH_COEFFICIENT_COUNT];
+	unsigned int prefilteredSize = 0;
+	unsigned int prefilteredMipCount = 0;
+	//RGB texels of every mip from the sharpest down, each mip holds its 6 faces
+	std::vector<uint16_t> prefilteredTexels;
+	unsigned int brdfLutSize = 0;
+	//RG texels of the split sum scale and bias applied to F0, columns go along NdotV and rows along roughness
+	std::vector<uint16_t> brdfLutTexels;
+};
+
+/*
+CPU precomputation of the split sum image based lighting (Karis, Real Shading in Unreal Engine 4)
+The specular mips are the environment convolved with GGX lobes of increasing roughness using filtered importance sampling,
+each sample reading a box filtered mip of the source so few samples are needed without fireflies. Rows of every stage
+are spread over the worker threads
+*/
+class IblBaker
+{
+public:
+	static const unsigned int PREFILTERED_SIZE = 128;
+	//Roughness of a mip is mip / (PREFILTERED_MIP_COUNT - 1)
+	static const unsigned int PREFILTERED_MIP_COUNT = 5;
+	static const unsigned int PREFILTERED_SAMPLE_COUNT = 128;
+	static const unsigned int BRDF_LUT_SIZE = 128;
+	static const unsigned int BRDF_LUT_SAMPLE_COUNT = 512;
+	IblBaker() = delete;
+	//Bake the 6 square sRGB faces of faceSize, each tightly packed with 3 bytes per texel
+	static bool bake(const unsigned char* const faces[6], int faceSize, IblData& data);
+	//Index of the first texel of face in mip of the prefiltered texels
+	static size_t getPrefilteredOffset(unsigned int mip, unsigned int face) noexcept;
+	//Number of halves the prefiltered mip chain takes
+	static size_t getPrefilteredTexelCount() noexcept;
+};
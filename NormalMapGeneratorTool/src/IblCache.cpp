@@ -0,0 +1,115 @@
+#include "IblCache.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+#include "HashUtility.h"
+#include "MemoryMappedFile.h"
+
+std::string IblCache::cacheDirectory;
+
+static_assert(sizeof(IblCacheHeader) % sizeof(glm::vec4) == 0, "The irradiance following IblCacheHeader has to stay aligned");
+
+void IblCache::setCacheDirectory(const std::string& directory)
+{
+	cacheDirectory = directory;
+	if (!cacheDirectory.empty())
+	{
+		std::error_code errorCode;
+		std::filesystem::create_directories(cacheDirectory, errorCode);
+	}
+}
+
+bool IblCache::hashSourceFaces(const std::vector<std::string>& facePaths, uint64_t& sourceHash)
+{
+	sourceHash = HashUtility::fnv1a64(nullptr, 0);
+	for (const std::string& facePath : facePaths)
+	{
+		MemoryMappedFile faceFile;
+		if (!faceFile.open(facePath))
+			return false;
+		sourceHash = HashUtility::fnv1a64(faceFile.getData(), faceFile.getSize(), sourceHash);
+	}
+	return true;
+}
+
+bool IblCache::read(uint64_t sourceHash, IblData& data)
+{
+	if (cacheDirectory.empty())
+		return false;
+	const std::string cachePath = getCachePath(sourceHash);
+	MemoryMappedFile mappedFile;
+	if (!mappedFile.open(cachePath) || mappedFile.getSize() < sizeof(IblCacheHeader))
+		return false;
+
+	IblCacheHeader header;
+	std::memcpy(&header, mappedFile.getData(), sizeof(IblCacheHeader));
+	const size_t irradianceBytes = sizeof(data.irradianceSH);
+	const size_t prefilteredBytes = IblBaker::getPrefilteredTexelCount() * sizeof(uint16_t);
+	const size_t brdfLutBytes = static_cast<size_t>(IblBaker::BRDF_LUT_SIZE) * IblBaker::BRDF_LUT_SIZE * 2 * sizeof(uint16_t);
+	if (std::memcmp(header.magic, "NIBL", 4) != 0 || header.version != VERSION || header.sourceHash != sourceHash ||
+		header.prefilteredSize != IblBaker::PREFILTERED_SIZE || header.prefilteredMipCount != IblBaker::PREFILTERED_MIP_COUNT ||
+		header.brdfLutSize != IblBaker::BRDF_LUT_SIZE || mappedFile.getSize() != sizeof(IblCacheHeader) + irradianceBytes + prefilteredBytes + brdfLutBytes)
+		return false;
+	const unsigned char* const blobs = mappedFile.getData() + sizeof(IblCacheHeader);
+	if (HashUtility::crc32(blobs, irradianceBytes + prefilteredBytes + brdfLutBytes) != header.checksum)
+	{
+		std::cout << "\nImage based lighting cache entry is corrupted : " << cachePath;
+		return false;
+	}
+
+	std::memcpy(data.irradianceSH, blobs, irradianceBytes);
+	const uint16_t* const prefilteredTexels = reinterpret_cast<const uint16_t*>(blobs + irradianceBytes);
+	const uint16_t* const brdfLutTexels = reinterpret_cast<const uint16_t*>(blobs + irradianceBytes + prefilteredBytes);
+	data.prefilteredSize = header.prefilteredSize;
+	data.prefilteredMipCount = header.prefilteredMipCount;
+	data.prefilteredTexels.assign(prefilteredTexels, prefilteredTexels + prefilteredBytes / sizeof(uint16_t));
+	data.brdfLutSize = header.brdfLutSize;
+	data.brdfLutTexels.assign(brdfLutTexels, brdfLutTexels + brdfLutBytes / sizeof(uint16_t));
+	return true;
+}
+
+void IblCache::save(uint64_t sourceHash, const IblData& data)
+{
+	if (cacheDirectory.empty() || data.prefilteredTexels.empty() || data.brdfLutTexels.empty())
+		return;
+	const size_t irradianceBytes = sizeof(data.irradianceSH);
+	const size_t prefilteredBytes = data.prefilteredTexels.size() * sizeof(uint16_t);
+	const size_t brdfLutBytes = data.brdfLutTexels.size() * sizeof(uint16_t);
+	IblCacheHeader header;
+	std::memcpy(header.magic, "NIBL", 4);
+	header.version = VERSION;
+	header.sourceHash = sourceHash;
+	header.prefilteredSize = data.prefilteredSize;
+	header.prefilteredMipCount = data.prefilteredMipCount;
+	header.brdfLutSize = data.brdfLutSize;
+	header.checksum = HashUtility::crc32(data.irradianceSH, irradianceBytes);
+	header.checksum = HashUtility::crc32(data.prefilteredTexels.data(), prefilteredBytes, header.checksum);
+	header.checksum = HashUtility::crc32(data.brdfLutTexels.data(), brdfLutBytes, header.checksum);
+
+	const std::string cachePath = getCachePath(sourceHash);
+	const std::string tempPath = cachePath + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(IblCacheHeader));
+		file.write(reinterpret_cast<const char*>(data.irradianceSH), irradianceBytes);
+		file.write(reinterpret_cast<const char*>(data.prefilteredTexels.data()), prefilteredBytes);
+		file.write(reinterpret_cast<const char*>(data.brdfLutTexels.data()), brdfLutBytes);
+		if (!file)
+		{
+			std::cout << "\nCould not write image based lighting cache : " << cachePath;
+			return;
+		}
+	}
+	std::error_code errorCode;
+	std::filesystem::rename(tempPath, cachePath, errorCode);
+	if (errorCode)
+		std::filesystem::remove(tempPath, errorCode);
+}
+
+std::string IblCache::getCachePath(uint64_t sourceHash)
+{
+	return cacheDirectory + HashUtility::toHexString(sourceHash) + ".nibl";
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <vector>
+#include "IblBaker.h"
+/*
+Baked image based lighting is cached on disk so later launches skip IblBaker
+Cache file : .nibl
+[HEADER] (IblCacheHeader)
+[IRRADIANCE] (glm::vec4...) : IblData::SH_COEFFICIENT_COUNT
+[PREFILTERED] (uint16_t...) : every mip of the prefiltered cubemap, see IblBaker::getPrefilteredOffset
+[BRDF LUT] (uint16_t...) : brdfLutSize * brdfLutSize * 2
+The file name is a hash of the contents of the source faces, entries baked with other sizes are ignored
+*/
+struct IblCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t sourceHash;
+	uint32_t prefilteredSize;
+	uint32_t prefilteredMipCount;
+	uint32_t brdfLutSize;
+	uint32_t checksum;
+};
+
+class IblCache
+{
+public:
+	static const uint32_t VERSION = 1;
+	IblCache() = delete;
+	//Set where bakes are cached, caching is off while this is empty
+	static void setCacheDirectory(const std::string& directory);
+	//Hash the contents of the face files in order, returns false if one can not be read
+	static bool hashSourceFaces(const std::vector<std::string>& facePaths, uint64_t& sourceHash);
+	//Copy the bake stored for sourceHash into data, returns false if there is no valid entry
+	static bool read(uint64_t sourceHash, IblData& data);
+	static void save(uint64_t sourceHash, const IblData& data);
+private:
+	static std::string cacheDirectory;
+	static std::string getCachePath(uint64_t sourceHash);
+};
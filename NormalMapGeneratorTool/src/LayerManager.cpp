@@ -1,5 +1,6 @@
 #include <set>
 #include <iostream>
+#include <fstream>
 #include "GL\glew.h"
 #include "NoraFileHandler.h"
 #include "LayerManager.h"
@@ -18,25 +19,113 @@ void LayerManager::init(const glm::vec2 & windowRes, const glm::vec2& maxBufferR
 	this->maxBufferResolution = maxBufferResolution;
 }
 
-void LayerManager::initWithLayerInfoData(const std::vector<std::pair<LayerInfoData, unsigned char*>>& layerInfoData)
+void LayerManager::initWithNoraFile(const std::shared_ptr<NoraFileReader>& reader)
 {
-	unsigned int size = glm::max(layers.size(), layerInfoData.size());
-	for (unsigned int i = 1; i < size; i++)
+	const unsigned int numberOfLayers = glm::max(reader->getFileHeader().numberOfLayers, 1u);
+	while (layers.size() > numberOfLayers)
 	{
-		if (layers.size() < size)
-			addLayer(-1, LayerType::HEIGHT_MAP, "x0000<NULL>", "x0000<NULL>");
+		GL::deleteTexture(layers.back().inputTextureId);
+		delete[] layers.back().layerName;
+		layers.pop_back();
+	}
+	for (unsigned int i = 0; i < numberOfLayers; i++)
+	{
+		if (i >= layers.size())
+			addLayer(0, LayerType::HEIGHT_MAP);
+		const LayerInfoData& info = reader->getLayerInfo(i);
+		LayerInfo& layer = layers.at(i);
+		std::memcpy(&layer.layerName[0], info.layerName, 100);
+		layer.layerName[99] = '\0';
+		if (i == 0)
+			continue;
+		if (layer.inputTextureId != 0)
+			GL::deleteTexture(layer.inputTextureId);
+		layer.inputTextureId = 0;
+		layer.strength = info.layerStrength;
+		layer.layerType = info.layerType;
+		layer.normalBlendMethod = info.blendMode;
+		layer.imagePath = "";
+		layer.imageFileData.clear();
+		layer.noraLayerIndex = i;
+		layer.isResident = false;
+		layer.hasLoadFailed = false;
+	}
+	noraFileReader = reader;
+}
 
-		std::memcpy(&layers.at(i).layerName[0], layerInfoData[i].first.layerName, 100);
-		layers.at(i).strength = layerInfoData[i].first.layerStrength;
-		layers.at(i).layerType = layerInfoData[i].first.layerType;
-		layers.at(i).normalBlendMethod = layerInfoData[i].first.blendMode;
+bool LayerManager::loadPendingLayerData(bool isLayerOutputInUse)
+{
+	//Layer pixels are only needed when the layers are blended into the output
+	if (!isLayerOutputInUse)
+		return false;
+	for (unsigned int i = 1; i < layers.size(); i++)
+	{
+		LayerInfo& layer = layers.at(i);
+		if (layer.isResident || layer.hasLoadFailed || !layer.isActive)
+			continue;
+		NoraLayerPayload payload;
+		if (!getLayerImageData(i, payload))
+		{
+			std::cout << "\nCould not load data for layer " << layer.layerName;
+			layer.hasLoadFailed = true;
+			return false;
+		}
 		int x, y, n;
-
-		unsigned char* data = stbi_load_from_memory(layerInfoData.at(i).second, layerInfoData.at(i).first.dataSize, &x, &y, &n, 4);
+		//Layers are decoded on the main thread, whose flip flag TextureManager relies on, so it is put back afterwards
+		const int previousFlipFlag = stbi_get_flip_vertically_on_load();
+		stbi_set_flip_vertically_on_load(true);
+		unsigned char* data = stbi_load_from_memory(payload.data, static_cast<int>(payload.size), &x, &y, &n, 4);
+		stbi_set_flip_vertically_on_load(previousFlipFlag);
+		if (data == nullptr)
+		{
+			std::cout << "\nCould not decode data for layer " << layer.layerName;
+			layer.hasLoadFailed = true;
+			return false;
+		}
 		TextureData texData;
 		texData.setTextureDataNonAlloc(data, x, y, 4);
-		layers.at(i).inputTextureId = TextureManager::createTextureFromData(texData);
+		layer.inputTextureId = TextureManager::createTextureFromData(texData);
+		layer.isResident = true;
+		return true;
 	}
+	return false;
+}
+
+bool LayerManager::isLayerResident(int index) const
+{
+	return layers.at(index).isResident;
+}
+
+bool LayerManager::getLayerImageData(int index, NoraLayerPayload& payload) const
+{
+	const LayerInfo& layer = layers.at(index);
+	if (!layer.imageFileData.empty())
+	{
+		payload.storage.clear();
+		payload.data = layer.imageFileData.data();
+		payload.size = layer.imageFileData.size();
+		return true;
+	}
+	if (layer.noraLayerIndex >= 0 && noraFileReader != nullptr)
+		return noraFileReader->readLayerPayload(layer.noraLayerIndex, payload);
+	return false;
+}
+
+void LayerManager::detachFromNoraFile()
+{
+	if (noraFileReader == nullptr)
+		return;
+	for (unsigned int i = 1; i < layers.size(); i++)
+	{
+		LayerInfo& layer = layers.at(i);
+		if (layer.noraLayerIndex < 0)
+			continue;
+		NoraLayerPayload payload;
+		if (layer.imageFileData.empty() && noraFileReader->readLayerPayload(layer.noraLayerIndex, payload))
+			layer.imageFileData.assign(payload.data, payload.data + payload.size);
+		layer.noraLayerIndex = -1;
+	}
+	noraFileReader.reset();
 }
 
 void LayerManager::updateLayerTexture(int index, unsigned int textureId)
@@ -64,6 +153,17 @@ void LayerManager::addLayer(int texId, LayerType layerType, const std::string& l
 		layerInfo.layerName[layerName.size()] = '\0';
 	}
 	layerInfo.imagePath = imagePath;
+	//Keep the file contents so saving does not depend on the source image still being on disk
+	if (imagePath != "")
+	{
+		std::ifstream ifs(imagePath, std::ios::binary | std::ios::ate);
+		if (ifs)
+		{
+			layerInfo.imageFileData.resize(static_cast<size_t>(ifs.tellg()));
+			ifs.seekg(0, std::ios::beg);
+			ifs.read(reinterpret_cast<char*>(layerInfo.imageFileData.data()), layerInfo.imageFileData.size());
+		}
+	}
 	layerInfo.fbs.init(windowRes, maxBufferResolution);
 	layers.push_back(layerInfo);
 }
@@ -151,7 +251,7 @@ void LayerManager::draw()
 	std::set<unsigned int>::iterator it;
 	for (it = markedForDeletionLayerIndices.begin(); it != markedForDeletionLayerIndices.end(); it++)
 	{
-		glDeleteTextures(1, &layers.at(*it).inputTextureId);
+		GL::deleteTexture(layers.at(*it).inputTextureId);
 		delete[] layers.at(*it).layerName;
 		layers.erase(layers.begin() + *it);
 	}
@@ -1,12 +1,15 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
 #include <GLM\glm.hpp>
 #include "FrameBufferSystem.h"
 #include "TextureLoader.h"
 #include "ImGui\imgui.h"
 
 struct LayerInfoData;
+struct NoraLayerPayload;
+class NoraFileReader;
 enum class LayerType { HEIGHT_MAP = 0, NORMAL_MAP };
 enum class NormalBlendMethod { REORIENTED_NORMAL_BLENDING = 0, UNREAL_NORMAL_BLENDING, PARTIAL_DERIVATIVE_NORMAL_BLENDING };
 
@@ -23,6 +26,14 @@ struct LayerInfo
 	glm::vec2 resolution;
 	ImageFormat imageFormat = ImageFormat::UNCOMPRESSED_RAW;
 	std::string imagePath;
+	//Contents of the source image file once the layer no longer depends on the opened .nora file
+	std::vector<unsigned char> imageFileData;
+	//Index of the layer inside the opened .nora file, -1 if the layer did not come from one
+	int noraLayerIndex = -1;
+	//False until the pixels of a layer from a .nora file are decoded, they may be copied into imageFileData by then
+	bool isResident = true;
+	//Set when the pixels could not be read or decoded, the layer then stays out of the blend instead of being retried every frame
+	bool hasLoadFailed = false;
 };
 
 class LayerManager
@@ -31,12 +42,21 @@ private:
 	std::vector<LayerInfo> layers;
 	glm::vec2 windowRes;
 	glm::vec2 maxBufferResolution;
+	std::shared_ptr<NoraFileReader> noraFileReader;
 public:
 	LayerManager() {}
 	~LayerManager();
 	int getLayerCount()const;
 	void init(const glm::vec2 & windowRes, const glm::vec2& maxBufferResolution);
-	void initWithLayerInfoData(const std::vector<std::pair<LayerInfoData, unsigned char*>>& layerInfoData);
+	//Set up layers from an opened .nora file, pixel data is loaded later through loadPendingLayerData
+	void initWithNoraFile(const std::shared_ptr<NoraFileReader>& reader);
+	//Decode at most one visible layer from a .nora file that has no texture yet, returns true if one was loaded
+	bool loadPendingLayerData(bool isLayerOutputInUse);
+	bool isLayerResident(int index)const;
+	//Get the image file contents of a layer, used when saving
+	bool getLayerImageData(int index, NoraLayerPayload& payload)const;
+	//Copy layer data still referenced in the opened .nora file into memory and release the file
+	void detachFromNoraFile();
 	void updateLayerTexture(int index, unsigned int textureId);
 	void addLayer(int texId, LayerType layerType = LayerType::HEIGHT_MAP, const std::string& layerName = "", const std::string& imagePath = "");
 	void setLayerActiveState(int index, bool isActive);
@@ -3,6 +3,8 @@
 #include <vector>
 #include <chrono>
 #include <queue>
+#include <filesystem>
+#include <algorithm>
 #include <GL\glew.h>
 #include <GLFW/glfw3.h>
 #include <GLM\gtc\quaternion.hpp>
@@ -21,6 +23,8 @@
 #include "BrushData.h"
 #include "TextureLoader.h"
 #include "ShaderProgram.h"
+#include "ShaderVariantSet.h"
+#include "UniformBuffer.h"
 #include "Transform.h"
 #include "WindowSystem.h"
 #include "WindowTransformUtility.h"
@@ -34,10 +38,20 @@
 #include "PreferencesHandler.h"
 #include "LayerManager.h"
 #include "NoraFileHandler.h"
+#include "AutosaveJournal.h"
+#include "AsyncTextureLoader.h"
+#include "AsyncModelLoader.h"
+#include "ParallelUtility.h"
+#include "StartupProfiler.h"
+#include "FrameScheduler.h"
+#include "RenderGraph.h"
+#include "PreviewNormalCache.h"
+#include "PreviewResolution.h"
+#include "EnvironmentLighting.h"
+#include "IblCache.h"
 
 //TODO : * Done but not good enough *Implement mouse position record and draw to prevent cursor skipping ( probably need separate thread for drawing |completly async| )
 //Possible cause : Input take over by IMGUI
-//TODO : Add Uniform Buffers
 //TODO : Add shadows and an optional plane
 //TODO : Look into converting normal map to heightmap for editing purposes
 //TODO : Control directional light direction through 3D hemisphere sun object in preview screen
@@ -62,6 +76,9 @@ const std::string CUBEMAP_TEXTURES_PATH = "Resources\\Textures\\Cubemaps\\";
 const std::string BRUSH_TEXTURES_PATH = "Resources\\Brushes\\";
 const std::string UI_TEXTURES_PATH = "Resources\\Textures\\UI\\";
 const std::string SHADERS_PATH = "Resources\\Shaders\\";
+const std::string SHADER_CACHE_PATH = "Resources\\ShaderCache\\";
+const std::string MESH_CACHE_PATH = "Resources\\MeshCache\\";
+const std::string IBL_CACHE_PATH = "Resources\\IblCache\\";
 const std::string PRIMITIVE_MODELS_PATH = "Resources\\3D Models\\Primitives\\";
 const std::string COMPLEX_MODELS_PATH = "Resources\\3D Models\\Complex\\";
 const std::string CUBE_MODEL_PATH = PRIMITIVE_MODELS_PATH + "Cube.fbx";
@@ -70,8 +87,15 @@ const std::string SPHERE_MODEL_PATH = PRIMITIVE_MODELS_PATH + "Sphere.fbx";
 const std::string TORUS_MODEL_PATH = PRIMITIVE_MODELS_PATH + "Torus.fbx";
 const std::string PLANE_MODEL_PATH = PRIMITIVE_MODELS_PATH + "Plane.fbx";
 const std::string PREFERENCES_PATH = "Resources\\Preference\\preference.npref";
+const std::string AUTOSAVE_JOURNAL_PATH = "Resources\\Autosave\\recovery.norajournal";
+const std::string STARTUP_REPORT_PATH = "Resources\\Logs\\startup.csv";
 #pragma endregion
 
+//Milliseconds per frame spent uploading textures decoded by the async loader
+const double TEXTURE_UPLOAD_BUDGET_MS = 4.0;
+//Longest the main loop sleeps while nothing needs to be drawn, bounds how late timed work such as autosaving runs
+const double IDLE_WAIT_TIMEOUT_SECONDS = 0.5;
+
 #pragma region FUNCTION_DECLARATIONS
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) noexcept;
@@ -79,9 +103,16 @@ void SetPixelValues(TextureData& texData, int startX, int width, int startY, int
 void SetPixelValuesWithBrushTexture(TextureData& inputTexData, const TextureData& brushTexture, int startX, int endX, int startY, int endY, double xpos, double ypos);
 void SetBluredPixelValues(TextureData& inputTexData, int startX, int width, int startY, int height, double xpos, double ypos);
 void SaveNormalMapToFile(const std::string& locationStr, ImageFormat imageFormat);
+void SetPreviewTextureFromFile(TextureData& texData, const std::string& path);
+NoraThumbnails CreateProjectThumbnails();
+void LoadPreviewResources();
+void LoadPreviewModel(const std::string& path);
 void DisplayNoraFileSave();
 void DisplayNoraFileOpen();
 void DisplayHeightmapOpen();
+bool LoadNoraFile(const std::string& path);
+bool LoadHeightmap(const std::string& path);
+void RecoverAutosavedChanges();
 inline void HandleMiddleMouseButtonInput(int state, glm::vec2& prevMiddleMouseButtonCoord, double deltaTime, DrawingPanel& normalmapPanel);
 inline void HandleLeftMouseButtonInput_NormalMapInteraction(int state, DrawingPanel& normalmapPanel, bool isBlurOn);
 inline void DisplayWindowTopBar(unsigned int minimizeTexture, unsigned int restoreTexture, bool& isMaximized, unsigned int closeTexture);
@@ -94,6 +125,10 @@ inline void DisplayNormalSettingsUserInterface();
 inline void DisplayBrushSettingsUserInterface(bool& isBlurOn);
 inline void HandleKeyboardInput(double deltaTime, DrawingPanel& frameDrawingPanel, bool& isMaximized);
 void SetStatesForSavingNormalMap()noexcept;
+ShaderProgram& UseNormalPanelVariant(int useNormalInput, int mapDrawMode, int blendMethod);
+void UpdateNormalViewUniforms();
+glm::mat4 UpdatePreviewUniforms(const glm::vec3& cameraPosition);
+void DrawPreviewImage(const ImVec2& size, bool isMaximizedView);
 void SetupImGui();
 #pragma endregion
 
@@ -103,6 +138,15 @@ ImFont* menuBarLargerText = NULL;
 PreviewStateUtility previewStateUtility;
 NormalViewStateUtility normalViewStateUtility;
 
+ShaderVariantSet normalmapShaders;
+ShaderVariantSet modelViewShaders;
+UniformBuffer cameraUniformBuffer;
+UniformBuffer previewLightingUniformBuffer;
+UniformBuffer normalViewUniformBuffer;
+RenderGraph renderGraph;
+PreviewNormalCache previewNormalCache;
+PreviewResolution previewResolution;
+
 FrameBufferSystem fbs;
 FrameBufferSystem previewFbs;
 
@@ -114,6 +158,9 @@ TextureData roughnessTexDataForPreview;
 TextureData matcapTexDataForPreview;
 
 ModelObject* modelPreviewObj = nullptr;
+ModelObject* previewGrid = nullptr;
+EnvironmentLighting environmentLighting;
+bool arePreviewResourcesLoaded = false;
 LoadingOption currentLoadingOption = LoadingOption::NONE;
 FileOpenDialog* fileOpenDialog = nullptr;
 FileSaveDialog* fileSaveDialog = nullptr;
@@ -121,6 +168,11 @@ ThemeManager* themeManager;
 ModalWindow modalWindow;
 DrawingPanel normalmapPanel;
 UndoRedoSystem undoRedoSystem;
+AutosaveJournal autosaveJournal;
+AsyncTextureLoader asyncTextureLoader;
+AsyncModelLoader asyncModelLoader;
+//Model shown in the preview, reloaded when the tangent space is switched
+std::string previewModelPath = CUBE_MODEL_PATH;
 
 std::string heightImageLoadLocation = "";
 PreferenceInfo preferencesInfo;
@@ -139,7 +191,9 @@ bool isUsingLayerOutput = false;
 
 int main(void)
 {
+	StartupProfiler::init();
 #pragma region Window Initialization
+	StartupProfiler::beginPhase("Window and GL context");
 	windowSys.init("Nora Normal Map Editor " + VERSION_NAME, 1600, 800);
 	if (glewInit() != GLEW_OK)
 	{
@@ -151,7 +205,11 @@ int main(void)
 	GL::enableFaceCulling();
 	GL::setFaceCullingMode(FaceCullingMode::BACK_FACE_CULLING);
 
+	StartupProfiler::beginPhase("ImGui, dialogs, preferences and themes");
 	SetupImGui();
+	//Image decoding runs on these threads, the GL thread only uploads
+	asyncTextureLoader.init(std::min(4u, ParallelUtility::getWorkerCount()), FrameScheduler::wake);
+	asyncModelLoader.init(FrameScheduler::wake);
 	//Initalize the File Explorer singleton
 	FileOpenDialog::init();
 	fileOpenDialog = FileOpenDialog::instance;
@@ -170,11 +228,8 @@ int main(void)
 	windowSys.setScrollCallback(scroll_callback);
 #pragma endregion
 
-	modelPreviewObj = modelLoader.createModelFromFile(CUBE_MODEL_PATH); // Default loaded model in preview window
-	const ModelObject* const cubeForSkybox = modelLoader.createModelFromFile(CUBE_MODEL_PATH);
-	const ModelObject* const previewGrid = modelLoader.createModelFromFile(PLANE_MODEL_PATH);
-	const ModelObject* const previewPlane = modelLoader.createModelFromFile(PLANE_MODEL_PATH);
-
+	//Preview models, the cubemap and the matcap are loaded by LoadPreviewResources when the preview is first drawn
+	StartupProfiler::beginPhase("Panels and UI textures");
 	normalmapPanel.init(1.0f, 1.0f);
 	DrawingPanel frameDrawingPanel;
 	frameDrawingPanel.init(1.0f, 1.0f);
@@ -183,32 +238,24 @@ int main(void)
 	DrawingPanel brushPanel;
 	brushPanel.init(1.0f, 1.0f);
 
-	//Windowing related images
-	closeTextureId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "closeIcon.png");
-	restoreTextureId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "maxWinIcon.png");
-	minimizeTextureId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "toTrayIcon.png");
-	logoTextureId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "icon.png");
+	//Windowing related images, decoded in the background and transparent until they arrive
+	closeTextureId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "closeIcon.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
+	restoreTextureId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "maxWinIcon.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
+	minimizeTextureId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "toTrayIcon.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
+	logoTextureId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "icon.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
 
-	toggleFullscreenTexId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "toggleFullscreen.png");
-	clearViewTexId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "clearView.png");
-	resetViewTexId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "resetLocation.png");
-	maximizePreviewTexId = TextureManager::createTextureFromFile(UI_TEXTURES_PATH + "maximizePreview.png");
+	toggleFullscreenTexId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "toggleFullscreen.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
+	clearViewTexId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "clearView.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
+	resetViewTexId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "resetLocation.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
+	maximizePreviewTexId = asyncTextureLoader.loadTexture(UI_TEXTURES_PATH + "maximizePreview.png", false, TextureFilterType::LINEAR, ColourData(0, 0, 0, 0));
 	defaultWhiteTextureId = TextureManager::createTextureFromColour(ColourData(1, 1, 1, 1), TextureFilterType::NEAREST);
 
-	std::vector<std::string> cubeMapImagePaths;
-	cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_lf.tga");
-	cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_rt.tga");
-	cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_dn.tga");
-	cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_up.tga");
-	cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_ft.tga");
-	cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_bk.tga");
-
-	const unsigned int cubeMapTextureId = TextureManager::createCubemapFromFile(cubeMapImagePaths);
-	albedoTexDataForPreview.setTexId(TextureManager::createTextureFromFile(TEXTURES_PATH + "wall diffuse.png"));
-	roughnessTexDataForPreview.setTexId(TextureManager::createTextureFromFile(TEXTURES_PATH + "wall specular.png"));
+	albedoTexDataForPreview.setTexId(asyncTextureLoader.loadTexture(TEXTURES_PATH + "wall diffuse.png"));
+	roughnessTexDataForPreview.setTexId(asyncTextureLoader.loadTexture(TEXTURES_PATH + "wall specular.png"));
 	metalnessTexDataForPreview.setTexId(defaultWhiteTextureId);
-	matcapTexDataForPreview.setTexId(TextureManager::createTextureFromFile(MATCAP_TEXTURES_PATH + "chrome.png"));
 
+	//The heightmap is edited on the CPU and needed for the first frame, so it is still loaded right away
+	StartupProfiler::beginPhase("Default heightmap");
 	heightImageLoadLocation = TEXTURES_PATH + "wall height.png";
 	TextureManager::getTextureDataFromFile(heightImageLoadLocation, heightMapTexData);
 	heightMapTexData.setTexId(TextureManager::createTextureFromData(heightMapTexData));
@@ -219,16 +266,19 @@ int main(void)
 	camera.init(windowSys.getWindowRes().x, windowSys.getWindowRes().y);
 
 #pragma region SHADER PROGRAMS
-	ShaderProgram normalmapShader;
-	normalmapShader.compileShaders(SHADERS_PATH + "normalPanel.vs", SHADERS_PATH + "normalPanel.fs");
-	normalmapShader.linkShaders();
-
-	ShaderProgram modelViewShader;
-	modelViewShader.compileShaders(SHADERS_PATH + "modelView.vs", SHADERS_PATH + "modelView.fs");
-	modelViewShader.linkShaders();
+	StartupProfiler::beginPhase("Shader programs");
+	ShaderProgram::setCacheDirectory(SHADER_CACHE_PATH);
+	MeshCache::setCacheDirectory(MESH_CACHE_PATH);
+	IblCache::setCacheDirectory(IBL_CACHE_PATH);
+	normalmapShaders.init(SHADERS_PATH + "normalPanel.vs", SHADERS_PATH + "normalPanel.fs", { "USE_NORMAL_INPUT", "NORMAL_MAP_MODE", "METHOD_INDEX", "NORMAL_BLENDING_METHOD" });
+	modelViewShaders.init(SHADERS_PATH + "modelView.vs", SHADERS_PATH + "modelView.fs", { "NORMAL_MAP_MODE", "USE_MATCAP" });
+	for (const char* attributeName : VertexPacking::ATTRIBUTE_NAMES)
+		modelViewShaders.addAttribute(attributeName);
 
 	ShaderProgram modelAttribViewShader;
-	modelAttribViewShader.compileShaders(SHADERS_PATH + "modelAttribsDisplay.vs", SHADERS_PATH + "modelAttribsDisplay.fs", SHADERS_PATH + "modelAttribsDisplay.gs");
+	modelAttribViewShader.compileShaders(SHADERS_PATH + "modelAttribsDisplay.vs", SHADERS_PATH + "modelAttribsDisplay.fs");
+	modelAttribViewShader.addAttribute("aPos");
+	modelAttribViewShader.addAttribute("aOffset");
 	modelAttribViewShader.linkShaders();
 
 	ShaderProgram frameShader;
@@ -241,32 +291,27 @@ int main(void)
 
 	ShaderProgram gridLineShader;
 	gridLineShader.compileShaders(SHADERS_PATH + "gridLines.vs", SHADERS_PATH + "gridLines.fs");
+	for (const char* attributeName : VertexPacking::ATTRIBUTE_NAMES)
+		gridLineShader.addAttribute(attributeName);
 	gridLineShader.linkShaders();
+
+	cameraUniformBuffer.init(sizeof(CameraUniforms), UniformBlockBinding::CAMERA);
+	previewLightingUniformBuffer.init(sizeof(PreviewLightingUniforms), UniformBlockBinding::PREVIEW_LIGHTING);
+	normalViewUniformBuffer.init(sizeof(NormalViewUniforms), UniformBlockBinding::NORMAL_VIEW);
+	renderGraph.init();
+	previewNormalCache.init();
+	normalmapShaders.addUniformBlock("NormalViewBlock", UniformBlockBinding::NORMAL_VIEW);
+	modelViewShaders.addUniformBlock("CameraBlock", UniformBlockBinding::CAMERA);
+	modelViewShaders.addUniformBlock("PreviewLightingBlock", UniformBlockBinding::PREVIEW_LIGHTING);
+	modelAttribViewShader.bindUniformBlock("CameraBlock", UniformBlockBinding::CAMERA);
+	gridLineShader.bindUniformBlock("CameraBlock", UniformBlockBinding::CAMERA);
 #pragma endregion
 
 #pragma region SHADER UNIFORM IDS
 	//Frame panel uniforms
 	const int frameModelMatrixUniform = frameShader.getUniformLocation("model");
 
-	//Normal map uniforms
-	const int normalPanelModelMatrixUniform = normalmapShader.getUniformLocation("model");
-	const int strengthValueUniform = normalmapShader.getUniformLocation("_HeightmapStrength");
-	const int normalMapModeOnUniform = normalmapShader.getUniformLocation("_normalMapModeOn");
-	const int widthUniform = normalmapShader.getUniformLocation("_HeightmapDimX");
-	const int heightUniform = normalmapShader.getUniformLocation("_HeightmapDimY");
-	const int specularityUniform = normalmapShader.getUniformLocation("_Specularity");
-	const int specularityStrengthUniform = normalmapShader.getUniformLocation("_SpecularStrength");
-	const int lightIntensityUniform = normalmapShader.getUniformLocation("_LightIntensity");
-	const int flipXYdirUniform = normalmapShader.getUniformLocation("_flipX_Ydir");
-	const int RedChannelUniform = normalmapShader.getUniformLocation("_Channel_R");
-	const int GreenChannelUniform = normalmapShader.getUniformLocation("_Channel_G");
-	const int BlueChannelUniform = normalmapShader.getUniformLocation("_Channel_B");
-	const int lightDirectionUniform = normalmapShader.getUniformLocation("lightDir");
-	const int methodIndexUniform = normalmapShader.getUniformLocation("_MethodIndex");
-	const int textureOneIndexUniform = normalmapShader.getUniformLocation("textureOne");
-	const int textureTwoIndexUniform = normalmapShader.getUniformLocation("textureTwo");
-	const int useNormalInputUniform = normalmapShader.getUniformLocation("_UseNormalInput");
-	const int normalBlendingMethod = normalmapShader.getUniformLocation("_NormalBlendingMethod");
+	//Normal map and model preview uniforms are looked up per variant, see UseNormalPanelVariant
 
 	//Brush uniforms
 	const int brushPreviewModelUniform = brushPreviewShader.getUniformLocation("model");
@@ -276,46 +321,26 @@ int main(void)
 	const int brushPreviewColourUniform = brushPreviewShader.getUniformLocation("_BrushColour");
 	const int brushPreviewUseTextureUniform = brushPreviewShader.getUniformLocation("_UseTexture");
 
-	//Model preview uniforms
-	const int modelPreviewModelUniform = modelViewShader.getUniformLocation("model");
-	const int modelPreviewViewUniform = modelViewShader.getUniformLocation("view");
-	const int modelPreviewProjectionUniform = modelViewShader.getUniformLocation("projection");
-	const int modelCameraPos = modelViewShader.getUniformLocation("_CameraPosition");
-	const int modelWidthUniform = modelViewShader.getUniformLocation("_HeightmapDimX");
-	const int modelHeightUniform = modelViewShader.getUniformLocation("_HeightmapDimY");
-	const int modelNormalMapModeUniform = modelViewShader.getUniformLocation("_normalMapModeOn");
-	const int modelNormalMapStrengthUniform = modelViewShader.getUniformLocation("_HeightmapStrength");
-	const int modelLightIntensityUniform = modelViewShader.getUniformLocation("_LightIntensity");
-	const int modelRoughnessUniform = modelViewShader.getUniformLocation("_Roughness");
-	const int modelMetalnessUniform = modelViewShader.getUniformLocation("_Metalness");
-	const int modelLightPositionUniform = modelViewShader.getUniformLocation("lightPos");
-	const int modelLightColourUniform = modelViewShader.getUniformLocation("lightColour");
-	const int modelDiffuseColourUniform = modelViewShader.getUniformLocation("diffuseColour");
-	const int modelHeightMapTextureUniform = modelViewShader.getUniformLocation("heightmapTexture");
-	const int modelAlbedoMapTextureUniform = modelViewShader.getUniformLocation("albedomapTexture");
-	const int modelMetalnessMapTextureUniform = modelViewShader.getUniformLocation("metalnessmapTexture");
-	const int modelRoughnessMapTextureUniform = modelViewShader.getUniformLocation("roughnessmapTexture");
-	const int modelMatcapTextureUniform = modelViewShader.getUniformLocation("mapcapTexture");
-	const int modelCubeMapTextureUniform = modelViewShader.getUniformLocation("skybox");
-	const int modelMethodIndexUniform = modelViewShader.getUniformLocation("_MethodIndex");
-	const int modelUseMatcapUniform = modelViewShader.getUniformLocation("_Use_Matcap");
-
 	//Model attributes uniforms
-	const int modelAttributesShowNormalsUniform = modelAttribViewShader.getUniformLocation("_ShowNormals");
+	const int modelAttributesModelUniform = modelAttribViewShader.getUniformLocation("model");
 	const int modelAttributesNormalLengthUniform = modelAttribViewShader.getUniformLocation("_NormalsLength");
 
 	//Gridlines uniforms
 	const int gridLineModelMatrixUniform = gridLineShader.getUniformLocation("model");
-	const int gridLineViewMatrixUniform = gridLineShader.getUniformLocation("view");
-	const int gridLineProjectionMatrixUniform = gridLineShader.getUniformLocation("projection");
 #pragma endregion
 
 	bool isMaximized = false;
 	bool isBlurOn = false;
 
+	StartupProfiler::beginPhase("Layers and autosave recovery");
 	layerManager.init(windowSys.getWindowRes(), glm::vec2(preferencesInfo.maxWidthRes, preferencesInfo.maxHeightRes));
 	layerManager.addLayer(heightMapTexData.getTexId(), LayerType::HEIGHT_MAP);
 
+	//Start journaling edits, replaying the journal of a session that did not exit cleanly
+	autosaveJournal.init(AUTOSAVE_JOURNAL_PATH);
+	RecoverAutosavedChanges();
+
+	StartupProfiler::beginPhase("Frame buffers");
 	fbs.init(windowSys.getWindowRes(), glm::vec2(preferencesInfo.maxWidthRes, preferencesInfo.maxHeightRes));
 	previewFbs.init(windowSys.getWindowRes(), glm::vec2(1920, 1920));
 
@@ -329,13 +354,21 @@ int main(void)
 	bool changeSize = false;
 
 	//std::thread applyPanelChangeThread(ApplyChangesToPanel);
+	FrameScheduler::init(const_cast<GLFWwindow*>(windowSys.getWindow()));
 	double initTime = glfwGetTime();
+	StartupProfiler::beginPhase("First frame");
+	bool isFirstFrame = true;
 	while (!windowSys.isWindowClosing())
 	{
+		//Time spent sleeping is not part of the frame time
+		initTime += FrameScheduler::waitForEvents(IDLE_WAIT_TIMEOUT_SECONDS);
 		const double deltaTime = glfwGetTime() - initTime;
 		initTime = glfwGetTime();
 		if (shouldSaveNormalMap)
+		{
 			SetStatesForSavingNormalMap();
+			FrameScheduler::invalidate(REDRAW_ALL);
+		}
 		static glm::vec2 initPos = glm::vec2(-1000, -1000);
 		static WindowSide windowSideAtInitPos = WindowSide::NONE;
 
@@ -374,82 +407,240 @@ int main(void)
 			HandleLeftMouseButtonInput_NormalMapInteraction(leftMouseButtonState, frameDrawingPanel, isBlurOn);
 		}
 
-		heightMapTexData.updateTexture();
+		if (heightMapTexData.updateTexture())
+			FrameScheduler::invalidate(REDRAW_ALL);
+		if (asyncTextureLoader.processUploads(TEXTURE_UPLOAD_BUDGET_MS))
+			FrameScheduler::invalidate(REDRAW_PREVIEW | REDRAW_UI);
+		if (ModelObject* loadedModel = asyncModelLoader.takeLoadedModel())
+		{
+			delete modelPreviewObj;
+			modelPreviewObj = loadedModel;
+			FrameScheduler::invalidate(REDRAW_PREVIEW | REDRAW_UI);
+		}
+		if (modelPreviewObj != nullptr && asyncModelLoader.takeLoadedLods(*modelPreviewObj))
+			FrameScheduler::invalidate(REDRAW_PREVIEW);
+		if (environmentLighting.processUpload())
+			FrameScheduler::invalidate(REDRAW_PREVIEW);
+		//Keeps the import progress bar moving
+		if (asyncModelLoader.isLoading())
+			FrameScheduler::invalidate(REDRAW_UI);
+		if (layerManager.loadPendingLayerData(isUsingLayerOutput))
+			FrameScheduler::invalidate(REDRAW_ALL);
+		autosaveJournal.update(glfwGetTime(), heightMapTexData);
+		//Frames keep coming until the preview is refined to the size it is shown at
+		if ((isPreviewPanelActive || isPreviewWindowMaximized) && previewResolution.isOutdated(glfwGetTime(), windowSys.getWindowRes()))
+			FrameScheduler::invalidate(REDRAW_PREVIEW | REDRAW_UI);
+		if (!FrameScheduler::beginFrame())
+			continue;
+		GL::beginFrame();
 
 		GL::setViewport(glm::vec2(0), windowSys.getWindowRes());
-		GL::setClearColour(0.9f, 0.5f, 0.2f);
-		GL::enableDepthTest();
-		GL::setDepthTestMode(DepthTestMode::DEPTH_LESS);
-		normalmapPanel.getTransform()->update();
-		normalmapShader.use();
-		//---- Applying Normal Map Shader Uniforms---//
-		normalmapShader.applyShaderUniformMatrix(normalPanelModelMatrixUniform, glm::mat4(1));
-		normalmapShader.applyShaderFloat(strengthValueUniform, normalViewStateUtility.normalMapStrength);
-		normalmapShader.applyShaderFloat(specularityUniform, normalViewStateUtility.specularity);
-		normalmapShader.applyShaderFloat(specularityStrengthUniform, normalViewStateUtility.specularityStrength);
-		normalmapShader.applyShaderFloat(lightIntensityUniform, normalViewStateUtility.lightIntensity);
-		normalmapShader.applyShaderVector3(lightDirectionUniform, normalViewStateUtility.getNormalizedLightDir());
-		normalmapShader.applyShaderFloat(widthUniform, heightMapTexData.getRes().x);
-		normalmapShader.applyShaderFloat(heightUniform, heightMapTexData.getRes().y);
-		normalmapShader.applyShaderBool(flipXYdirUniform, normalViewStateUtility.flipX_Ydir);
-		normalmapShader.applyShaderBool(RedChannelUniform, normalViewStateUtility.redChannelActive);
-		normalmapShader.applyShaderBool(GreenChannelUniform, normalViewStateUtility.greenChannelActive);
-		normalmapShader.applyShaderBool(BlueChannelUniform, normalViewStateUtility.blueChannelActive);
-		normalmapShader.applyShaderBool(methodIndexUniform, normalViewStateUtility.methodIndex);
-		normalmapShader.applyShaderInt(textureOneIndexUniform, 0);
-		normalmapShader.applyShaderInt(textureTwoIndexUniform, 1);
-		normalmapShader.applyShaderInt(useNormalInputUniform, 3);
+		renderGraph.beginFrame();
+		//Layer passes and the composite only change when the heightmap, the layers or the view settings do
+		if (FrameScheduler::needsRedraw(REDRAW_NORMAL_MAP))
+			renderGraph.consume("normalMap");
+		else
+			renderGraph.markUpToDate("layerOutput");
+		//Nothing is drawn while the preview is hidden, and the first frame is shown before its resources are loaded
+		if ((isPreviewPanelActive || isPreviewWindowMaximized) && !isFirstFrame && FrameScheduler::needsRedraw(REDRAW_PREVIEW))
+			renderGraph.consume("preview");
+
 		//---- Draw each of the layers to a frame buffer----//
-		for (int layerIndex = 0; layerIndex < layerManager.getLayerCount(); layerIndex++)
+		const auto drawLayers = [&](int firstLayer, int lastLayer)
+		{
+			GL::setClearColour(0.9f, 0.5f, 0.2f);
+			GL::enableDepthTest();
+			GL::setDepthTestMode(DepthTestMode::DEPTH_LESS);
+			normalmapPanel.getTransform()->update();
+			UpdateNormalViewUniforms();
+			for (int layerIndex = firstLayer; layerIndex < lastLayer; layerIndex++)
+			{
+				if (!layerManager.isLayerResident(layerIndex))
+					continue;
+				layerManager.bindFrameBuffer(layerIndex);
+				GL::clear(FrameBufferAttachment::COLOUR_AND_DEPTH_BUFFER);
+
+				int mapDrawMode = (layerManager.getLayerType(layerIndex) == LayerType::HEIGHT_MAP) ? 1 : 3;
+				if (layerIndex == 0 && !isUsingLayerOutput)
+					mapDrawMode = normalViewStateUtility.mapDrawViewMode;
+				const ShaderProgram& layerShader = UseNormalPanelVariant(3, mapDrawMode, 0);
+				ShaderProgram::applyShaderFloat(layerShader.getUniformLocation("_HeightmapStrength"), (layerIndex == 0) ? normalViewStateUtility.normalMapStrength : layerManager.getLayerStrength(layerIndex));
+				normalmapPanel.setTextureID(layerManager.getInputTexId(layerIndex), false);
+				normalmapPanel.draw();
+			}
+		};
+		renderGraph.addPass("Base layer", { "heightmap" }, { "baseLayer" }, [&]() { drawLayers(0, 1); });
+		renderGraph.addPass("Layers", {}, { "layers" }, [&]() { drawLayers(1, layerManager.getLayerCount()); });
+
+		//RAW DATA mode shows the base layer on its own, so the other layers are not read
+		std::vector<std::string> compositeInputs = { "baseLayer" };
+		std::vector<std::string> compositeOutputs = { "normalMap" };
+		if (isUsingLayerOutput)
+		{
+			compositeInputs.push_back("layers");
+			compositeOutputs.push_back("layerOutput");
+		}
+		renderGraph.addPass("Composite", compositeInputs, compositeOutputs, [&]()
 		{
-			layerManager.bindFrameBuffer(layerIndex);
+			if (shouldSaveNormalMap)
+				SetStatesForSavingNormalMap();
+			//---- Bind main frame buffer and set output to cumulative blending ----//
+			GL::disableDepthTest();
+			fbs.bindFrameBuffer();
 			GL::clear(FrameBufferAttachment::COLOUR_AND_DEPTH_BUFFER);
 
-			normalmapShader.applyShaderFloat(strengthValueUniform, (layerIndex == 0) ? normalViewStateUtility.normalMapStrength : layerManager.getLayerStrength(layerIndex));
-			normalmapShader.applyShaderInt(normalMapModeOnUniform, (layerManager.getLayerType(layerIndex) == LayerType::HEIGHT_MAP) ? 1 : 3);
-			if (layerIndex == 0 && !isUsingLayerOutput)
-				normalmapShader.applyShaderInt(normalMapModeOnUniform, normalViewStateUtility.mapDrawViewMode);
-			normalmapPanel.setTextureID(layerManager.getInputTexId(layerIndex), false);
+			normalmapPanel.setTextureID(layerManager.getColourTexture(0), false);
+			UseNormalPanelVariant(2, 0, 0);
 			normalmapPanel.draw();
-		}
 
-		if (shouldSaveNormalMap)
-			SetStatesForSavingNormalMap();
-		//---- Bind main frame buffer and set output to cumulative blending ----//
-		GL::disableDepthTest();
-		fbs.bindFrameBuffer();
-		GL::clear(FrameBufferAttachment::COLOUR_AND_DEPTH_BUFFER);
+			if (isUsingLayerOutput)
+			{
+				if (layerManager.getLayerCount() >= 1)
+				{
+					for (int i = 1; i < layerManager.getLayerCount(); i++)
+					{
+						if (!layerManager.isLayerActive(i) || !layerManager.isLayerResident(i))
+							continue;
+						UseNormalPanelVariant(1, 0, static_cast<int>(layerManager.getNormalBlendMethod(i)));
+						normalmapPanel.setTextureID(fbs.getColourTexture(), false);
+						normalmapPanel.draw(layerManager.getColourTexture(i));
+					}
+				}
 
-		normalmapPanel.setTextureID(layerManager.getColourTexture(0), false);
-		normalmapShader.applyShaderInt(useNormalInputUniform, 2);
-		normalmapShader.applyShaderInt(normalBlendingMethod, static_cast<int>(layerManager.getNormalBlendMethod(0)));
-		normalmapShader.applyShaderInt(normalMapModeOnUniform, 0);
-		normalmapPanel.draw();
+				//Copy content from one frame buffer to another
+				FrameBufferSystem::blit(fbs, layersNormalOutputFbs, windowSys.getMaxWindowRes());
+				layersNormalOutputFbs.generateColourMipmaps();
 
-		if (isUsingLayerOutput)
+				UseNormalPanelVariant(2, normalViewStateUtility.mapDrawViewMode, 0);
+				normalmapPanel.draw();
+			}
+		});
+
+		//The preview reads the blended layer output, in RAW DATA mode it reads normals baked from the heightmap
+		PreviewNormalBakeKey previewNormalBakeKey;
+		previewNormalBakeKey.heightmapVersion = heightMapTexData.getVersion();
+		previewNormalBakeKey.resolution = heightMapTexData.getRes();
+		previewNormalBakeKey.methodIndex = normalViewStateUtility.methodIndex;
+		previewNormalBakeKey.heightmapStrength = normalViewStateUtility.normalMapStrength;
+		previewNormalBakeKey.flipXYdir = normalViewStateUtility.flipX_Ydir;
+		if (!previewNormalCache.isOutdated(previewNormalBakeKey))
+			renderGraph.markUpToDate("previewNormals");
+		renderGraph.addPass("Preview normal bake", { "heightmap" }, { "previewNormals" }, [&]()
+		{
+			GL::disableDepthTest();
+			UpdateNormalViewUniforms();
+			previewNormalCache.beginBake(previewNormalBakeKey);
+			UseNormalPanelVariant(3, 4, 0);
+			normalmapPanel.setTextureID(heightMapTexData.getTexId(), false);
+			normalmapPanel.draw();
+			previewNormalCache.endBake(previewNormalBakeKey);
+			GL::setViewport(glm::vec2(0), windowSys.getWindowRes());
+		});
+
+		// Set up the preview frame buffer and then render the 3d model
+		const char* const previewInput = (isUsingLayerOutput) ? "layerOutput" : ((previewStateUtility.modelViewMode == 1) ? "heightmap" : "previewNormals");
+		//The preview only fills the bottom left part of previewFbs that matches its on-screen size
+		glm::ivec2 previewRenderSize;
+		renderGraph.addPass("Preview model", { previewInput }, { "preview" }, [&]()
 		{
-			normalmapShader.applyShaderInt(useNormalInputUniform, 1);
+			static float circleAround = 2.5f;
+			static float yAxis = -2.0f;
+			glm::vec3 cameraPosition;
+			static glm::ivec2 prevMcord;
+			const glm::vec2 offset = (prevMcord - windowSys.getCursorPos());
 
-			if (layerManager.getLayerCount() >= 1)
+			if (leftMouseButtonState == GLFW_PRESS && glm::length(offset) > 0.0f && canPerformPreviewWindowMouseOperations)
 			{
-				for (int i = 1; i < layerManager.getLayerCount(); i++)
-				{
-					if (!layerManager.isLayerActive(i))
-						continue;
-					normalmapShader.applyShaderInt(normalBlendingMethod, static_cast<int>(layerManager.getNormalBlendMethod(i)));
-					normalmapPanel.setTextureID(fbs.getColourTexture(), false);
-					normalmapPanel.draw(layerManager.getColourTexture(i));
-				}
+				circleAround += offset.x * 0.01f;
+				yAxis += offset.y * 0.01f;
+				previewResolution.onInteraction(glfwGetTime());
 			}
+			yAxis = glm::clamp(yAxis, -100.0f, 100.0f);
+			cameraPosition.x = glm::sin(circleAround) * previewStateUtility.modelPreviewZoomLevel;
+			cameraPosition.z = glm::cos(circleAround) * previewStateUtility.modelPreviewZoomLevel;
+			cameraPosition.y = yAxis;
+
+			if (glm::length(cameraPosition) > previewStateUtility.modelPreviewZoomLevel)
+				cameraPosition = -glm::normalize(cameraPosition) * previewStateUtility.modelPreviewZoomLevel;
+			prevMcord = windowSys.getCursorPos();
+
+			previewRenderSize = previewResolution.getRenderSize(glfwGetTime(), windowSys.getWindowRes());
+			previewResolution.setRenderedSize(previewRenderSize, windowSys.getWindowRes());
+			previewFbs.bindFrameBuffer();
+			GL::setViewport(glm::ivec2(0), previewRenderSize);
+			GL::clear(FrameBufferAttachment::COLOUR_AND_DEPTH_BUFFER);
+			LoadPreviewResources();
+			GL::enableDepthTest();
+			GL::setDepthTestMode(DepthTestMode::DEPTH_LESS);
+
+			// Set up preview model uniforms
+			const glm::mat4 viewProjection = UpdatePreviewUniforms(cameraPosition);
+			const Frustum previewFrustum(viewProjection);
+			//Coarser LODs only stand in while the camera moves, the frame rendered once it stops is at full detail
+			unsigned int previewLod = 0;
+			if (modelPreviewObj != nullptr && previewResolution.isInteracting(glfwGetTime()))
+				previewLod = modelPreviewObj->selectLod(viewProjection, previewRenderSize);
+			//Features the selected mode does not read are zeroed so they do not create duplicate variants
+			const int modelViewMode = previewStateUtility.modelViewMode;
+			const bool useMatcap = modelViewMode == 2 && previewStateUtility.useMatcap;
+			ShaderProgram& modelViewShader = modelViewShaders.getVariant({ modelViewMode, useMatcap ? 1 : 0 });
+			modelViewShader.use();
+			modelViewShader.applyShaderUniformMatrix(modelViewShader.getUniformLocation("model"), glm::mat4());
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("heightmapTexture"), 0);
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("albedomapTexture"), 1);
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("metalnessmapTexture"), 2);
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("roughnessmapTexture"), 3);
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("mapcapTexture"), 4);
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("prefilteredEnvironment"), 5);
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("normalmapTexture"), 6);
+			modelViewShader.applyShaderInt(modelViewShader.getUniformLocation("brdfLUT"), 7);
+
+			GL::bindTexture(TextureType::TEXTURE_2D, (isUsingLayerOutput) ? layersNormalOutputFbs.getColourTexture() : heightMapTexData.getTexId(), 0);
+			GL::bindTexture(TextureType::TEXTURE_2D, albedoTexDataForPreview.getTexId(), 1);
+			GL::bindTexture(TextureType::TEXTURE_2D, metalnessTexDataForPreview.getTexId(), 2);
+			GL::bindTexture(TextureType::TEXTURE_2D, roughnessTexDataForPreview.getTexId(), 3);
+			GL::bindTexture(TextureType::TEXTURE_2D, matcapTexDataForPreview.getTexId(), 4);
+			GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, environmentLighting.getPrefilteredTexture(), 5);
+			GL::bindTexture(TextureType::TEXTURE_2D, (isUsingLayerOutput) ? layersNormalOutputFbs.getColourTexture() : previewNormalCache.getTexture(), 6);
+			GL::bindTexture(TextureType::TEXTURE_2D, environmentLighting.getBrdfLutTexture(), 7);
+			if (modelPreviewObj != nullptr)
+				modelPreviewObj->draw(previewFrustum, previewLod);
+			GL::setActiveTextureIndex(0);
+		});
 
-			//Copy content from one frame buffer to another
-			FrameBufferSystem::blit(fbs, layersNormalOutputFbs, windowSys.getMaxWindowRes());
+		//The lines are only built once normals are first shown
+		if (previewStateUtility.showNormals)
+		{
+			renderGraph.addPass("Preview normals", { "preview" }, { "preview" }, [&]()
+			{
+				previewFbs.bindFrameBuffer();
+				GL::setViewport(glm::ivec2(0), previewRenderSize);
+				modelAttribViewShader.use();
+				modelAttribViewShader.applyShaderUniformMatrix(modelAttributesModelUniform, glm::mat4());
+				modelAttribViewShader.applyShaderFloat(modelAttributesNormalLengthUniform, previewStateUtility.normDisplayLineLength);
+				if (modelPreviewObj != nullptr)
+					modelPreviewObj->drawAttributeLines();
+			});
+		}
 
-			normalmapShader.applyShaderInt(useNormalInputUniform, 2);
-			normalmapShader.applyShaderInt(normalMapModeOnUniform, normalViewStateUtility.mapDrawViewMode);
-			normalmapPanel.draw();
+#pragma region GRID SETUP & RENDER
+		if (previewStateUtility.showGrid)
+		{
+			renderGraph.addPass("Preview grid", { "preview" }, { "preview" }, [&]()
+			{
+				previewFbs.bindFrameBuffer();
+				GL::setViewport(glm::ivec2(0), previewRenderSize);
+				gridLineShader.use();
+				gridLineShader.applyShaderUniformMatrix(gridLineModelMatrixUniform, glm::scale(glm::mat4(), glm::vec3(100, 0, 100)));
+				if (previewGrid != nullptr)
+					previewGrid->draw();
+			});
 		}
+#pragma endregion
+		renderGraph.execute();
+		GL::setViewport(glm::vec2(0), windowSys.getWindowRes());
 
+		GL::disableDepthTest();
 		FrameBufferSystem::bindDefaultFrameBuffer();
 		GL::setClearColour(0.1f, 0.1f, 0.1f);
 		GL::clear(FrameBufferAttachment::COLOUR_AND_DEPTH_BUFFER);
@@ -480,6 +671,7 @@ int main(void)
 				else
 					modalWindow.setModalDialog("ERROR", "The extension '" + fileExt + "' is not supported\n Choose from .png, .jpg, .tga or .bmp");
 				//fbs.updateTextureDimensions(windowSys.getWindowRes().x, windowSys.getWindowRes().y);
+				FrameScheduler::invalidate(REDRAW_UI);
 				continue;
 			}
 			//Image validation stage over
@@ -487,6 +679,8 @@ int main(void)
 			shouldSaveNormalMap = false;
 			modalWindow.setModalDialog("INFO", "Image exported to : " + path + "\nResolution : " +
 				std::to_string(heightMapTexData.getRes().x) + "x" + std::to_string(heightMapTexData.getRes().y));
+			//Nothing is presented on the export frame, the modal is shown by the next one and the resized frame buffer redrawn
+			FrameScheduler::invalidate(REDRAW_ALL);
 			continue;
 		}
 
@@ -502,100 +696,6 @@ int main(void)
 		frameDrawingPanel.setTextureID(fbs.getColourTexture());
 		frameDrawingPanel.draw();
 
-		// Set up the preview frame buffer and then render the 3d model
-		previewFbs.bindFrameBuffer();
-
-		GL::clear(FrameBufferAttachment::COLOUR_AND_DEPTH_BUFFER);
-		GL::enableDepthTest();
-		GL::setDepthTestMode(DepthTestMode::DEPTH_LESS);
-
-		static float circleAround = 2.5f;
-		static float yAxis = -2.0f;
-		glm::vec3 cameraPosition;
-		static glm::ivec2 prevMcord;
-		const glm::vec2 offset = (prevMcord - windowSys.getCursorPos());
-
-		if (leftMouseButtonState == GLFW_PRESS && glm::length(offset) > 0.0f && canPerformPreviewWindowMouseOperations)
-		{
-			circleAround += offset.x * 0.01f;
-			yAxis += offset.y * 0.01f;
-		}
-		yAxis = glm::clamp(yAxis, -100.0f, 100.0f);
-		cameraPosition.x = glm::sin(circleAround) * previewStateUtility.modelPreviewZoomLevel;
-		cameraPosition.z = glm::cos(circleAround) * previewStateUtility.modelPreviewZoomLevel;
-		cameraPosition.y = yAxis;
-
-		if (glm::length(cameraPosition) > previewStateUtility.modelPreviewZoomLevel)
-			cameraPosition = -glm::normalize(cameraPosition) * previewStateUtility.modelPreviewZoomLevel;
-		prevMcord = windowSys.getCursorPos();
-
-		// Set up preview model uniforms
-		modelViewShader.use();
-		modelViewShader.applyShaderUniformMatrix(modelPreviewModelUniform, glm::mat4());
-		modelViewShader.applyShaderUniformMatrix(modelPreviewViewUniform, glm::lookAt(cameraPosition, glm::vec3(0), glm::vec3(0, 1, 0)));
-		modelViewShader.applyShaderUniformMatrix(modelPreviewProjectionUniform, glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f));
-		modelViewShader.applyShaderVector3(modelCameraPos, cameraPosition);
-		modelViewShader.applyShaderInt(modelNormalMapModeUniform, previewStateUtility.modelViewMode);
-		modelViewShader.applyShaderFloat(modelNormalMapStrengthUniform, normalViewStateUtility.normalMapStrength);
-		modelViewShader.applyShaderFloat(modelWidthUniform, heightMapTexData.getRes().x);
-		modelViewShader.applyShaderFloat(modelHeightUniform, heightMapTexData.getRes().y);
-		modelViewShader.applyShaderFloat(modelLightIntensityUniform, previewStateUtility.lightIntensity);
-		modelViewShader.applyShaderFloat(modelRoughnessUniform, previewStateUtility.roughness);
-		modelViewShader.applyShaderFloat(modelMetalnessUniform, previewStateUtility.metalness);
-		glm::vec3 lightPos;
-		lightPos.x = sin(previewStateUtility.lightLocation.x) * 3;
-		lightPos.z = cos(previewStateUtility.lightLocation.x) * 3;
-		lightPos.y = previewStateUtility.lightLocation.y;
-		modelViewShader.applyShaderVector3(modelLightPositionUniform, lightPos);
-		modelViewShader.applyShaderInt(modelHeightMapTextureUniform, 0);
-		modelViewShader.applyShaderInt(modelAlbedoMapTextureUniform, 1);
-		modelViewShader.applyShaderInt(modelMetalnessMapTextureUniform, 2);
-		modelViewShader.applyShaderInt(modelRoughnessMapTextureUniform, 3);
-		modelViewShader.applyShaderInt(modelMatcapTextureUniform, 4);
-		modelViewShader.applyShaderInt(modelCubeMapTextureUniform, 5);
-
-		modelViewShader.applyShaderVector3(modelDiffuseColourUniform, previewStateUtility.diffuseColour);
-		modelViewShader.applyShaderVector3(modelLightColourUniform, previewStateUtility.lightColour);
-		modelViewShader.applyShaderInt(modelMethodIndexUniform, (isUsingLayerOutput) ? 2 : normalViewStateUtility.methodIndex);
-
-		modelViewShader.applyShaderBool(modelUseMatcapUniform, previewStateUtility.useMatcap);
-
-		GL::setActiveTextureIndex(0);
-		glBindTexture(TextureType::TEXTURE_2D, (isUsingLayerOutput) ? layersNormalOutputFbs.getColourTexture() : heightMapTexData.getTexId());
-		GL::setActiveTextureIndex(1);
-		glBindTexture(TextureType::TEXTURE_2D, albedoTexDataForPreview.getTexId());
-		GL::setActiveTextureIndex(2);
-		glBindTexture(TextureType::TEXTURE_2D, metalnessTexDataForPreview.getTexId());
-		GL::setActiveTextureIndex(3);
-		glBindTexture(TextureType::TEXTURE_2D, roughnessTexDataForPreview.getTexId());
-		GL::setActiveTextureIndex(4);
-		glBindTexture(TextureType::TEXTURE_2D, matcapTexDataForPreview.getTexId());
-		GL::setActiveTextureIndex(5);
-		glBindTexture(TextureType::TEXTURE_CUBE_MAP, cubeMapTextureId);
-		if (modelPreviewObj != nullptr)
-			modelPreviewObj->draw();
-
-		modelAttribViewShader.use();
-		modelAttribViewShader.applyShaderUniformMatrix(modelPreviewModelUniform, glm::mat4());
-		modelAttribViewShader.applyShaderUniformMatrix(modelPreviewViewUniform, glm::lookAt(cameraPosition, glm::vec3(0), glm::vec3(0, 1, 0)));
-		modelAttribViewShader.applyShaderUniformMatrix(modelPreviewProjectionUniform, glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f));
-		modelAttribViewShader.applyShaderBool(modelAttributesShowNormalsUniform, previewStateUtility.showNormals);
-		modelAttribViewShader.applyShaderFloat(modelAttributesNormalLengthUniform, previewStateUtility.normDisplayLineLength);
-		if (modelPreviewObj != nullptr)
-			modelPreviewObj->draw();
-		GL::setActiveTextureIndex(0);
-
-#pragma region GRID SETUP & RENDER
-		// Set up preview shader uniforms
-		if (previewStateUtility.showGrid)
-		{
-			gridLineShader.use();
-			gridLineShader.applyShaderUniformMatrix(gridLineModelMatrixUniform, glm::scale(glm::mat4(), glm::vec3(100, 0, 100)));
-			gridLineShader.applyShaderUniformMatrix(gridLineViewMatrixUniform, glm::lookAt(cameraPosition, glm::vec3(0), glm::vec3(0, 1, 0)));
-			gridLineShader.applyShaderUniformMatrix(gridLineProjectionMatrixUniform, glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f));
-			previewGrid->draw();
-		}
-#pragma endregion
 		// Set up the default framebuffer
 		FrameBufferSystem::bindDefaultFrameBuffer();
 #pragma region  SETUP & RENDER BRUSH DATA
@@ -687,18 +787,36 @@ int main(void)
 
 		ImGui::Render();
 
-		GL::bindVertexArray(NULL);
-		glUseProgram(0);
+		GL::bindVertexArray(0);
+		GL::useProgram(0);
 		ImGui_ImplOpenGL2_RenderDrawData(ImGui::GetDrawData());
+		//The ImGui renderer sets GL state directly
+		GL::invalidateStateCache();
 		windowSys.updateWindow();
+		if (isFirstFrame)
+		{
+			StartupProfiler::endPhase();
+			StartupProfiler::finishStartup();
+			StartupProfiler::writeReport(STARTUP_REPORT_PATH);
+			isFirstFrame = false;
+		}
 
 	}
 	//applyPanelChangeThread.join();
 	brushData.textureData.clearRawData();
+	//Exiting normally, the journal is no longer needed for recovery
+	autosaveJournal.shutDown(true);
+	asyncTextureLoader.shutDown();
+	asyncModelLoader.shutDown();
+	environmentLighting.shutDown();
 
 	delete modelPreviewObj;
-	delete cubeForSkybox;
 	delete previewGrid;
+	cameraUniformBuffer.destroy();
+	previewLightingUniformBuffer.destroy();
+	normalViewUniformBuffer.destroy();
+	renderGraph.destroy();
+	previewNormalCache.destroy();
 
 	fileOpenDialog->shutDown();
 	fileSaveDialog->shutDown();
@@ -735,6 +853,7 @@ inline void DisplaySideBar(const ImGuiWindowFlags& window_flags, DrawingPanel& f
 		std::memset(heightMapTexData.getTextureData(), 255, heightMapTexData.getRes().y * heightMapTexData.getRes().x * heightMapTexData.getComponentCount());
 		undoRedoSystem.record(heightMapTexData.getTextureData());
 		heightMapTexData.setTextureDirty();
+		autosaveJournal.markAllDirty();
 	}
 	if (ImGui::IsItemHovered())
 		ImGui::SetTooltip("Clear the panel (Ctrl + Alt + V)");
@@ -830,6 +949,20 @@ void DisplayBottomBar(const ImGuiWindowFlags& window_flags)
 
 	ImGui::Dummy(ImVec2(ImGui::GetContentRegionAvailWidth() * 0.5f - diffWidth * 0.5f, 0)); ImGui::SameLine();
 	ImGui::Text(VERSION_NAME.c_str());
+	if (ImGui::IsItemHovered())
+	{
+		const GLStateCounters& stateCounters = GL::getLastFrameCounters();
+		ImGui::BeginTooltip();
+		ImGui::Text("GL state calls last frame : %u issued, %u skipped", stateCounters.issuedCalls, stateCounters.skippedCalls);
+		for (const RenderPassTiming& timing : renderGraph.getTimings())
+		{
+			if (timing.gpuMs < 0.0)
+				ImGui::Text("%s%s : %.3f ms CPU", timing.name.c_str(), (timing.wasExecuted) ? "" : " (culled)", timing.cpuMs);
+			else
+				ImGui::Text("%s%s : %.3f ms CPU, %.3f ms GPU", timing.name.c_str(), (timing.wasExecuted) ? "" : " (culled)", timing.cpuMs, timing.gpuMs);
+		}
+		ImGui::EndTooltip();
+	}
 	ImGui::SameLine();
 
 	static int currentSection = undoRedoSystem.getCurrentSectionPosition();
@@ -848,6 +981,7 @@ void DisplayBottomBar(const ImGuiWindowFlags& window_flags)
 		for (int i = 0; i < count; i++)
 			heightMapTexData.updateTextureData(undoRedoSystem.retrieve(isForward));
 		heightMapTexData.updateTexture();
+		autosaveJournal.markAllDirty();
 		prevSection = currentSection;
 	}
 
@@ -883,7 +1017,7 @@ void SetupImGui()
 }
 void SetStatesForSavingNormalMap() noexcept
 {
-	glViewport(0, 0, heightMapTexData.getRes().x, heightMapTexData.getRes().y);
+	GL::setViewport(glm::ivec2(0), heightMapTexData.getRes());
 	fbs.updateTextureDimensions(heightMapTexData.getRes().x, heightMapTexData.getRes().y);
 }
 void HandleKeyboardInput(double deltaTime, DrawingPanel& frameDrawingPanel, bool& isMaximized)
@@ -940,6 +1074,7 @@ void HandleKeyboardInput(double deltaTime, DrawingPanel& frameDrawingPanel, bool
 	{
 		heightMapTexData.updateTextureData(undoRedoSystem.retrieve());
 		heightMapTexData.updateTexture();
+		autosaveJournal.markAllDirty();
 		if (undoRedoSystem.getCurrentSectionPosition() == 0)
 			undoRedoSystem.record(heightMapTexData.getTextureData());
 	}
@@ -948,6 +1083,7 @@ void HandleKeyboardInput(double deltaTime, DrawingPanel& frameDrawingPanel, bool
 	{
 		heightMapTexData.updateTextureData(undoRedoSystem.retrieve(false));
 		heightMapTexData.updateTexture();
+		autosaveJournal.markAllDirty();
 		if (undoRedoSystem.getCurrentSectionPosition() == 0)
 			undoRedoSystem.record(heightMapTexData.getTextureData());
 	}
@@ -1004,6 +1140,7 @@ void HandleKeyboardInput(double deltaTime, DrawingPanel& frameDrawingPanel, bool
 			std::memset(heightMapTexData.getTextureData(), 255, heightMapTexData.getRes().y * heightMapTexData.getRes().x * heightMapTexData.getComponentCount());
 			undoRedoSystem.record(heightMapTexData.getTextureData());
 			heightMapTexData.setTextureDirty();
+			autosaveJournal.markAllDirty();
 		}
 		//reset
 		else
@@ -1203,7 +1340,7 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 		{
 			ImGui::Dummy(ImVec2(((ImGui::GetContentRegionAvail().x - width) * 0.5f) - 10, 0));
 			ImGui::SameLine();
-			ImGui::Image((ImTextureID)previewFbs.getColourTexture(), ImVec2(width, height));
+			DrawPreviewImage(ImVec2(width, height), true);
 			if (ImGui::IsItemHovered())
 				canPerformPreviewWindowMouseOperations = true;
 			else
@@ -1212,7 +1349,7 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 		else
 		{
 			ImGui::Dummy(ImVec2(((ImGui::GetContentRegionAvail().x - width) * 0.5f) - 10, (ImGui::GetContentRegionAvail().y - height) * 0.5f));
-			ImGui::Image((ImTextureID)previewFbs.getColourTexture(), ImVec2(width, height));
+			DrawPreviewImage(ImVec2(width, height), true);
 			if (ImGui::IsItemHovered())
 				canPerformPreviewWindowMouseOperations = true;
 			else
@@ -1232,33 +1369,32 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 			if (ImGui::Selectable(items[n], is_selected))
 			{
 				current_item = items[n];
-				delete modelPreviewObj;
-				modelPreviewObj = nullptr;
+				//The current model stays on screen until the new one has been imported
 				switch (n)
 				{
 				case 0:
-					modelPreviewObj = modelLoader.createModelFromFile(CUBE_MODEL_PATH);
+					LoadPreviewModel(CUBE_MODEL_PATH);
 					break;
 				case 1:
-					modelPreviewObj = modelLoader.createModelFromFile(CYLINDER_MODEL_PATH);
+					LoadPreviewModel(CYLINDER_MODEL_PATH);
 					break;
 				case 2:
-					modelPreviewObj = modelLoader.createModelFromFile(SPHERE_MODEL_PATH);
+					LoadPreviewModel(SPHERE_MODEL_PATH);
 					break;
 				case 3:
-					modelPreviewObj = modelLoader.createModelFromFile(TORUS_MODEL_PATH);
+					LoadPreviewModel(TORUS_MODEL_PATH);
 					break;
 				case 4:
-					modelPreviewObj = modelLoader.createModelFromFile(COMPLEX_MODELS_PATH + "Suzanne.fbx");
+					LoadPreviewModel(COMPLEX_MODELS_PATH + "Suzanne.fbx");
 					break;
 				case 5:
-					modelPreviewObj = modelLoader.createModelFromFile(COMPLEX_MODELS_PATH + "Utah Teapot.fbx");
+					LoadPreviewModel(COMPLEX_MODELS_PATH + "Utah Teapot.fbx");
 					break;
 				case 6:
 					currentLoadingOption = LoadingOption::MODEL;
 					fileOpenDialog->displayDialog(FileType::MODEL, [&](std::string str)
 						{
-							modelPreviewObj = modelLoader.createModelFromFile(str);
+							LoadPreviewModel(str);
 						});
 					break;
 				default:
@@ -1273,6 +1409,15 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 	if (ImGui::IsItemHovered())
 		ImGui::SetTooltip("Load 3d model for preview");
 	ImGui::PopStyleVar();
+	if (asyncModelLoader.isLoading())
+	{
+		ImGui::ProgressBar(asyncModelLoader.getProgress(), ImVec2(ImGui::GetContentRegionAvailWidth() - 70, 0), "Importing model");
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("%s", asyncModelLoader.getLoadingPath().c_str());
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel", ImVec2(60, 0)))
+			asyncModelLoader.cancel();
+	}
 	ImGui::Spacing();
 	ImGui::PushItemWidth(ImGui::GetContentRegionAvailWidth() + 5);
 	ImGui::Checkbox("Grid", &previewStateUtility.showGrid); ImGui::SameLine();
@@ -1285,7 +1430,7 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 	ImGui::SliderFloat("##Normal Length", &previewStateUtility.normDisplayLineLength, 0.1f, 10.0f, "Len:%.2f");
 	ImGui::PopItemWidth();
 
-	ImGui::Image((ImTextureID)previewFbs.getColourTexture(), ImVec2(300, 300));
+	DrawPreviewImage(ImVec2(300, 300), false);
 	if (!isPreviewWindowMaximized)
 	{
 		if (ImGui::IsItemHovered())
@@ -1293,9 +1438,19 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 		else
 			canPerformPreviewWindowMouseOperations = false;
 	}
-	ImGui::SliderFloat("##Zoom level", &previewStateUtility.modelPreviewZoomLevel, -1.0f, -100.0f, "Zoom Level:%.2f");
+	if (ImGui::SliderFloat("##Zoom level", &previewStateUtility.modelPreviewZoomLevel, -1.0f, -100.0f, "Zoom Level:%.2f"))
+		previewResolution.onInteraction(glfwGetTime());
 	ImGui::SliderFloat("##Metalness", &previewStateUtility.metalness, 0.01f, 1.0f, "Metalness:%.2f");
 	ImGui::SliderFloat("##Roughness", &previewStateUtility.roughness, 0.01f, 10.0f, "Roughness:%.2f");
+	const char* const tangentSpaceItems[] = { "Tangents:Imported", "Tangents:MikkTSpace" };
+	int tangentSpaceIndex = static_cast<int>(modelLoader.getTangentSpace());
+	if (ImGui::Combo("##Tangent space", &tangentSpaceIndex, tangentSpaceItems, IM_ARRAYSIZE(tangentSpaceItems)))
+	{
+		modelLoader.setTangentSpace(static_cast<TangentSpace>(tangentSpaceIndex));
+		LoadPreviewModel(previewModelPath);
+	}
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Tangent basis of the preview model, MikkTSpace matches most bakers and engines");
 	ImGui::PopItemWidth();
 	ImGui::Spacing();
 	ImGui::Text("VIEW MODE");
@@ -1363,7 +1518,7 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 					{
 						previewStateUtility.useMatcap = true;
 						std::string matcapPath = MATCAP_TEXTURES_PATH + current_matcap_item + ".png";
-						matcapTexDataForPreview.setTexId(TextureManager::createTextureFromFile(matcapPath));
+						SetPreviewTextureFromFile(matcapTexDataForPreview, matcapPath);
 					}
 				}
 				if (is_selected)
@@ -1406,13 +1561,13 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 			fileOpenDialog->displayDialog(FileType::IMAGE, [&](std::string str)
 				{
 					if (currentLoadingOption == LoadingOption::TEXTURE)
-						albedoTexDataForPreview.setTexId(TextureManager::createTextureFromFile(str));
+						SetPreviewTextureFromFile(albedoTexDataForPreview, str);
 				});
 		}
 		if (ImGui::IsItemHovered())
 			ImGui::SetTooltip("Load albedo map for preview model");
 		ImGui::SameLine();
-		if (ImGui::Button("X", ImVec2(20, 40))) { albedoTexDataForPreview.setTexId(defaultWhiteTextureId); }
+		if (ImGui::Button("X", ImVec2(20, 40))) { asyncTextureLoader.cancel(albedoTexDataForPreview.getTexId()); albedoTexDataForPreview.setTexId(defaultWhiteTextureId); }
 
 		ImGui::Text("Metalness");
 		ImGui::SameLine(0, 5);
@@ -1423,13 +1578,13 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 			fileOpenDialog->displayDialog(FileType::IMAGE, [&](std::string str)
 				{
 					if (currentLoadingOption == LoadingOption::TEXTURE)
-						metalnessTexDataForPreview.setTexId(TextureManager::createTextureFromFile(str));
+						SetPreviewTextureFromFile(metalnessTexDataForPreview, str);
 				});
 		}
 		if (ImGui::IsItemHovered())
 			ImGui::SetTooltip("Load metalness map for preview model");
 		ImGui::SameLine();
-		if (ImGui::Button("X##2", ImVec2(20, 40))) { metalnessTexDataForPreview.setTexId(defaultWhiteTextureId); }
+		if (ImGui::Button("X##2", ImVec2(20, 40))) { asyncTextureLoader.cancel(metalnessTexDataForPreview.getTexId()); metalnessTexDataForPreview.setTexId(defaultWhiteTextureId); }
 
 		ImGui::Text("Roughness");
 		ImGui::SameLine(0, 5);
@@ -1440,13 +1595,13 @@ inline void DisplayPreview(const ImGuiWindowFlags& window_flags)
 			fileOpenDialog->displayDialog(FileType::IMAGE, [&](std::string str)
 				{
 					if (currentLoadingOption == LoadingOption::TEXTURE)
-						roughnessTexDataForPreview.setTexId(TextureManager::createTextureFromFile(str));
+						SetPreviewTextureFromFile(roughnessTexDataForPreview, str);
 				});
 		}
 		if (ImGui::IsItemHovered())
 			ImGui::SetTooltip("Load roughness map for preview model");
 		ImGui::SameLine();
-		if (ImGui::Button("X##3", ImVec2(20, 40))) { roughnessTexDataForPreview.setTexId(defaultWhiteTextureId); }
+		if (ImGui::Button("X##3", ImVec2(20, 40))) { asyncTextureLoader.cancel(roughnessTexDataForPreview.getTexId()); roughnessTexDataForPreview.setTexId(defaultWhiteTextureId); }
 
 		ImGui::PopStyleVar();
 	}
@@ -1520,6 +1675,7 @@ inline void DisplayWindowTopBar(unsigned int minimizeTexture, unsigned int resto
 			{
 				heightMapTexData.updateTextureData(undoRedoSystem.retrieve());
 				heightMapTexData.updateTexture();
+				autosaveJournal.markAllDirty();
 			}
 			if (isUndoDisabled)
 				ImGui::PopStyleVar();
@@ -1529,6 +1685,7 @@ inline void DisplayWindowTopBar(unsigned int minimizeTexture, unsigned int resto
 			{
 				heightMapTexData.updateTextureData(undoRedoSystem.retrieve(false));
 				heightMapTexData.updateTexture();
+				autosaveJournal.markAllDirty();
 			}
 			if (isRedoDisabled)
 				ImGui::PopStyleVar();
@@ -1615,6 +1772,83 @@ inline void DisplayWindowTopBar(unsigned int minimizeTexture, unsigned int resto
 	ImGui::EndMainMenuBar();
 	ImGui::PopStyleVar();
 }
+ShaderProgram& UseNormalPanelVariant(int useNormalInput, int mapDrawMode, int blendMethod)
+{
+	//Features the selected path of normalPanel.fs does not read are zeroed so they do not create duplicate variants
+	int methodIndex = normalViewStateUtility.methodIndex;
+	if (useNormalInput == 1)
+	{
+		mapDrawMode = 0;
+		methodIndex = 0;
+	}
+	else
+	{
+		blendMethod = 0;
+		if (useNormalInput != 3 || (mapDrawMode != 1 && mapDrawMode != 2 && mapDrawMode != 4))
+			methodIndex = 0;
+	}
+	ShaderProgram& shader = normalmapShaders.getVariant({ useNormalInput, mapDrawMode, methodIndex, blendMethod });
+	shader.use();
+	//Shared view state comes from NormalViewBlock, only per pass values are set on the variant
+	ShaderProgram::applyShaderUniformMatrix(shader.getUniformLocation("model"), glm::mat4(1));
+	ShaderProgram::applyShaderFloat(shader.getUniformLocation("_HeightmapStrength"), normalViewStateUtility.normalMapStrength);
+	ShaderProgram::applyShaderInt(shader.getUniformLocation("textureOne"), 0);
+	ShaderProgram::applyShaderInt(shader.getUniformLocation("textureTwo"), 1);
+	return shader;
+}
+
+void UpdateNormalViewUniforms()
+{
+	NormalViewUniforms uniforms = {};
+	uniforms.lightDirection = normalViewStateUtility.getNormalizedLightDir();
+	uniforms.heightmapWidth = heightMapTexData.getRes().x;
+	uniforms.heightmapHeight = heightMapTexData.getRes().y;
+	uniforms.specularity = normalViewStateUtility.specularity;
+	uniforms.specularStrength = normalViewStateUtility.specularityStrength;
+	uniforms.lightIntensity = normalViewStateUtility.lightIntensity;
+	uniforms.flipXYdir = normalViewStateUtility.flipX_Ydir ? 1 : 0;
+	uniforms.redChannel = normalViewStateUtility.redChannelActive ? 1 : 0;
+	uniforms.greenChannel = normalViewStateUtility.greenChannelActive ? 1 : 0;
+	uniforms.blueChannel = normalViewStateUtility.blueChannelActive ? 1 : 0;
+	normalViewUniformBuffer.update(uniforms);
+}
+
+//Returns the view projection matrix of the preview camera
+glm::mat4 UpdatePreviewUniforms(const glm::vec3& cameraPosition)
+{
+	CameraUniforms camera = {};
+	camera.view = glm::lookAt(cameraPosition, glm::vec3(0), glm::vec3(0, 1, 0));
+	camera.projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+	camera.cameraPosition = cameraPosition;
+	cameraUniformBuffer.update(camera);
+
+	PreviewLightingUniforms lighting = {};
+	lighting.lightPosition.x = sin(previewStateUtility.lightLocation.x) * 3;
+	lighting.lightPosition.z = cos(previewStateUtility.lightLocation.x) * 3;
+	lighting.lightPosition.y = previewStateUtility.lightLocation.y;
+	lighting.lightIntensity = previewStateUtility.lightIntensity;
+	lighting.lightColour = previewStateUtility.lightColour;
+	lighting.roughness = previewStateUtility.roughness;
+	lighting.diffuseColour = previewStateUtility.diffuseColour;
+	lighting.metalness = previewStateUtility.metalness;
+	lighting.heightmapStrength = normalViewStateUtility.normalMapStrength;
+	lighting.heightmapWidth = heightMapTexData.getRes().x;
+	lighting.heightmapHeight = heightMapTexData.getRes().y;
+	std::copy(environmentLighting.getIrradianceSH(), environmentLighting.getIrradianceSH() + IblData::SH_COEFFICIENT_COUNT, lighting.irradianceSH);
+	lighting.prefilteredMaxLod = environmentLighting.getPrefilteredMaxLod();
+	previewLightingUniformBuffer.update(lighting);
+	return camera.projection * camera.view;
+}
+
+void DrawPreviewImage(const ImVec2& size, bool isMaximizedView)
+{
+	//The side panel keeps drawing its image under the maximized view, only the view in front decides the preview resolution
+	if (isMaximizedView == isPreviewWindowMaximized)
+		previewResolution.setDisplaySize(glm::vec2(size.x, size.y));
+	const glm::vec2 renderedUV = previewResolution.getRenderedUV();
+	ImGui::Image((ImTextureID)previewFbs.getColourTexture(), size, ImVec2(0, 0), ImVec2(renderedUV.x, renderedUV.y));
+}
+
 void SaveNormalMapToFile(const std::string& locationStr, ImageFormat imageFormat)
 {
 	if (locationStr.length() > 4)
@@ -1626,12 +1860,85 @@ void SaveNormalMapToFile(const std::string& locationStr, ImageFormat imageFormat
 		char* const dataBuffer = new char[nSize];
 		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, dataBuffer);
 
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GL::bindTexture(TextureType::TEXTURE_2D, 0);
 		fbs.updateTextureDimensions(windowSys.getWindowRes().x, windowSys.getWindowRes().y);
 		TextureManager::saveImage(locationStr, heightMapTexData.getRes(), imageFormat, dataBuffer);
 		delete[] dataBuffer;
 	}
 }
+void LoadPreviewResources()
+{
+	if (arePreviewResourcesLoaded)
+		return;
+	{
+		StartupProfiler::ScopedTimer timer("Preview resources (deferred)");
+		arePreviewResourcesLoaded = true;
+		if (modelPreviewObj == nullptr)
+			modelPreviewObj = modelLoader.createModelFromFile(CUBE_MODEL_PATH); // Default loaded model in preview window
+		previewGrid = modelLoader.createModelFromFile(PLANE_MODEL_PATH);
+
+		std::vector<std::string> cubeMapImagePaths;
+		cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_lf.tga");
+		cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_rt.tga");
+		cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_dn.tga");
+		cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_up.tga");
+		cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_ft.tga");
+		cubeMapImagePaths.push_back(CUBEMAP_TEXTURES_PATH + "Sahara Desert Cubemap\\sahara_bk.tga");
+		environmentLighting.init(cubeMapImagePaths, FrameScheduler::wake);
+		if (matcapTexDataForPreview.getTexId() == 0)
+			matcapTexDataForPreview.setTexId(asyncTextureLoader.loadTexture(MATCAP_TEXTURES_PATH + "chrome.png"));
+	}
+	//Rewrite the report so the deferred load is listed with the start up phases
+	StartupProfiler::writeReport(STARTUP_REPORT_PATH);
+}
+void LoadPreviewModel(const std::string& path)
+{
+	previewModelPath = path;
+	asyncModelLoader.loadModel(path, modelLoader);
+}
+
+void SetPreviewTextureFromFile(TextureData& texData, const std::string& path)
+{
+	//The previous texture is deleted by setTexId, it must not receive a pending upload afterwards
+	asyncTextureLoader.cancel(texData.getTexId());
+	texData.setTexId(asyncTextureLoader.loadTexture(path));
+}
+NoraThumbnails CreateProjectThumbnails()
+{
+	//Drawn in normal mode at heightmap resolution like an export, so the thumbnail does not depend on the view mode or window size
+	const glm::ivec2 normalRes = heightMapTexData.getRes();
+	FrameBufferSystem thumbnailFbs;
+	thumbnailFbs.init(normalRes, normalRes);
+	thumbnailFbs.bindFrameBuffer();
+	GL::setViewport(glm::ivec2(0), normalRes);
+	GL::disableDepthTest();
+	GL::clear(FrameBufferAttachment::COLOUR_BUFFER);
+	UpdateNormalViewUniforms();
+	UseNormalPanelVariant(3, 4, 0);
+	normalmapPanel.setTextureID(heightMapTexData.getTexId(), false);
+	normalmapPanel.draw();
+	if (isUsingLayerOutput)
+	{
+		for (int i = 1; i < layerManager.getLayerCount(); i++)
+		{
+			if (!layerManager.isLayerActive(i) || !layerManager.isLayerResident(i))
+				continue;
+			UseNormalPanelVariant(1, 0, static_cast<int>(layerManager.getNormalBlendMethod(i)));
+			normalmapPanel.setTextureID(thumbnailFbs.getColourTexture(), false);
+			normalmapPanel.draw(layerManager.getColourTexture(i));
+		}
+	}
+
+	std::vector<unsigned char> normalPixels(static_cast<size_t>(normalRes.x) * normalRes.y * 3);
+	thumbnailFbs.bindColourTexture();
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, normalPixels.data());
+	GL::bindTexture(TextureType::TEXTURE_2D, 0);
+	FrameBufferSystem::bindDefaultFrameBuffer();
+	thumbnailFbs.destroy();
+	GL::setViewport(glm::ivec2(0), windowSys.getWindowRes());
+	return NoraFileHandler::createThumbnails(heightMapTexData, normalPixels.data(), normalRes.x, normalRes.y);
+}
 void DisplayNoraFileSave()
 {
 	currentLoadingOption = LoadingOption::TEXTURE;
@@ -1639,7 +1946,12 @@ void DisplayNoraFileSave()
 		{
 			if (currentLoadingOption == LoadingOption::TEXTURE)
 			{
-				NoraFileHandler::writeToDisk(str, heightMapTexData, layerManager);
+				//The opened .nora file may be the one being replaced, so layers must not reference it while writing
+				layerManager.detachFromNoraFile();
+				if (!NoraFileHandler::writeToDisk(str, heightMapTexData, layerManager, CreateProjectThumbnails()))
+					modalWindow.setModalDialog("ERROR", "Could not save the project to " + str);
+				else
+					autosaveJournal.reset(str, heightMapTexData);
 			}
 		});
 }
@@ -1649,21 +1961,7 @@ void DisplayNoraFileOpen()
 	fileOpenDialog->displayDialog(FileType::NORA, [&](std::string str)
 		{
 			if (currentLoadingOption == LoadingOption::TEXTURE)
-			{
-				NoraFileHeader fileHeader;
-				auto layerInfoVector = NoraFileHandler::readFromDisk(str, fileHeader);
-
-				layerManager.initWithLayerInfoData(layerInfoVector);
-
-				heightMapTexData.setTextureData(layerInfoVector.at(0).second, fileHeader.width, fileHeader.height, 4);
-
-				heightMapTexData.setTexId(TextureManager::createTextureFromData(heightMapTexData));
-				heightMapTexData.setTextureDirty();
-				layerManager.updateLayerTexture(0, heightMapTexData.getTexId());
-
-				undoRedoSystem.updateAllocation(heightMapTexData.getRes(), heightMapTexData.getComponentCount(), preferencesInfo.maxUndoCount);
-				undoRedoSystem.record(heightMapTexData.getTextureData());
-			}
+				LoadNoraFile(str);
 		});
 }
 void DisplayHeightmapOpen()
@@ -1672,18 +1970,101 @@ void DisplayHeightmapOpen()
 	fileOpenDialog->displayDialog(FileType::IMAGE, [&](std::string str)
 		{
 			if (currentLoadingOption == LoadingOption::TEXTURE)
-			{
-				TextureManager::getTextureDataFromFile(str, heightMapTexData);
-				heightImageLoadLocation = str;
-				heightMapTexData.setTexId(TextureManager::createTextureFromData(heightMapTexData));
-				heightMapTexData.setTextureDirty();
-				layerManager.updateLayerTexture(0, heightMapTexData.getTexId());
-
-				undoRedoSystem.updateAllocation(heightMapTexData.getRes(), heightMapTexData.getComponentCount(), preferencesInfo.maxUndoCount);
-				undoRedoSystem.record(heightMapTexData.getTextureData());
-			}
+				LoadHeightmap(str);
 		});
 }
+bool LoadNoraFile(const std::string& path)
+{
+	std::shared_ptr<NoraFileReader> noraFileReader = std::make_shared<NoraFileReader>();
+	if (!noraFileReader->open(path))
+	{
+		modalWindow.setModalDialog("ERROR", "Could not open " + path);
+		return false;
+	}
+	const NoraFileHeader& fileHeader = noraFileReader->getFileHeader();
+	const int componentCount = 4;
+	const size_t heightMapSize = static_cast<size_t>(fileHeader.width) * fileHeader.height * componentCount;
+	unsigned char* heightMapData = static_cast<unsigned char*>(std::malloc(heightMapSize));
+	if (heightMapData == nullptr || fileHeader.numberOfLayers == 0 || !noraFileReader->readLayerPixels(0, heightMapData, heightMapSize))
+	{
+		std::free(heightMapData);
+		modalWindow.setModalDialog("ERROR", "Could not read the heightmap from " + path);
+		return false;
+	}
+	heightMapTexData.setTextureDataNonAlloc(heightMapData, fileHeader.width, fileHeader.height, componentCount);
+	heightMapTexData.setTexId(TextureManager::createTextureFromData(heightMapTexData));
+	heightMapTexData.setTextureDirty();
+
+	//Remaining layers stay in the mapped file until they are drawn
+	layerManager.initWithNoraFile(noraFileReader);
+	layerManager.updateLayerTexture(0, heightMapTexData.getTexId());
+
+	undoRedoSystem.updateAllocation(heightMapTexData.getRes(), heightMapTexData.getComponentCount(), preferencesInfo.maxUndoCount);
+	undoRedoSystem.record(heightMapTexData.getTextureData());
+	autosaveJournal.reset(path, heightMapTexData);
+	return true;
+}
+bool LoadHeightmap(const std::string& path)
+{
+	//Only the image header is read here, so unsupported files are rejected before anything is decoded
+	int width, height, componentCount;
+	if (!std::filesystem::exists(path) || !TextureManager::getImageInfo(path, width, height, componentCount))
+	{
+		modalWindow.setModalDialog("ERROR", "Could not open " + path);
+		return false;
+	}
+	TextureManager::getTextureDataFromFile(path, heightMapTexData);
+	heightImageLoadLocation = path;
+	heightMapTexData.setTexId(TextureManager::createTextureFromData(heightMapTexData));
+	heightMapTexData.setTextureDirty();
+	layerManager.updateLayerTexture(0, heightMapTexData.getTexId());
+
+	undoRedoSystem.updateAllocation(heightMapTexData.getRes(), heightMapTexData.getComponentCount(), preferencesInfo.maxUndoCount);
+	undoRedoSystem.record(heightMapTexData.getTextureData());
+	autosaveJournal.reset(path, heightMapTexData);
+	return true;
+}
+void RecoverAutosavedChanges()
+{
+	std::string basePath;
+	glm::ivec2 resolution;
+	int componentCount;
+	if (!AutosaveJournal::readJournalInfo(AUTOSAVE_JOURNAL_PATH, basePath, resolution, componentCount))
+	{
+		autosaveJournal.reset(heightImageLoadLocation, heightMapTexData);
+		return;
+	}
+	//Move the journal aside, loading the base file starts a new one. A journal kept by an earlier failed recovery is not replaced
+	std::error_code errorCode;
+	std::string recoveryPath = AUTOSAVE_JOURNAL_PATH + ".recover";
+	for (int i = 1; std::filesystem::exists(recoveryPath, errorCode); i++)
+		recoveryPath = AUTOSAVE_JOURNAL_PATH + ".recover" + std::to_string(i);
+	std::filesystem::rename(AUTOSAVE_JOURNAL_PATH, recoveryPath, errorCode);
+	if (errorCode)
+	{
+		autosaveJournal.reset(heightImageLoadLocation, heightMapTexData);
+		return;
+	}
+	const bool isBaseLoaded = (fileOpenDialog->getFileExtension(basePath) == ".nora") ? LoadNoraFile(basePath) : LoadHeightmap(basePath);
+	if (!isBaseLoaded)
+	{
+		//The journal is the only copy of the changes, so it is kept for the user to recover once the base file is back
+		const std::string keptPath = std::filesystem::absolute(recoveryPath, errorCode).string();
+		autosaveJournal.reset(heightImageLoadLocation, heightMapTexData);
+		modalWindow.setModalDialog("ERROR", "Unsaved changes could not be recovered, " + basePath + " could not be opened."
+			"\nThe changes are kept in " + (errorCode ? recoveryPath : keptPath));
+		return;
+	}
+	const int recoveredTileCount = AutosaveJournal::replay(recoveryPath, heightMapTexData);
+	std::filesystem::remove(recoveryPath, errorCode);
+	if (recoveredTileCount == 0)
+		return;
+	heightMapTexData.setTextureDirty();
+	undoRedoSystem.record(heightMapTexData.getTextureData());
+	//The recovered edits are not saved anywhere but the old journal, so write them to the new one
+	autosaveJournal.markAllDirty();
+	modalWindow.setModalDialog("INFO", "Recovered unsaved changes to " + basePath);
+}
 inline void HandleLeftMouseButtonInput_NormalMapInteraction(int state, DrawingPanel& frameDrawingPanel, bool isBlurOn)
 {
 	const glm::vec2 INVALID = glm::vec2(-100000000, -10000000);
@@ -1828,6 +2209,7 @@ inline void SetPixelValues(TextureData& inputTexData, int startX, int endX, int
 	const int clampedEndX = glm::min(endX, inputTexData.getRes().x);
 	const int clampedStartY = glm::clamp(startY, 0, inputTexData.getRes().y);
 	const int clampedEndY = glm::clamp(endY, 0, inputTexData.getRes().y);
+	autosaveJournal.markDirtyRegion(clampedStartX, clampedEndX, clampedStartY, clampedEndY);
 
 	for (int j = clampedStartY; j < clampedEndY; j++)
 	{
@@ -1860,6 +2242,7 @@ inline void SetPixelValuesWithBrushTexture(TextureData& inputTexData, const Text
 	const int clampedEndX = glm::min(endX, inputTexData.getRes().x);
 	const int clampedStartY = glm::clamp(startY, 0, inputTexData.getRes().y);
 	const int clampedEndY = glm::clamp(endY, 0, inputTexData.getRes().y);
+	autosaveJournal.markDirtyRegion(clampedStartX, clampedEndX, clampedStartY, clampedEndY);
 
 	for (int j = clampedStartY; j < clampedEndY; j++)
 	{
@@ -1893,6 +2276,7 @@ inline void SetBluredPixelValues(TextureData& inputTexData, int startX, int endX
 	const int clampedEndX = glm::min(endX, inputTexData.getRes().x);
 	const int clampedStartY = glm::clamp(startY, 0, inputTexData.getRes().y);
 	const int clampedEndY = glm::clamp(endY, 0, inputTexData.getRes().y);
+	autosaveJournal.markDirtyRegion(clampedStartX, clampedEndX, clampedStartY, clampedEndY);
 
 	const int _width = endX - startX;
 	const int _height = endY - startY;
@@ -1977,5 +2361,8 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) noexcep
 	if (!canPerformPreviewWindowMouseOperations)
 		normalViewStateUtility.zoomLevel += normalViewStateUtility.zoomLevel * 0.1f * static_cast<float>(yoffset);
 	else if (canPerformPreviewWindowMouseOperations)
+	{
 		previewStateUtility.modelPreviewZoomLevel += 0.5f * yoffset;
+		previewResolution.onInteraction(glfwGetTime());
+	}
 }
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+/*Read only view of a file mapped into the address space
+Pages are only brought in by the OS when they are touched, so large files can be opened without reading them
+*/
+class MemoryMappedFile
+{
+private:
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+public:
+	MemoryMappedFile();
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+	//Map the whole file at path, returns false if the file could not be opened
+	bool open(const std::string& path);
+	//Unmap the file and release the handles
+	void close();
+	bool isOpen()const noexcept;
+	const unsigned char* getData()const noexcept;
+	size_t getSize()const noexcept;
+	~MemoryMappedFile();
+};
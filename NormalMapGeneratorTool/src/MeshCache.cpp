@@ -0,0 +1,181 @@
+#include "MeshCache.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+#include "HashUtility.h"
+
+std::string MeshCache::cacheDirectory;
+
+static_assert(sizeof(MeshCacheHeader) % sizeof(uint64_t) == 0, "The vertex data following MeshCacheHeader has to stay aligned");
+
+void MeshCache::setCacheDirectory(const std::string& directory)
+{
+	cacheDirectory = directory;
+	if (!cacheDirectory.empty())
+	{
+		std::error_code errorCode;
+		std::filesystem::create_directories(cacheDirectory, errorCode);
+	}
+}
+
+bool MeshCache::load(const std::string& sourcePath, VertexFormat vertexFormat, TangentSpace tangentSpace, ModelObject& model)
+{
+	MemoryMappedFile mappedFile;
+	MeshCacheHeader header;
+	bool shouldRefreshStamp;
+	if (!openEntry(sourcePath, vertexFormat, tangentSpace, mappedFile, header, shouldRefreshStamp))
+		return false;
+	const unsigned char* const blobs = mappedFile.getData() + sizeof(MeshCacheHeader);
+	const size_t vertexBytes = static_cast<size_t>(header.vertexCount) * VertexPacking::getStride(vertexFormat);
+	const size_t indexBytes = static_cast<size_t>(header.indexCount) * sizeof(uint32_t);
+	model.updateMeshData(blobs, header.vertexCount, vertexFormat, reinterpret_cast<const unsigned int*>(blobs + vertexBytes), static_cast<int>(header.indexCount));
+	model.setParts(reinterpret_cast<const MeshPart*>(blobs + vertexBytes + indexBytes), header.partCount, header.lodCount);
+	mappedFile.close();
+	if (shouldRefreshStamp)
+		refreshStamp(sourcePath, header);
+	return true;
+}
+
+bool MeshCache::read(const std::string& sourcePath, VertexFormat vertexFormat, TangentSpace tangentSpace, PackedMesh& packedMesh)
+{
+	MemoryMappedFile mappedFile;
+	MeshCacheHeader header;
+	bool shouldRefreshStamp;
+	if (!openEntry(sourcePath, vertexFormat, tangentSpace, mappedFile, header, shouldRefreshStamp))
+		return false;
+	const unsigned char* const blobs = mappedFile.getData() + sizeof(MeshCacheHeader);
+	const size_t vertexBytes = static_cast<size_t>(header.vertexCount) * VertexPacking::getStride(vertexFormat);
+	const uint32_t* const indices = reinterpret_cast<const uint32_t*>(blobs + vertexBytes);
+	packedMesh.format = vertexFormat;
+	packedMesh.tangentSpace = tangentSpace;
+	packedMesh.vertexCount = header.vertexCount;
+	packedMesh.lodCount = header.lodCount;
+	packedMesh.vertices.assign(blobs, blobs + vertexBytes);
+	packedMesh.indices.assign(indices, indices + header.indexCount);
+	const MeshPart* const parts = reinterpret_cast<const MeshPart*>(indices + header.indexCount);
+	packedMesh.parts.assign(parts, parts + header.partCount);
+	mappedFile.close();
+	if (shouldRefreshStamp)
+		refreshStamp(sourcePath, header);
+	return true;
+}
+
+void MeshCache::save(const std::string& sourcePath, const PackedMesh& packedMesh)
+{
+	const std::vector<unsigned char>& packedVertices = packedMesh.vertices;
+	const std::vector<uint32_t>& indices = packedMesh.indices;
+	MeshCacheHeader header;
+	if (cacheDirectory.empty() || indices.empty() || !getSourceStamp(sourcePath, header.sourceSize, header.sourceWriteTime) ||
+		!hashSourceFile(sourcePath, header.sourceHash))
+		return;
+	const size_t vertexBytes = packedVertices.size();
+	const size_t indexBytes = indices.size() * sizeof(uint32_t);
+	const size_t partBytes = packedMesh.parts.size() * sizeof(MeshPart);
+	std::memcpy(header.magic, "NMSH", 4);
+	header.version = VERSION;
+	header.vertexCount = packedMesh.vertexCount;
+	header.vertexFormat = packedMesh.format;
+	header.indexCount = static_cast<uint32_t>(indices.size());
+	header.partCount = static_cast<uint32_t>(packedMesh.parts.size());
+	header.tangentSpace = packedMesh.tangentSpace;
+	header.lodCount = packedMesh.lodCount;
+	header.reserved = 0;
+	header.checksum = HashUtility::crc32(packedVertices.data(), vertexBytes);
+	header.checksum = HashUtility::crc32(indices.data(), indexBytes, header.checksum);
+	header.checksum = HashUtility::crc32(packedMesh.parts.data(), partBytes, header.checksum);
+
+	//Written next to the entry and swapped in so a cache that is being read is never seen half written
+	const std::string cachePath = getCachePath(sourcePath);
+	const std::string tempPath = cachePath + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+		file.write(reinterpret_cast<const char*>(packedVertices.data()), vertexBytes);
+		file.write(reinterpret_cast<const char*>(indices.data()), indexBytes);
+		file.write(reinterpret_cast<const char*>(packedMesh.parts.data()), partBytes);
+		if (!file)
+		{
+			std::cout << "\nCould not write mesh cache : " << cachePath;
+			return;
+		}
+	}
+	std::error_code errorCode;
+	std::filesystem::rename(tempPath, cachePath, errorCode);
+	if (errorCode)
+		std::filesystem::remove(tempPath, errorCode);
+}
+
+bool MeshCache::openEntry(const std::string& sourcePath, VertexFormat vertexFormat, TangentSpace tangentSpace, MemoryMappedFile& mappedFile, MeshCacheHeader& header,
+	bool& shouldRefreshStamp)
+{
+	uint64_t sourceSize;
+	int64_t sourceWriteTime;
+	if (cacheDirectory.empty() || !getSourceStamp(sourcePath, sourceSize, sourceWriteTime))
+		return false;
+	const std::string cachePath = getCachePath(sourcePath);
+	if (!mappedFile.open(cachePath) || mappedFile.getSize() < sizeof(MeshCacheHeader))
+		return false;
+
+	std::memcpy(&header, mappedFile.getData(), sizeof(MeshCacheHeader));
+	const size_t vertexBytes = static_cast<size_t>(header.vertexCount) * VertexPacking::getStride(vertexFormat);
+	const size_t indexBytes = static_cast<size_t>(header.indexCount) * sizeof(uint32_t);
+	const size_t partBytes = static_cast<size_t>(header.partCount) * sizeof(MeshPart);
+	if (std::memcmp(header.magic, "NMSH", 4) != 0 || header.version != VERSION || header.vertexFormat != vertexFormat || header.tangentSpace != tangentSpace ||
+		header.indexCount == 0 || header.lodCount == 0 || header.partCount % header.lodCount != 0 ||
+		mappedFile.getSize() != sizeof(MeshCacheHeader) + vertexBytes + indexBytes + partBytes || header.sourceSize != sourceSize)
+		return false;
+	shouldRefreshStamp = false;
+	if (header.sourceWriteTime != sourceWriteTime)
+	{
+		//Copied or touched without being changed, the entry stays valid once the contents are confirmed
+		uint64_t sourceHash;
+		if (!hashSourceFile(sourcePath, sourceHash) || sourceHash != header.sourceHash)
+			return false;
+		header.sourceWriteTime = sourceWriteTime;
+		shouldRefreshStamp = true;
+	}
+
+	if (HashUtility::crc32(mappedFile.getData() + sizeof(MeshCacheHeader), vertexBytes + indexBytes + partBytes) != header.checksum)
+	{
+		std::cout << "\nMesh cache entry is corrupted : " << cachePath;
+		return false;
+	}
+	return true;
+}
+
+void MeshCache::refreshStamp(const std::string& sourcePath, const MeshCacheHeader& header)
+{
+	std::fstream file(getCachePath(sourcePath), std::ios::binary | std::ios::in | std::ios::out);
+	if (file)
+		file.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+}
+
+std::string MeshCache::getCachePath(const std::string& sourcePath)
+{
+	std::error_code errorCode;
+	std::filesystem::path absolutePath = std::filesystem::absolute(sourcePath, errorCode);
+	const std::string normalizedPath = (errorCode) ? sourcePath : absolutePath.lexically_normal().string();
+	return cacheDirectory + HashUtility::toHexString(HashUtility::fnv1a64(normalizedPath)) + ".nmesh";
+}
+
+bool MeshCache::getSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& writeTime)
+{
+	std::error_code errorCode;
+	size = static_cast<uint64_t>(std::filesystem::file_size(sourcePath, errorCode));
+	if (errorCode)
+		return false;
+	writeTime = static_cast<int64_t>(std::filesystem::last_write_time(sourcePath, errorCode).time_since_epoch().count());
+	return !errorCode;
+}
+
+bool MeshCache::hashSourceFile(const std::string& sourcePath, uint64_t& hash)
+{
+	MemoryMappedFile sourceFile;
+	if (!sourceFile.open(sourcePath))
+		return false;
+	hash = HashUtility::fnv1a64(sourceFile.getData(), sourceFile.getSize());
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <vector>
+#include "VertexPacking.h"
+#include "ModelObject.h"
+#include "MemoryMappedFile.h"
+/*
+Imported meshes are cached on disk in the layout they are uploaded in, so picking a model again skips Assimp
+Cache file : .nmesh
+[HEADER] (MeshCacheHeader)
+[VERTICES] (char...) : vertexCount vertices in vertexFormat, see VertexPacking
+[INDICES] (uint32_t...) : indexCount, every LOD with the full detail level first
+[PARTS] (MeshPart...) : partCount, partCount / lodCount per LOD
+The file name is a hash of the source path. An entry is used while the size and write time of the source match the
+header, when only the write time differs the source contents are hashed and compared before the entry is trusted
+*/
+struct MeshCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t sourceSize;
+	int64_t sourceWriteTime;
+	uint64_t sourceHash;
+	uint32_t vertexCount;
+	VertexFormat vertexFormat;
+	uint32_t indexCount;
+	uint32_t checksum;
+	uint32_t partCount;
+	TangentSpace tangentSpace;
+	uint32_t lodCount;
+	uint32_t reserved;
+};
+
+class MeshCache
+{
+public:
+	static const uint32_t VERSION = 5;
+	MeshCache() = delete;
+	//Set where meshes are cached, caching is off while this is empty
+	static void setCacheDirectory(const std::string& directory);
+	//Upload the cached mesh of sourcePath straight from the mapped cache file
+	//Returns false if there is no valid entry or the entry was stored in another vertex format or tangent space
+	static bool load(const std::string& sourcePath, VertexFormat vertexFormat, TangentSpace tangentSpace, ModelObject& model);
+	//Copy the cached mesh of sourcePath into packedMesh without touching GL, safe to call from a worker thread
+	static bool read(const std::string& sourcePath, VertexFormat vertexFormat, TangentSpace tangentSpace, PackedMesh& packedMesh);
+	//Write the mesh imported from sourcePath to the cache
+	static void save(const std::string& sourcePath, const PackedMesh& packedMesh);
+private:
+	static std::string cacheDirectory;
+	//Map and validate the entry of sourcePath, header gets the refreshed stamp if only the write time was outdated
+	static bool openEntry(const std::string& sourcePath, VertexFormat vertexFormat, TangentSpace tangentSpace, MemoryMappedFile& mappedFile, MeshCacheHeader& header,
+		bool& shouldRefreshStamp);
+	static void refreshStamp(const std::string& sourcePath, const MeshCacheHeader& header);
+	static std::string getCachePath(const std::string& sourcePath);
+	static bool getSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& writeTime);
+	static bool hashSourceFile(const std::string& sourcePath, uint64_t& hash);
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+//Index range of one mesh of an imported file with its bounds in model space
+//Parts are sorted by material so parts sharing one are next to each other in the index buffer
+struct MeshPart
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t materialIndex;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+//Imported mesh with float vertices : position, normal, uv, tangent and bitangent, packed by VertexPacking for upload
+struct MeshData
+{
+	static const unsigned int FLOATS_PER_VERTEX = 14;
+	std::vector<float> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<MeshPart> parts;
+	unsigned int getVertexCount()const noexcept { return static_cast<unsigned int>(vertices.size() / FLOATS_PER_VERTEX); }
+};
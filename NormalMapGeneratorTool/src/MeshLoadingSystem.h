@@ -4,88 +4,311 @@
 #include <string>
 #include <fstream>
 #include <math.h>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <cctype>
+#include <filesystem>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/ProgressHandler.hpp>
 #include "ModelObject.h"
+#include "MeshData.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include "TangentGenerator.h"
+#include "MeshSimplifier.h"
+#include "VertexPacking.h"
 
 namespace MeshLoadingSystem
 {
+	//Receives the fraction of a mesh load that is done or a negative value when there is no new estimate, returning false cancels the load
+	typedef std::function<bool(float)> ImportProgressCallback;
+
+	//Forwards Assimp's progress updates, which come without an estimate, so they only serve as cancellation points
+	class ImportProgressHandler : public Assimp::ProgressHandler
+	{
+	private:
+		ImportProgressCallback progress;
+	public:
+		ImportProgressHandler(const ImportProgressCallback& progress) : progress(progress) {}
+		bool Update(float /*percentage*/ = -1.f) override
+		{
+			return progress(-1.0f);
+		}
+	};
+
 	class MeshLoader
 	{
+	private:
+		VertexFormat vertexFormat = VertexFormat::PACKED_QUANTIZED_POSITION;
+		TangentSpace tangentSpace = TangentSpace::IMPORTED;
+		//Fraction of a load that is done once Assimp and the optimizer have finished
+		static constexpr float IMPORT_PROGRESS = 0.6f;
+		static constexpr float OPTIMIZE_PROGRESS = 0.9f;
 	public:
 		MeshLoader() {}
 		~MeshLoader() {}
 
+		//Layout models are uploaded in, positions are only quantized with PACKED_QUANTIZED_POSITION
+		void setVertexFormat(VertexFormat vertexFormat) { this->vertexFormat = vertexFormat; }
+		//Tangent basis of models loaded from now on
+		void setTangentSpace(TangentSpace tangentSpace) { this->tangentSpace = tangentSpace; }
+		TangentSpace getTangentSpace()const noexcept { return tangentSpace; }
+
+		//Create a model from a mesh file, the cached copy is used when the file has been imported before
 		ModelObject* createModelFromFile(const std::string& Path)
 		{
+			ModelObject* modelObj = new ModelObject();
+			if (MeshCache::load(Path, vertexFormat, tangentSpace, *modelObj))
+				return modelObj;
+
+			PackedMesh packedMesh;
+			if (!importPackedMesh(Path, packedMesh))
+			{
+				delete modelObj;
+				return nullptr;
+			}
+			modelObj->updateMeshData(packedMesh.vertices.data(), packedMesh.vertexCount, packedMesh.format,
+				packedMesh.indices.data(), static_cast<int>(packedMesh.indices.size()));
+			modelObj->setParts(packedMesh.parts.data(), packedMesh.parts.size(), packedMesh.lodCount);
+			return modelObj;
+		}
+		//Same as createModelFromFile without the upload, so it can run on a worker thread
+		//progress is called with the fraction done and the load is abandoned when it returns false
+		bool loadPackedMesh(const std::string& Path, PackedMesh& packedMesh, const ImportProgressCallback& progress = nullptr)const
+		{
+			if (MeshCache::read(Path, vertexFormat, tangentSpace, packedMesh))
+				return true;
+			return importPackedMesh(Path, packedMesh, progress);
+		}
+		//Import, optimize and pack a mesh file, then store it in the mesh cache
+		//Fresh imports are optimized for the vertex cache before they are packed
+		bool importPackedMesh(const std::string& Path, PackedMesh& packedMesh, const ImportProgressCallback& progress = nullptr)const
+		{
+			MeshData meshData;
+			if (!importMesh(Path, meshData, progress))
+				return false;
+			if (tangentSpace == TangentSpace::MIKKTSPACE)
+				TangentGenerator::generateMikkTSpace(meshData);
+			if (progress && !progress(IMPORT_PROGRESS))
+				return false;
+			const MeshOptimizationStats stats = MeshOptimizer::optimize(meshData);
+			std::cout << "\nOptimized mesh " << Path << " : vertices " << stats.vertexCountBefore << " -> " << stats.vertexCountAfter
+				<< ", ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter;
+			if (progress && !progress(OPTIMIZE_PROGRESS))
+				return false;
+			packedMesh.format = vertexFormat;
+			packedMesh.tangentSpace = tangentSpace;
+			packedMesh.vertexCount = meshData.getVertexCount();
+			packedMesh.vertices = VertexPacking::pack(meshData, vertexFormat);
+			packedMesh.indices = std::move(meshData.indices);
+			packedMesh.parts = std::move(meshData.parts);
+			MeshCache::save(Path, packedMesh);
+			return true;
+		}
+		//Add LODs to a heavy mesh loaded with loadPackedMesh and cache them with it
+		//Returns true if LODs were added, the mesh is left as it was when progress returns false
+		bool buildLods(const std::string& Path, PackedMesh& packedMesh, const ImportProgressCallback& progress = nullptr)const
+		{
+			if (!MeshSimplifier::needsLods(packedMesh))
+				return false;
+			if (!MeshSimplifier::buildLods(VertexPacking::unpackPositions(packedMesh), packedMesh, progress) || packedMesh.lodCount == 1)
+				return false;
+			std::cout << "\nBuilt LODs of " << Path << " : triangles";
+			for (unsigned int lod = 0; lod < packedMesh.lodCount; lod++)
+			{
+				const size_t partsPerLod = packedMesh.parts.size() / packedMesh.lodCount;
+				size_t triangleCount = 0;
+				for (size_t i = lod * partsPerLod; i < (lod + 1) * partsPerLod; i++)
+					triangleCount += packedMesh.parts[i].indexCount / 3;
+				std::cout << " " << triangleCount;
+			}
+			MeshCache::save(Path, packedMesh);
+			return true;
+		}
+		//Import every mesh in the node hierarchy of a file through Assimp as float vertices, one part per mesh with the node transforms baked in
+		bool importMesh(const std::string& Path, MeshData& meshData, const ImportProgressCallback& progress = nullptr)const
+		{
+			if (isLargeObjFile(Path))
+			{
+				ImportProgressCallback parseProgress;
+				if (progress)
+					parseProgress = [&progress](float fraction) { return progress((fraction < 0.0f) ? fraction : fraction * IMPORT_PROGRESS); };
+				if (!ObjParser::parse(Path, meshData, parseProgress))
+					return false;
+				fitToPreview(meshData);
+				return true;
+			}
 			Assimp::Importer importer;
+			//The importer owns and deletes the handler
+			if (progress)
+				importer.SetProgressHandler(new ImportProgressHandler(progress));
 			const aiScene* scene = importer.ReadFile(Path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+			//Cancelled imports are not errors
+			if (!scene && progress && !progress(-1.0f))
+				return false;
 			// check for errors
-			if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+			if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode || scene->mNumMeshes == 0)
+			{
 				std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+				return false;
+			}
+
+			std::vector<MeshInstance> instances;
+			collectMeshInstances(scene->mRootNode, aiMatrix4x4(), instances);
+			//Parts sharing a material end up next to each other so they can be drawn together
+			std::stable_sort(instances.begin(), instances.end(), [scene](const MeshInstance& first, const MeshInstance& second)
+			{
+				return scene->mMeshes[first.meshIndex]->mMaterialIndex < scene->mMeshes[second.meshIndex]->mMaterialIndex;
+			});
+			for (const MeshInstance& instance : instances)
+			{
+				const aiMesh* mesh = scene->mMeshes[instance.meshIndex];
+				if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE))
+					continue;
+				if (!mesh->HasNormals() || !mesh->HasTextureCoords(0) || !mesh->HasTangentsAndBitangents())
+				{
+					std::cout << "\nSkipped mesh without normals and texture coordinates : " << mesh->mName.C_Str() << " in " << Path;
+					continue;
+				}
+				appendMeshInstance(*mesh, instance.transform, meshData);
+			}
+			if (meshData.indices.empty())
+			{
+				std::cout << "\nMesh needs normals and texture coordinates : " << Path;
+				return false;
+			}
+			fitToPreview(meshData);
+			return true;
+		}
+	private:
+		//A mesh referenced by a node, transform is the node's transform relative to the scene root
+		struct MeshInstance
+		{
+			unsigned int meshIndex;
+			aiMatrix4x4 transform;
+		};
 
-			aiMesh* mesh = scene->mMeshes[0];
-			float dist = maxVertexDistance(mesh);
-			float scaleMultiplier = (dist < 3.0f) ? 1.0f : 3.0f / dist;
+		void collectMeshInstances(const aiNode* node, const aiMatrix4x4& parentTransform, std::vector<MeshInstance>& instances)const
+		{
+			const aiMatrix4x4 transform = parentTransform * node->mTransformation;
+			for (unsigned int i = 0; i < node->mNumMeshes; i++)
+				instances.push_back({ node->mMeshes[i], transform });
+			for (unsigned int i = 0; i < node->mNumChildren; i++)
+				collectMeshInstances(node->mChildren[i], transform, instances);
+		}
 
-			unsigned int numVertices = mesh->mNumVertices;
-			float *vertexData = new float[numVertices * 14];
+		//Bake transform into the mesh's triangles and add them to meshData as a new part
+		void appendMeshInstance(const aiMesh& mesh, const aiMatrix4x4& transform, MeshData& meshData)const
+		{
+			const aiMatrix3x3 directionTransform(transform);
+			const aiMatrix3x3 normalTransform = aiMatrix3x3(directionTransform).Inverse().Transpose();
+			//Mirroring transforms turn the triangles inside out, the winding is flipped back
+			const bool isMirrored = directionTransform.Determinant() < 0.0f;
+			const uint32_t firstVertex = meshData.getVertexCount();
 
-			int count = 0;
-			for (int i = 0; i < numVertices; i++)
+			meshData.vertices.resize(meshData.vertices.size() + static_cast<size_t>(mesh.mNumVertices) * MeshData::FLOATS_PER_VERTEX);
+			float* vertexData = &meshData.vertices[static_cast<size_t>(firstVertex) * MeshData::FLOATS_PER_VERTEX];
+			for (unsigned int i = 0; i < mesh.mNumVertices; i++)
 			{
+				const aiVector3D position = transform * mesh.mVertices[i];
+				const aiVector3D normal = transformDirection(normalTransform, mesh.mNormals[i]);
+				const aiVector3D tangent = transformDirection(directionTransform, mesh.mTangents[i]);
+				const aiVector3D bitangent = transformDirection(directionTransform, mesh.mBitangents[i]);
 
-				vertexData[count] = mesh->mVertices[i].x * scaleMultiplier;
-				vertexData[count + 1] = mesh->mVertices[i].y * scaleMultiplier;
-				vertexData[count + 2] = mesh->mVertices[i].z * scaleMultiplier;
+				vertexData[0] = position.x;
+				vertexData[1] = position.y;
+				vertexData[2] = position.z;
 
-				vertexData[count + 3] = mesh->mNormals[i].x;
-				vertexData[count + 4] = mesh->mNormals[i].y;
-				vertexData[count + 5] = mesh->mNormals[i].z;
+				vertexData[3] = normal.x;
+				vertexData[4] = normal.y;
+				vertexData[5] = normal.z;
 
-				vertexData[count + 6] = mesh->mTextureCoords[0][i].x;
-				vertexData[count + 7] = mesh->mTextureCoords[0][i].y;
+				vertexData[6] = mesh.mTextureCoords[0][i].x;
+				vertexData[7] = mesh.mTextureCoords[0][i].y;
 
-				vertexData[count + 8] = mesh->mTangents[i].x;
-				vertexData[count + 9] = mesh->mTangents[i].y;
-				vertexData[count + 10] = mesh->mTangents[i].z;
+				vertexData[8] = tangent.x;
+				vertexData[9] = tangent.y;
+				vertexData[10] = tangent.z;
 
-				vertexData[count + 11] = mesh->mBitangents[i].x;
-				vertexData[count + 12] = mesh->mBitangents[i].y;
-				vertexData[count + 13] = mesh->mBitangents[i].z;
+				vertexData[11] = bitangent.x;
+				vertexData[12] = bitangent.y;
+				vertexData[13] = bitangent.z;
 
-				count += 14;
+				vertexData += MeshData::FLOATS_PER_VERTEX;
 			}
-			std::vector<unsigned int> indices;
-			for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+
+			MeshPart part = {};
+			part.firstIndex = static_cast<uint32_t>(meshData.indices.size());
+			part.materialIndex = mesh.mMaterialIndex;
+			meshData.indices.reserve(meshData.indices.size() + static_cast<size_t>(mesh.mNumFaces) * 3);
+			for (unsigned int i = 0; i < mesh.mNumFaces; i++)
 			{
-				aiFace face = mesh->mFaces[i];
-				for (unsigned int j = 0; j < face.mNumIndices; j++)
-					indices.push_back(face.mIndices[j]);
+				//Points and lines of meshes with mixed primitives are left out
+				const aiFace& face = mesh.mFaces[i];
+				if (face.mNumIndices != 3)
+					continue;
+				meshData.indices.push_back(firstVertex + face.mIndices[0]);
+				meshData.indices.push_back(firstVertex + face.mIndices[isMirrored ? 2 : 1]);
+				meshData.indices.push_back(firstVertex + face.mIndices[isMirrored ? 1 : 2]);
 			}
-			ModelObject* modelObj = new ModelObject();
-			modelObj->updateMeshData(vertexData, numVertices * 14 * sizeof(float), &indices[0], indices.size());
-			delete[] vertexData;
-			return modelObj;
+			part.indexCount = static_cast<uint32_t>(meshData.indices.size()) - part.firstIndex;
+			if (part.indexCount != 0)
+				meshData.parts.push_back(part);
 		}
-	private:
-		//The maximum distance a vertex is from origin, Useful for Bounding spheres
-		float maxVertexDistance(aiMesh* mesh)const
+
+		//Multi million triangle scans are read with ObjParser, Assimp's OBJ importer runs on a single thread
+		static bool isLargeObjFile(const std::string& Path)
 		{
-			unsigned int numVertices = mesh->mNumVertices;
+			const std::filesystem::path filePath(Path);
+			std::string extension = filePath.extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+			std::error_code errorCode;
+			const uintmax_t fileSize = std::filesystem::file_size(filePath, errorCode);
+			return extension == ".obj" && !errorCode && fileSize >= ObjParser::LARGE_FILE_SIZE;
+		}
 
+		//Degenerate directions are passed through for VertexPacking to repair
+		static aiVector3D transformDirection(const aiMatrix3x3& matrix, const aiVector3D& direction)
+		{
+			const aiVector3D transformed = matrix * direction;
+			const float length = transformed.Length();
+			return (length > 0.0f) ? transformed / length : direction;
+		}
+
+		//Scale the whole model down to fit the preview if it reaches further than 3 units from the origin and compute the part bounds
+		void fitToPreview(MeshData& meshData)const
+		{
 			float maxDist = 0;
-			aiVector3D* vecArray = mesh->mVertices;
-			for (unsigned int i = 0; i < numVertices; i++)
+			for (size_t i = 0; i < meshData.vertices.size(); i += MeshData::FLOATS_PER_VERTEX)
+				maxDist = std::max(maxDist, glm::length(glm::vec3(meshData.vertices[i], meshData.vertices[i + 1], meshData.vertices[i + 2])));
+			const float scaleMultiplier = (maxDist < 3.0f) ? 1.0f : 3.0f / maxDist;
+			for (size_t i = 0; i < meshData.vertices.size(); i += MeshData::FLOATS_PER_VERTEX)
+			{
+				for (int axis = 0; axis < 3; axis++)
+					meshData.vertices[i + axis] *= scaleMultiplier;
+			}
+
+			for (MeshPart& part : meshData.parts)
 			{
-				glm::vec3 vec(vecArray[i].x, vecArray[i].y, vecArray[i].z);
-				float dist = glm::length(vec);
-				if (dist > maxDist)
-					maxDist = dist;
+				glm::vec3 boundsMin(std::numeric_limits<float>::max());
+				glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+				for (uint32_t i = part.firstIndex; i < part.firstIndex + part.indexCount; i++)
+				{
+					const float* position = &meshData.vertices[static_cast<size_t>(meshData.indices[i]) * MeshData::FLOATS_PER_VERTEX];
+					boundsMin = glm::min(boundsMin, glm::vec3(position[0], position[1], position[2]));
+					boundsMax = glm::max(boundsMax, glm::vec3(position[0], position[1], position[2]));
+				}
+				for (int axis = 0; axis < 3; axis++)
+				{
+					part.boundsMin[axis] = boundsMin[axis];
+					part.boundsMax[axis] = boundsMax[axis];
+				}
 			}
-			return maxDist;
 		}
 	};
 }
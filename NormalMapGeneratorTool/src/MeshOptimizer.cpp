@@ -0,0 +1,335 @@
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <unordered_set>
+#include <GLM\glm.hpp>
+#include "HashUtility.h"
+
+namespace
+{
+	//Entries of the LRU cache the Forsyth scores are tuned for
+	const int FORSYTH_CACHE_SIZE = 32;
+
+	float getVertexScore(int cachePosition, unsigned int remainingTriangles) noexcept
+	{
+		if (remainingTriangles == 0)
+			return -1.0f;
+		float score = 0.0f;
+		//The last triangle's vertices get a fixed score so the next triangle does not simply reuse all three
+		if (cachePosition >= 0)
+			score = (cachePosition < 3) ? 0.75f : std::pow(1.0f - static_cast<float>(cachePosition - 3) / (FORSYTH_CACHE_SIZE - 3), 1.5f);
+		//Vertices with few triangles left are finished first so they can leave the cache
+		return score + 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+	}
+
+	glm::vec3 getPosition(const MeshData& mesh, uint32_t index) noexcept
+	{
+		const float* vertex = &mesh.vertices[static_cast<size_t>(index) * MeshData::FLOATS_PER_VERTEX];
+		return glm::vec3(vertex[0], vertex[1], vertex[2]);
+	}
+}
+
+MeshOptimizationStats MeshOptimizer::optimize(MeshData& mesh)
+{
+	MeshOptimizationStats stats;
+	stats.vertexCountBefore = mesh.getVertexCount();
+	stats.acmrBefore = calculateACMR(mesh.indices, mesh.getVertexCount());
+	weldVertices(mesh);
+
+	std::vector<MeshPart> parts = mesh.parts;
+	if (parts.empty())
+		parts.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0, {}, {} });
+	std::vector<glm::vec3> positions(mesh.getVertexCount());
+	for (uint32_t i = 0; i < mesh.getVertexCount(); i++)
+		positions[i] = getPosition(mesh, i);
+	optimizeParts(positions, parts, mesh.indices);
+	optimizeVertexFetch(mesh);
+	stats.vertexCountAfter = mesh.getVertexCount();
+	stats.acmrAfter = calculateACMR(mesh.indices, mesh.getVertexCount());
+	return stats;
+}
+
+void MeshOptimizer::optimizeParts(const std::vector<glm::vec3>& positions, const std::vector<MeshPart>& parts, std::vector<uint32_t>& indices)
+{
+	//Triangles are only reordered within their part so the part ranges stay valid
+	const uint32_t unused = 0xFFFFFFFFu;
+	std::vector<uint32_t> globalToLocal(positions.size(), unused);
+	std::vector<uint32_t> localToGlobal;
+	std::vector<uint32_t> localIndices;
+	std::vector<glm::vec3> localPositions;
+	for (const MeshPart& part : parts)
+	{
+		localToGlobal.clear();
+		localIndices.clear();
+		for (uint32_t i = part.firstIndex; i < part.firstIndex + part.indexCount; i++)
+		{
+			const uint32_t index = indices[i];
+			if (globalToLocal[index] == unused)
+			{
+				globalToLocal[index] = static_cast<uint32_t>(localToGlobal.size());
+				localToGlobal.push_back(index);
+			}
+			localIndices.push_back(globalToLocal[index]);
+		}
+		localPositions.resize(localToGlobal.size());
+		for (size_t i = 0; i < localToGlobal.size(); i++)
+			localPositions[i] = positions[localToGlobal[i]];
+
+		optimizeVertexCache(localIndices, static_cast<unsigned int>(localToGlobal.size()));
+		optimizeOverdraw(localPositions, localIndices);
+		for (size_t i = 0; i < localIndices.size(); i++)
+			indices[part.firstIndex + i] = localToGlobal[localIndices[i]];
+		for (const uint32_t index : localToGlobal)
+			globalToLocal[index] = unused;
+	}
+}
+
+float MeshOptimizer::calculateACMR(const std::vector<uint32_t>& indices, unsigned int vertexCount)
+{
+	if (indices.size() < 3)
+		return 0.0f;
+	//A vertex is in the FIFO while fewer than ACMR_CACHE_SIZE misses happened after it was loaded
+	std::vector<size_t> loadedAtMiss(vertexCount, 0);
+	size_t missCount = 0;
+	for (const uint32_t index : indices)
+	{
+		if (loadedAtMiss[index] == 0 || missCount - loadedAtMiss[index] >= ACMR_CACHE_SIZE)
+		{
+			missCount++;
+			loadedAtMiss[index] = missCount;
+		}
+	}
+	return static_cast<float>(missCount) / static_cast<float>(indices.size() / 3);
+}
+
+void MeshOptimizer::weldVertices(MeshData& mesh)
+{
+	const unsigned int vertexCount = mesh.getVertexCount();
+	const float* const vertices = mesh.vertices.data();
+	const size_t vertexSize = MeshData::FLOATS_PER_VERTEX * sizeof(float);
+	auto hashVertex = [vertices, vertexSize](uint32_t index)
+	{
+		return static_cast<size_t>(HashUtility::fnv1a64(&vertices[static_cast<size_t>(index) * MeshData::FLOATS_PER_VERTEX], vertexSize));
+	};
+	auto areVerticesEqual = [vertices, vertexSize](uint32_t first, uint32_t second)
+	{
+		return std::memcmp(&vertices[static_cast<size_t>(first) * MeshData::FLOATS_PER_VERTEX],
+			&vertices[static_cast<size_t>(second) * MeshData::FLOATS_PER_VERTEX], vertexSize) == 0;
+	};
+	std::unordered_set<uint32_t, decltype(hashVertex), decltype(areVerticesEqual)> uniqueVertices(vertexCount, hashVertex, areVerticesEqual);
+
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<float> weldedVertices;
+	weldedVertices.reserve(mesh.vertices.size());
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const auto insertResult = uniqueVertices.insert(i);
+		if (!insertResult.second)
+		{
+			remap[i] = remap[*insertResult.first];
+			continue;
+		}
+		remap[i] = static_cast<uint32_t>(weldedVertices.size() / MeshData::FLOATS_PER_VERTEX);
+		weldedVertices.insert(weldedVertices.end(), &vertices[static_cast<size_t>(i) * MeshData::FLOATS_PER_VERTEX],
+			&vertices[static_cast<size_t>(i + 1) * MeshData::FLOATS_PER_VERTEX]);
+	}
+	for (uint32_t& index : mesh.indices)
+		index = remap[index];
+	mesh.vertices.swap(weldedVertices);
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, unsigned int vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	//Triangles using each vertex, packed into one array
+	std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+	for (const uint32_t index : indices)
+		remainingTriangles[index]++;
+	std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (unsigned int i = 0; i < vertexCount; i++)
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangles[i];
+	std::vector<uint32_t> adjacentTriangles(indices.size());
+	std::vector<size_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++)
+		adjacentTriangles[adjacencyFill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+		vertexScores[i] = getVertexScore(-1, remainingTriangles[i]);
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t i = 0; i < triangleCount; i++)
+		triangleScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+	std::vector<bool> isTriangleEmitted(triangleCount, false);
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> nextCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+	std::vector<uint32_t> optimizedIndices;
+	optimizedIndices.reserve(indices.size());
+	size_t bestTriangle = std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin();
+	size_t nextUnemittedTriangle = 0;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		if (bestTriangle == triangleCount)
+		{
+			//Nothing in the cache has triangles left, continue with the next triangle in the original order
+			while (isTriangleEmitted[nextUnemittedTriangle])
+				nextUnemittedTriangle++;
+			bestTriangle = nextUnemittedTriangle;
+		}
+		isTriangleEmitted[bestTriangle] = true;
+		const uint32_t* const triangle = &indices[bestTriangle * 3];
+
+		//Move the triangle's vertices to the front of the LRU cache and drop it from their adjacency
+		nextCache.assign(triangle, triangle + 3);
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const uint32_t vertex = triangle[corner];
+			optimizedIndices.push_back(vertex);
+			uint32_t* const adjacencyBegin = &adjacentTriangles[adjacencyOffsets[vertex]];
+			uint32_t* const adjacencyEnd = adjacencyBegin + remainingTriangles[vertex];
+			*std::find(adjacencyBegin, adjacencyEnd, static_cast<uint32_t>(bestTriangle)) = *(adjacencyEnd - 1);
+			remainingTriangles[vertex]--;
+		}
+		for (const uint32_t vertex : cache)
+		{
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+				nextCache.push_back(vertex);
+		}
+		for (size_t i = FORSYTH_CACHE_SIZE; i < nextCache.size(); i++)
+		{
+			cachePositions[nextCache[i]] = -1;
+			vertexScores[nextCache[i]] = getVertexScore(-1, remainingTriangles[nextCache[i]]);
+		}
+		if (nextCache.size() > FORSYTH_CACHE_SIZE)
+			nextCache.resize(FORSYTH_CACHE_SIZE);
+		cache.swap(nextCache);
+
+		//Only triangles touching the cache change score, the best of them is drawn next
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			cachePositions[cache[i]] = static_cast<int>(i);
+			vertexScores[cache[i]] = getVertexScore(static_cast<int>(i), remainingTriangles[cache[i]]);
+		}
+		bestTriangle = triangleCount;
+		float bestScore = -1.0f;
+		for (const uint32_t vertex : cache)
+		{
+			for (size_t i = 0; i < remainingTriangles[vertex]; i++)
+			{
+				const uint32_t adjacentTriangle = adjacentTriangles[adjacencyOffsets[vertex] + i];
+				const uint32_t* const corners = &indices[adjacentTriangle * 3];
+				triangleScores[adjacentTriangle] = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+				if (triangleScores[adjacentTriangle] > bestScore)
+				{
+					bestScore = triangleScores[adjacentTriangle];
+					bestTriangle = adjacentTriangle;
+				}
+			}
+		}
+	}
+	indices.swap(optimizedIndices);
+}
+
+void MeshOptimizer::optimizeOverdraw(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	//A new cluster starts where the cache optimised order jumps to a triangle that shares no vertex with the cache,
+	//reordering whole clusters keeps the cache behaviour inside them
+	std::vector<size_t> clusterStarts;
+	std::vector<size_t> loadedAtMiss(positions.size(), 0);
+	size_t missCount = 0;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		int triangleMisses = 0;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const uint32_t index = indices[triangle * 3 + corner];
+			if (loadedAtMiss[index] == 0 || missCount - loadedAtMiss[index] >= ACMR_CACHE_SIZE)
+			{
+				missCount++;
+				loadedAtMiss[index] = missCount;
+				triangleMisses++;
+			}
+		}
+		if (triangle == 0 || triangleMisses == 3)
+			clusterStarts.push_back(triangle);
+	}
+	clusterStarts.push_back(triangleCount);
+	const size_t clusterCount = clusterStarts.size() - 1;
+	if (clusterCount < 2)
+		return;
+
+	glm::vec3 meshCentre(0.0f);
+	for (const glm::vec3& position : positions)
+		meshCentre += position;
+	meshCentre /= static_cast<float>(positions.size());
+
+	//Clusters whose area weighted normal points away from the centre are likely to occlude the rest
+	std::vector<float> clusterSortKeys(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		glm::vec3 clusterCentre(0.0f);
+		glm::vec3 clusterNormal(0.0f);
+		float clusterArea = 0.0f;
+		for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; triangle++)
+		{
+			const glm::vec3& a = positions[indices[triangle * 3]];
+			const glm::vec3& b = positions[indices[triangle * 3 + 1]];
+			const glm::vec3& c = positions[indices[triangle * 3 + 2]];
+			const glm::vec3 normal = glm::cross(b - a, c - a);
+			const float area = glm::length(normal);
+			clusterCentre += (a + b + c) * (area / 3.0f);
+			clusterNormal += normal;
+			clusterArea += area;
+		}
+		if (clusterArea > 0.0f)
+			clusterCentre /= clusterArea;
+		const float normalLength = glm::length(clusterNormal);
+		clusterSortKeys[cluster] = (normalLength > 0.0f) ? glm::dot(clusterCentre - meshCentre, clusterNormal / normalLength) : 0.0f;
+	}
+
+	std::vector<size_t> clusterOrder(clusterCount);
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](size_t first, size_t second)
+	{
+		return clusterSortKeys[first] > clusterSortKeys[second];
+	});
+	std::vector<uint32_t> sortedIndices;
+	sortedIndices.reserve(indices.size());
+	for (const size_t cluster : clusterOrder)
+		sortedIndices.insert(sortedIndices.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+	indices.swap(sortedIndices);
+}
+
+void MeshOptimizer::optimizeVertexFetch(MeshData& mesh)
+{
+	const unsigned int vertexCount = mesh.getVertexCount();
+	const uint32_t unused = 0xFFFFFFFFu;
+	std::vector<uint32_t> remap(vertexCount, unused);
+	std::vector<float> orderedVertices;
+	orderedVertices.reserve(mesh.vertices.size());
+	for (uint32_t& index : mesh.indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = static_cast<uint32_t>(orderedVertices.size() / MeshData::FLOATS_PER_VERTEX);
+			orderedVertices.insert(orderedVertices.end(), mesh.vertices.begin() + static_cast<size_t>(index) * MeshData::FLOATS_PER_VERTEX,
+				mesh.vertices.begin() + static_cast<size_t>(index + 1) * MeshData::FLOATS_PER_VERTEX);
+		}
+		index = remap[index];
+	}
+	//Vertices no index refers to are dropped
+	mesh.vertices.swap(orderedVertices);
+}
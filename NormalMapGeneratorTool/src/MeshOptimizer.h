@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM\glm.hpp>
+#include "MeshData.h"
+//Cache efficiency of an index buffer before and after MeshOptimizer::optimize
+struct MeshOptimizationStats
+{
+	unsigned int vertexCountBefore = 0;
+	unsigned int vertexCountAfter = 0;
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+};
+
+/*
+Reorders imported meshes for the GPU
+Identical vertices are welded, triangles are ordered for post transform cache hits (Forsyth's linear speed
+vertex cache optimisation) and then grouped into clusters that are drawn outward facing first to cut overdraw.
+Triangles never move between mesh parts. Vertices are finally renumbered in the order they are first used so vertex fetches walk memory forwards
+*/
+class MeshOptimizer
+{
+public:
+	//Entries of the simulated cache ACMR is measured with
+	static const unsigned int ACMR_CACHE_SIZE = 16;
+	MeshOptimizer() = delete;
+	static MeshOptimizationStats optimize(MeshData& mesh);
+	//Average cache miss ratio : vertex shader invocations per triangle with a FIFO cache of ACMR_CACHE_SIZE entries
+	static float calculateACMR(const std::vector<uint32_t>& indices, unsigned int vertexCount);
+	//Merge vertices whose attributes are bit identical and remap the indices
+	static void weldVertices(MeshData& mesh);
+	//Vertex cache and overdraw optimisation of every part's index range, positions are indexed by vertex
+	static void optimizeParts(const std::vector<glm::vec3>& positions, const std::vector<MeshPart>& parts, std::vector<uint32_t>& indices);
+	static void optimizeVertexCache(std::vector<uint32_t>& indices, unsigned int vertexCount);
+	//Keep runs of cache friendly triangles together and sort the runs so surfaces facing away from the centre come first
+	static void optimizeOverdraw(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices);
+	static void optimizeVertexFetch(MeshData& mesh);
+};
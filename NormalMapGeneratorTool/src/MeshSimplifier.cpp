@@ -0,0 +1,420 @@
+#include "MeshSimplifier.h"
+#include <cmath>
+#include <cfloat>
+#include <numeric>
+#include <algorithm>
+#include "MeshOptimizer.h"
+
+namespace
+{
+	//Each LOD aims for this fraction of the triangles of the level before it
+	const size_t LOD_REDUCTION = 4;
+	//No LOD is built with fewer triangles than this
+	const size_t LOD_MIN_LEVEL_TRIANGLE_COUNT = 1000;
+	//Error allowed for the first LOD, doubled for every further level
+	const float LOD_MAX_ERROR = 0.02f;
+	//A level that keeps more of the triangles than this is not worth drawing instead of the one before it
+	const float LOD_MAX_KEPT_FRACTION = 0.75f;
+
+	//Sum of squared distances to the planes of the triangles around a vertex, weighted by triangle area
+	struct Quadric
+	{
+		float a00, a11, a22, a10, a20, a21;
+		float b0, b1, b2;
+		float c;
+		float weight;
+	};
+
+	struct Collapse
+	{
+		uint32_t source;
+		uint32_t target;
+		float error;
+	};
+
+	struct PositionEdge
+	{
+		uint64_t key;
+		bool isForward;
+	};
+
+	void addTriangleQuadric(Quadric& quadric, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) noexcept
+	{
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		const float doubleArea = glm::length(normal);
+		if (doubleArea <= FLT_MIN)
+			return;
+		normal /= doubleArea;
+		const float distance = -glm::dot(normal, p0);
+		const float weight = doubleArea * 0.5f;
+		quadric.a00 += weight * normal.x * normal.x;
+		quadric.a11 += weight * normal.y * normal.y;
+		quadric.a22 += weight * normal.z * normal.z;
+		quadric.a10 += weight * normal.y * normal.x;
+		quadric.a20 += weight * normal.z * normal.x;
+		quadric.a21 += weight * normal.z * normal.y;
+		quadric.b0 += weight * normal.x * distance;
+		quadric.b1 += weight * normal.y * distance;
+		quadric.b2 += weight * normal.z * distance;
+		quadric.c += weight * distance * distance;
+		quadric.weight += weight;
+	}
+
+	void addQuadric(Quadric& target, const Quadric& source) noexcept
+	{
+		target.a00 += source.a00;
+		target.a11 += source.a11;
+		target.a22 += source.a22;
+		target.a10 += source.a10;
+		target.a20 += source.a20;
+		target.a21 += source.a21;
+		target.b0 += source.b0;
+		target.b1 += source.b1;
+		target.b2 += source.b2;
+		target.c += source.c;
+		target.weight += source.weight;
+	}
+
+	//Mean squared distance of point to the planes the quadric was built from
+	float getError(const Quadric& quadric, const glm::vec3& point) noexcept
+	{
+		const float x = point.x, y = point.y, z = point.z;
+		const float error = quadric.a00 * x * x + quadric.a11 * y * y + quadric.a22 * z * z +
+			2.0f * (quadric.a10 * x * y + quadric.a20 * x * z + quadric.a21 * y * z) +
+			2.0f * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) + quadric.c;
+		return (quadric.weight > 0.0f) ? std::fabs(error) / quadric.weight : 0.0f;
+	}
+
+	inline uint64_t getEdgeKey(uint32_t first, uint32_t second) noexcept
+	{
+		return (static_cast<uint64_t>(std::min(first, second)) << 32) | std::max(first, second);
+	}
+
+	//Moving source onto target must not turn any of source's remaining triangles over
+	bool hasTriangleFlip(const std::vector<glm::vec3>& positions, const uint32_t* triangle, uint32_t source, uint32_t target) noexcept
+	{
+		glm::vec3 corners[3];
+		glm::vec3 movedCorners[3];
+		for (int i = 0; i < 3; i++)
+		{
+			corners[i] = positions[triangle[i]];
+			movedCorners[i] = (triangle[i] == source) ? positions[target] : corners[i];
+		}
+		const glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+		const glm::vec3 movedNormal = glm::cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+		//Turning by more than about 75 degrees counts as a flip
+		return glm::dot(normal, movedNormal) < 0.25f * glm::length(normal) * glm::length(movedNormal);
+	}
+}
+
+bool MeshSimplifier::simplify(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError,
+	const std::function<bool(float)>& progress)
+{
+	if (indices.size() <= targetIndexCount || indices.size() < 3)
+		return true;
+	//The vertices of the triangles are renumbered so every array below only spans them
+	std::vector<uint32_t> localToGlobal(indices);
+	std::sort(localToGlobal.begin(), localToGlobal.end());
+	localToGlobal.erase(std::unique(localToGlobal.begin(), localToGlobal.end()), localToGlobal.end());
+	const uint32_t vertexCount = static_cast<uint32_t>(localToGlobal.size());
+	std::vector<uint32_t> localIndices(indices.size());
+	for (size_t i = 0; i < indices.size(); i++)
+		localIndices[i] = static_cast<uint32_t>(std::lower_bound(localToGlobal.begin(), localToGlobal.end(), indices[i]) - localToGlobal.begin());
+
+	//Scaled into the unit cube so errors are relative to the extent and the float quadrics keep their precision
+	glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+	for (const uint32_t index : localToGlobal)
+	{
+		boundsMin = glm::min(boundsMin, positions[index]);
+		boundsMax = glm::max(boundsMax, positions[index]);
+	}
+	const glm::vec3 size = boundsMax - boundsMin;
+	const float extent = std::max(size.x, std::max(size.y, size.z));
+	const float scale = (extent > 0.0f) ? 1.0f / extent : 1.0f;
+	std::vector<glm::vec3> localPositions(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		localPositions[i] = (positions[localToGlobal[i]] - boundsMin) * scale;
+
+	//Vertices sharing a position are one point of the surface, split by a UV seam or a hard edge
+	std::vector<uint32_t> sortedVertices(vertexCount);
+	std::iota(sortedVertices.begin(), sortedVertices.end(), 0u);
+	std::sort(sortedVertices.begin(), sortedVertices.end(), [&localPositions](uint32_t first, uint32_t second)
+	{
+		const glm::vec3& a = localPositions[first];
+		const glm::vec3& b = localPositions[second];
+		return (a.x != b.x) ? a.x < b.x : ((a.y != b.y) ? a.y < b.y : a.z < b.z);
+	});
+	std::vector<uint32_t> positionIds(vertexCount);
+	std::vector<uint8_t> isLocked(vertexCount, 0);
+	for (uint32_t runStart = 0; runStart < vertexCount;)
+	{
+		uint32_t runEnd = runStart + 1;
+		while (runEnd < vertexCount && localPositions[sortedVertices[runEnd]] == localPositions[sortedVertices[runStart]])
+			runEnd++;
+		for (uint32_t i = runStart; i < runEnd; i++)
+		{
+			positionIds[sortedVertices[i]] = sortedVertices[runStart];
+			isLocked[sortedVertices[i]] = (runEnd - runStart > 1) ? 1 : 0;
+		}
+		runStart = runEnd;
+	}
+	//Edges of the welded surface that are not shared by exactly two triangles running opposite ways are borders
+	std::vector<PositionEdge> edges;
+	edges.reserve(localIndices.size());
+	for (size_t triangle = 0; triangle < localIndices.size(); triangle += 3)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const uint32_t first = positionIds[localIndices[triangle + corner]];
+			const uint32_t second = positionIds[localIndices[triangle + (corner + 1) % 3]];
+			edges.push_back({ getEdgeKey(first, second), first < second });
+		}
+	}
+	std::sort(edges.begin(), edges.end(), [](const PositionEdge& first, const PositionEdge& second) { return first.key < second.key; });
+	std::vector<uint8_t> isPositionLocked(vertexCount, 0);
+	for (size_t runStart = 0; runStart < edges.size();)
+	{
+		size_t runEnd = runStart + 1;
+		while (runEnd < edges.size() && edges[runEnd].key == edges[runStart].key)
+			runEnd++;
+		if (runEnd - runStart != 2 || edges[runStart].isForward == edges[runStart + 1].isForward)
+		{
+			isPositionLocked[static_cast<uint32_t>(edges[runStart].key >> 32)] = 1;
+			isPositionLocked[static_cast<uint32_t>(edges[runStart].key & 0xFFFFFFFFu)] = 1;
+		}
+		runStart = runEnd;
+	}
+	edges = std::vector<PositionEdge>();
+	for (uint32_t i = 0; i < vertexCount; i++)
+		isLocked[i] |= isPositionLocked[positionIds[i]];
+
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+	for (size_t triangle = 0; triangle < localIndices.size(); triangle += 3)
+	{
+		Quadric triangleQuadric = {};
+		addTriangleQuadric(triangleQuadric, localPositions[localIndices[triangle]], localPositions[localIndices[triangle + 1]],
+			localPositions[localIndices[triangle + 2]]);
+		for (int corner = 0; corner < 3; corner++)
+			addQuadric(quadrics[localIndices[triangle + corner]], triangleQuadric);
+	}
+
+	const float maxSquaredError = maxError * maxError;
+	const size_t startIndexCount = localIndices.size();
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacentTriangles;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> remap(vertexCount);
+	std::iota(remap.begin(), remap.end(), 0u);
+	std::vector<uint8_t> isPassLocked(vertexCount);
+	std::vector<uint32_t> sourceNeighbours;
+	std::vector<uint32_t> targetNeighbours;
+	while (localIndices.size() > targetIndexCount)
+	{
+		//Triangles around every vertex
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+		for (const uint32_t index : localIndices)
+			adjacencyOffsets[index + 1]++;
+		std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+		adjacentTriangles.resize(localIndices.size());
+		{
+			std::vector<uint32_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < localIndices.size(); i++)
+				adjacentTriangles[fillOffsets[localIndices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		//Every edge is seen once per direction on a closed surface, so each endpoint gets to be the one that moves
+		collapses.clear();
+		for (size_t triangle = 0; triangle < localIndices.size(); triangle += 3)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				const uint32_t source = localIndices[triangle + corner];
+				const uint32_t target = localIndices[triangle + (corner + 1) % 3];
+				if (isLocked[source] || source == target)
+					continue;
+				const float error = getError(quadrics[source], localPositions[target]);
+				if (error <= maxSquaredError)
+					collapses.push_back({ source, target, error });
+			}
+		}
+		if (collapses.empty())
+			break;
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& first, const Collapse& second) { return first.error < second.error; });
+		//Only the cheapest third is collapsed per pass, the others are scored again once the quadrics around them have grown
+		const float passErrorLimit = collapses[collapses.size() / 3].error;
+		const size_t trianglesToRemove = (localIndices.size() - targetIndexCount + 2) / 3;
+
+		std::fill(isPassLocked.begin(), isPassLocked.end(), static_cast<uint8_t>(0));
+		size_t removedTriangleCount = 0;
+		size_t collapseCount = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (collapse.error > passErrorLimit || removedTriangleCount >= trianglesToRemove)
+				break;
+			const uint32_t source = collapse.source;
+			const uint32_t target = collapse.target;
+			if (isPassLocked[source] || isPassLocked[target])
+				continue;
+
+			bool canCollapse = true;
+			size_t sharedTriangleCount = 0;
+			sourceNeighbours.clear();
+			for (uint32_t i = adjacencyOffsets[source]; i < adjacencyOffsets[source + 1] && canCollapse; i++)
+			{
+				const uint32_t* triangle = &localIndices[static_cast<size_t>(adjacentTriangles[i]) * 3];
+				if (triangle[0] == target || triangle[1] == target || triangle[2] == target)
+					sharedTriangleCount++;
+				else if (hasTriangleFlip(localPositions, triangle, source, target))
+					canCollapse = false;
+				for (int corner = 0; corner < 3; corner++)
+				{
+					if (triangle[corner] != source)
+						sourceNeighbours.push_back(triangle[corner]);
+				}
+			}
+			if (!canCollapse)
+				continue;
+			//Both ends may only share the vertices opposite the edge, anything more would pinch the surface into a non manifold edge
+			targetNeighbours.clear();
+			for (uint32_t i = adjacencyOffsets[target]; i < adjacencyOffsets[target + 1]; i++)
+			{
+				const uint32_t* triangle = &localIndices[static_cast<size_t>(adjacentTriangles[i]) * 3];
+				for (int corner = 0; corner < 3; corner++)
+				{
+					if (triangle[corner] != target)
+						targetNeighbours.push_back(triangle[corner]);
+				}
+			}
+			std::sort(sourceNeighbours.begin(), sourceNeighbours.end());
+			sourceNeighbours.erase(std::unique(sourceNeighbours.begin(), sourceNeighbours.end()), sourceNeighbours.end());
+			std::sort(targetNeighbours.begin(), targetNeighbours.end());
+			targetNeighbours.erase(std::unique(targetNeighbours.begin(), targetNeighbours.end()), targetNeighbours.end());
+			size_t sharedNeighbourCount = 0;
+			for (const uint32_t neighbour : sourceNeighbours)
+			{
+				if (neighbour != target && std::binary_search(targetNeighbours.begin(), targetNeighbours.end(), neighbour))
+					sharedNeighbourCount++;
+			}
+			if (sharedNeighbourCount != sharedTriangleCount)
+				continue;
+
+			remap[source] = target;
+			addQuadric(quadrics[target], quadrics[source]);
+			//The triangles around source change, none of their vertices is touched again until the next pass
+			isPassLocked[target] = 1;
+			for (const uint32_t neighbour : sourceNeighbours)
+				isPassLocked[neighbour] = 1;
+			isPassLocked[source] = 1;
+			removedTriangleCount += sharedTriangleCount;
+			collapseCount++;
+		}
+		if (collapseCount == 0)
+			break;
+
+		size_t keptIndexCount = 0;
+		for (size_t triangle = 0; triangle < localIndices.size(); triangle += 3)
+		{
+			const uint32_t a = remap[localIndices[triangle]];
+			const uint32_t b = remap[localIndices[triangle + 1]];
+			const uint32_t c = remap[localIndices[triangle + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			localIndices[keptIndexCount++] = a;
+			localIndices[keptIndexCount++] = b;
+			localIndices[keptIndexCount++] = c;
+		}
+		localIndices.resize(keptIndexCount);
+		std::iota(remap.begin(), remap.end(), 0u);
+		if (progress && !progress(static_cast<float>(startIndexCount - localIndices.size()) / static_cast<float>(startIndexCount - targetIndexCount)))
+			return false;
+	}
+
+	indices.resize(localIndices.size());
+	for (size_t i = 0; i < localIndices.size(); i++)
+		indices[i] = localToGlobal[localIndices[i]];
+	return true;
+}
+
+bool MeshSimplifier::needsLods(const PackedMesh& mesh) noexcept
+{
+	return mesh.lodCount == 1 && mesh.indices.size() / 3 >= LOD_MIN_TRIANGLE_COUNT;
+}
+
+bool MeshSimplifier::buildLods(const std::vector<glm::vec3>& positions, PackedMesh& mesh, const std::function<bool(float)>& progress)
+{
+	if (!needsLods(mesh))
+		return true;
+	std::vector<MeshPart> parts = mesh.parts;
+	if (parts.empty())
+	{
+		MeshPart part = { 0, static_cast<uint32_t>(mesh.indices.size()), 0, { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+		for (const glm::vec3& position : positions)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				part.boundsMin[axis] = std::min(part.boundsMin[axis], position[axis]);
+				part.boundsMax[axis] = std::max(part.boundsMax[axis], position[axis]);
+			}
+		}
+		parts.push_back(part);
+	}
+
+	//Every level is simplified from the one before it, part by part so the ranges and materials carry over
+	std::vector<uint32_t> lodIndices(mesh.indices);
+	std::vector<MeshPart> lodParts = parts;
+	std::vector<uint32_t> levelIndices;
+	std::vector<MeshPart> levelParts;
+	std::vector<uint32_t> partIndices;
+	std::vector<uint32_t> previousIndices(mesh.indices);
+	std::vector<MeshPart> previousParts = parts;
+	unsigned int lodCount = 1;
+	for (unsigned int level = 1; level <= MAX_LOD_COUNT; level++)
+	{
+		const size_t previousTriangleCount = previousIndices.size() / 3;
+		if (previousTriangleCount / LOD_REDUCTION < LOD_MIN_LEVEL_TRIANGLE_COUNT)
+			break;
+		const float maxError = LOD_MAX_ERROR * static_cast<float>(1u << (level - 1));
+		levelIndices.clear();
+		levelParts.clear();
+		size_t doneIndexCount = 0;
+		for (const MeshPart& previousPart : previousParts)
+		{
+			partIndices.assign(previousIndices.begin() + previousPart.firstIndex, previousIndices.begin() + previousPart.firstIndex + previousPart.indexCount);
+			auto partProgress = [&](float fraction)
+			{
+				const float levelFraction = (doneIndexCount + fraction * previousPart.indexCount) / static_cast<float>(previousIndices.size());
+				return !progress || progress((level - 1 + levelFraction) / MAX_LOD_COUNT);
+			};
+			if (!simplify(positions, partIndices, partIndices.size() / 3 / LOD_REDUCTION * 3, maxError, partProgress))
+				return false;
+			doneIndexCount += previousPart.indexCount;
+			MeshPart part = previousPart;
+			part.firstIndex = static_cast<uint32_t>(levelIndices.size());
+			part.indexCount = static_cast<uint32_t>(partIndices.size());
+			levelParts.push_back(part);
+			levelIndices.insert(levelIndices.end(), partIndices.begin(), partIndices.end());
+		}
+		//Mostly seams and borders, which are never collapsed
+		if (levelIndices.size() > previousIndices.size() * LOD_MAX_KEPT_FRACTION)
+			break;
+		MeshOptimizer::optimizeParts(positions, levelParts, levelIndices);
+
+		const uint32_t levelOffset = static_cast<uint32_t>(lodIndices.size());
+		lodIndices.insert(lodIndices.end(), levelIndices.begin(), levelIndices.end());
+		for (MeshPart part : levelParts)
+		{
+			part.firstIndex += levelOffset;
+			lodParts.push_back(part);
+		}
+		lodCount++;
+		previousIndices.swap(levelIndices);
+		previousParts.swap(levelParts);
+	}
+	if (lodCount > 1)
+	{
+		mesh.indices = std::move(lodIndices);
+		mesh.parts = std::move(lodParts);
+		mesh.lodCount = lodCount;
+	}
+	return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <GLM\glm.hpp>
+#include "VertexPacking.h"
+/*
+Quadric error edge collapse simplification (Garland and Heckbert) that builds the LODs of heavy preview models
+A vertex is only ever collapsed onto one of its neighbours, so every LOD indexes the vertex buffer of the full detail
+mesh. Vertices on open borders, part borders, UV seams and hard edges stay where they are, and collapses that would
+flip a triangle or leave an edge shared by more than two triangles are skipped
+*/
+class MeshSimplifier
+{
+public:
+	//Models with fewer triangles are only drawn at full detail
+	static const size_t LOD_MIN_TRIANGLE_COUNT = 20000;
+	//Coarser levels built after the full detail one at most
+	static const unsigned int MAX_LOD_COUNT = 3;
+	MeshSimplifier() = delete;
+	//Collapse edges of the triangles in indices until targetIndexCount indices are left or every remaining collapse would
+	//move the surface further than maxError, given as a fraction of the extent of the triangles. Triangles keep their order
+	//progress is called between passes with the fraction done, returns false if it asked to stop
+	static bool simplify(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError,
+		const std::function<bool(float)>& progress = nullptr);
+	//True if mesh is heavy enough for LODs and has none yet
+	static bool needsLods(const PackedMesh& mesh) noexcept;
+	//Append coarser levels of the full detail triangles to the indices and parts of mesh, positions are indexed by vertex
+	//Returns false if progress asked to stop, mesh is then left unchanged
+	static bool buildLods(const std::vector<glm::vec3>& positions, PackedMesh& mesh, const std::function<bool(float)>& progress = nullptr);
+};
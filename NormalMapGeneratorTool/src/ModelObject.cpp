@@ -1,6 +1,20 @@
 #include "ModelObject.h"
 #include <GL\glew.h>
+#include "GLutil.h"
 #include <iostream>
+#include <cstring>
+#include <cstddef>
+#include <GLM\gtc\matrix_access.hpp>
+#include <GLM\gtc\constants.hpp>
+
+namespace
+{
+	struct AttributeLineVertex
+	{
+		float position[3];
+		int16_t offset[4];
+	};
+}
 
 ModelObject::ModelObject()
 {
@@ -15,7 +29,7 @@ ModelObject::ModelObject(float vertexData[], int vertexDataCount)
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBufferData(GL_ARRAY_BUFFER, vertexDataCount, vertexData, GL_STATIC_DRAW);
 
-	glBindVertexArray(VAO);
+	GL::bindVertexArray(VAO);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
@@ -24,22 +38,19 @@ ModelObject::ModelObject(float vertexData[], int vertexDataCount)
 	glEnableVertexAttribArray(2);
 }
 
-ModelObject::ModelObject(float vertexData[], int vertexDataCount, unsigned int indices[], int indicesCount)
-{
-	updateMeshData(vertexData, vertexDataCount, indices, indicesCount);
-}
-
-void ModelObject::updateMeshData(float vertexData[], int vertexDataCount, unsigned int indices[], int indicesCount)
+void ModelObject::updateMeshData(const void* vertexData, unsigned int vertexCount, VertexFormat format, const unsigned int indices[], int indicesCount)
 {
 	std::cout<<"\nUpdated Mesh";
 	usesElementBuffer = true;
-	this->vertexDataCount = vertexDataCount;
+	this->vertexDataCount = vertexCount;
+	vertexFormat = format;
+	deleteAttributeLines();
 	this->indicesCount = indicesCount;
 
 	if (VAO != 0)
 	{
 		std::cout << "\nPrevious deleted\n";
-		glDeleteVertexArrays(1, &VAO);
+		GL::deleteVertexArray(VAO);
 		glDeleteBuffers(1, &VBO);
 		glDeleteBuffers(1, &EBO);
 	}
@@ -48,46 +59,198 @@ void ModelObject::updateMeshData(float vertexData[], int vertexDataCount, unsign
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
 
-	glBindVertexArray(VAO);
+	GL::bindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, this->vertexDataCount, &vertexData[0], GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexCount) * VertexPacking::getStride(format), vertexData, GL_STATIC_DRAW);
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indicesCount * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(8 * sizeof(float)));
-	glEnableVertexAttribArray(4);
-	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(float), (void*)(11 * sizeof(float)));
+	VertexPacking::setAttributePointers(format);
 	
-	glBindVertexArray(0);
+	GL::bindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void ModelObject::updateIndices(const unsigned int indices[], int indicesCount)
+{
+	if (VAO == 0 || !usesElementBuffer)
+		return;
+	this->indicesCount = indicesCount;
+	GL::bindVertexArray(VAO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indicesCount * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	GL::bindVertexArray(0);
+}
+
 void ModelObject::draw() const
 {
-	glBindVertexArray(VAO);
+	GL::bindVertexArray(VAO);
 	if (usesElementBuffer)
 		glDrawElements(GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT, (void *)0);
 	else
 		glDrawArrays(GL_TRIANGLES, 0, vertexDataCount);
+}
+
+void ModelObject::setParts(const MeshPart* parts, size_t partCount, unsigned int lodCount)
+{
+	this->parts.assign(parts, parts + partCount);
+	this->lodCount = (partCount == 0 || lodCount == 0 || partCount % lodCount != 0) ? 1 : lodCount;
+	partsPerLod = partCount / this->lodCount;
+	lodTriangleCounts.assign(this->lodCount, 0);
+	for (size_t i = 0; i < partCount; i++)
+		lodTriangleCounts[i / partsPerLod] += parts[i].indexCount / 3;
+	if (partCount == 0)
+	{
+		boundsRadius = 0.0f;
+		return;
+	}
+	glm::vec3 boundsMin(parts[0].boundsMin[0], parts[0].boundsMin[1], parts[0].boundsMin[2]);
+	glm::vec3 boundsMax(parts[0].boundsMax[0], parts[0].boundsMax[1], parts[0].boundsMax[2]);
+	for (size_t i = 1; i < partsPerLod; i++)
+	{
+		boundsMin = glm::min(boundsMin, glm::vec3(parts[i].boundsMin[0], parts[i].boundsMin[1], parts[i].boundsMin[2]));
+		boundsMax = glm::max(boundsMax, glm::vec3(parts[i].boundsMax[0], parts[i].boundsMax[1], parts[i].boundsMax[2]));
+	}
+	boundsCentre = (boundsMin + boundsMax) * 0.5f;
+	boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+	//draw() only covers the full detail level, the coarser levels follow it in the element buffer
+	const MeshPart& lastFullDetailPart = parts[partsPerLod - 1];
+	if (this->lodCount > 1)
+		indicesCount = lastFullDetailPart.firstIndex + lastFullDetailPart.indexCount;
+}
+
+unsigned int ModelObject::selectLod(const glm::mat4& viewProjection, const glm::ivec2& viewportSize) const noexcept
+{
+	if (lodCount <= 1 || boundsRadius <= 0.0f)
+		return 0;
+	float coveredPixels = static_cast<float>(viewportSize.x) * static_cast<float>(viewportSize.y);
+	const float clipDepth = (viewProjection * glm::vec4(boundsCentre, 1.0f)).w;
+	//A camera inside the bounds sees the model fill the viewport
+	if (clipDepth > boundsRadius)
+	{
+		//For a perspective projection times a rigid view the second row keeps the projection's vertical scale as its length
+		const float verticalScale = glm::length(glm::vec3(glm::row(viewProjection, 1)));
+		const float radiusPixels = boundsRadius * verticalScale / clipDepth * 0.5f * static_cast<float>(viewportSize.y);
+		coveredPixels = glm::min(coveredPixels, glm::pi<float>() * radiusPixels * radiusPixels);
+	}
+	const float wantedTriangleCount = coveredPixels / LOD_PIXELS_PER_TRIANGLE;
+	unsigned int lod = 0;
+	while (lod + 1 < lodCount && static_cast<float>(lodTriangleCounts[lod + 1]) >= wantedTriangleCount)
+		lod++;
+	return lod;
+}
+
+void ModelObject::draw(const Frustum& frustum, unsigned int lod) const
+{
+	if (!usesElementBuffer || parts.empty())
+	{
+		draw();
+		return;
+	}
+	GL::bindVertexArray(VAO);
+	drawCounts.clear();
+	drawOffsets.clear();
+	size_t rangeEnd = 0;
+	const size_t firstPart = static_cast<size_t>(glm::min(lod, lodCount - 1)) * partsPerLod;
+	for (size_t i = firstPart; i < firstPart + partsPerLod; i++)
+	{
+		const MeshPart& part = parts[i];
+		if (frustum.isBoxVisible(glm::vec3(part.boundsMin[0], part.boundsMin[1], part.boundsMin[2]),
+			glm::vec3(part.boundsMax[0], part.boundsMax[1], part.boundsMax[2])))
+		{
+			//Parts that follow each other in the index buffer are joined into one range
+			if (!drawCounts.empty() && rangeEnd == part.firstIndex)
+				drawCounts.back() += static_cast<int>(part.indexCount);
+			else
+			{
+				drawCounts.push_back(static_cast<int>(part.indexCount));
+				drawOffsets.push_back(reinterpret_cast<const void*>(static_cast<size_t>(part.firstIndex) * sizeof(unsigned int)));
+			}
+			rangeEnd = part.firstIndex + part.indexCount;
+		}
+		const bool isLastOfMaterial = (i + 1 == firstPart + partsPerLod) || parts[i + 1].materialIndex != part.materialIndex;
+		if (isLastOfMaterial && !drawCounts.empty())
+		{
+			glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawOffsets.data(), static_cast<int>(drawCounts.size()));
+			drawCounts.clear();
+			drawOffsets.clear();
+		}
+	}
+}
+
+void ModelObject::drawAttributeLines() const
+{
+	if (!usesElementBuffer || vertexDataCount == 0)
+		return;
+	if (attributeLinesVAO == 0)
+		buildAttributeLines();
+	GL::bindVertexArray(attributeLinesVAO);
+	glDrawArrays(GL_LINES, 0, attributeLineVertexCount);
+}
 
-	glBindVertexArray(0);
+void ModelObject::buildAttributeLines() const
+{
+	//The packed vertices are read back once instead of keeping a copy of every mesh around
+	std::vector<unsigned char> packedVertices(static_cast<size_t>(vertexDataCount) * VertexPacking::getStride(vertexFormat));
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(packedVertices.size()), packedVertices.data());
+	const std::vector<glm::vec3> positions = VertexPacking::unpackPositions(packedVertices.data(), vertexDataCount, vertexFormat);
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec3> tangents;
+	VertexPacking::unpackNormalsAndTangents(packedVertices.data(), vertexDataCount, vertexFormat, normals, tangents);
+	packedVertices = std::vector<unsigned char>();
+
+	std::vector<AttributeLineVertex> lineVertices(static_cast<size_t>(vertexDataCount) * 4);
+	for (unsigned int i = 0; i < vertexDataCount; i++)
+	{
+		//Lifted off the surface a little so the start of the lines does not fight with the model's depth
+		const glm::vec3 start = positions[i] + normals[i] * 0.01f;
+		AttributeLineVertex* lines = &lineVertices[static_cast<size_t>(i) * 4];
+		for (int vertex = 0; vertex < 4; vertex++)
+		{
+			std::memcpy(lines[vertex].position, &start[0], sizeof(lines[vertex].position));
+			const bool isTangent = vertex >= 2;
+			const bool isEnd = (vertex % 2) == 1;
+			const glm::vec3 direction = (isEnd) ? ((isTangent) ? tangents[i] : normals[i]) : glm::vec3(0.0f);
+			for (int axis = 0; axis < 3; axis++)
+				lines[vertex].offset[axis] = VertexPacking::toSnorm16(direction[axis]);
+			lines[vertex].offset[3] = VertexPacking::toSnorm16((isTangent) ? 1.0f : 0.0f);
+		}
+	}
+	attributeLineVertexCount = static_cast<unsigned int>(lineVertices.size());
+
+	glGenVertexArrays(1, &attributeLinesVAO);
+	glGenBuffers(1, &attributeLinesVBO);
+	GL::bindVertexArray(attributeLinesVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, attributeLinesVBO);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(lineVertices.size() * sizeof(AttributeLineVertex)), lineVertices.data(), GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(AttributeLineVertex), (void*)offsetof(AttributeLineVertex, position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_SHORT, GL_TRUE, sizeof(AttributeLineVertex), (void*)offsetof(AttributeLineVertex, offset));
+	GL::bindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ModelObject::deleteAttributeLines() const
+{
+	if (attributeLinesVAO == 0)
+		return;
+	GL::deleteVertexArray(attributeLinesVAO);
+	glDeleteBuffers(1, &attributeLinesVBO);
+	attributeLinesVAO = 0;
+	attributeLinesVBO = 0;
+	attributeLineVertexCount = 0;
 }
 
 ModelObject::~ModelObject() 
 {
+	deleteAttributeLines();
 	if (VAO != 0)
 	{
 		std::cout << "\nRemoved Model From Memory\n";
-		glDeleteVertexArrays(1, &VAO);
+		GL::deleteVertexArray(VAO);
 		glDeleteBuffers(1, &VBO);
 		glDeleteBuffers(1, &EBO);
 	}
@@ -1,19 +1,56 @@
 #pragma once
 #include "ShaderProgram.h"
+#include "VertexPacking.h"
+#include "MeshData.h"
+#include "Frustum.h"
 class ModelObject
 {
+public:
+	//While a coarser LOD is allowed, it is picked if it still has a triangle for every this many covered pixels
+	static constexpr float LOD_PIXELS_PER_TRIANGLE = 4.0f;
 private:
 	bool usesElementBuffer = false;
 	unsigned int vertexDataCount = 0;
 	unsigned int indicesCount = 0;
 	unsigned int VBO = 0, VAO = 0, EBO = 0;
+	VertexFormat vertexFormat = VertexFormat::PACKED;
+	//Normal and tangent line of every vertex, built from the vertex buffer the first time they are drawn
+	mutable unsigned int attributeLinesVAO = 0, attributeLinesVBO = 0;
+	mutable unsigned int attributeLineVertexCount = 0;
+	//Parts of every LOD, partsPerLod each with the full detail level first
+	std::vector<MeshPart> parts;
+	unsigned int lodCount = 1;
+	size_t partsPerLod = 0;
+	std::vector<unsigned int> lodTriangleCounts;
+	//Bounding sphere of the full detail parts
+	glm::vec3 boundsCentre = glm::vec3(0.0f);
+	float boundsRadius = 0.0f;
+	//Reused by draw(frustum) so culling does not allocate every frame
+	mutable std::vector<int> drawCounts;
+	mutable std::vector<const void*> drawOffsets;
 public:
 	ModelObject();
 	ModelObject(float vertexData[], int count);
-	ModelObject(float vertexData[], int vertexDataCount, unsigned int indices[], int indicesCount);
 	~ModelObject();
 
-	//Provide new data to existing model
-	void updateMeshData(float vertexData[], int vertexDataCount, unsigned int indices[], int indicesCount);
+	//Provide new data to existing model, vertexData holds vertexCount vertices in format
+	void updateMeshData(const void* vertexData, unsigned int vertexCount, VertexFormat format, const unsigned int indices[], int indicesCount);
+	//Replace the element buffer, the vertices stay as they are
+	void updateIndices(const unsigned int indices[], int indicesCount);
+	//Set the index ranges draw(frustum) culls, models without parts are drawn whole
+	//With more than one LOD the ranges of each level follow each other, see PackedMesh
+	void setParts(const MeshPart* parts, size_t partCount, unsigned int lodCount = 1);
+	unsigned int getLodCount()const noexcept { return lodCount; }
+	//Coarsest LOD that keeps a triangle for every LOD_PIXELS_PER_TRIANGLE pixels the model covers in a viewport of viewportSize
+	unsigned int selectLod(const glm::mat4& viewProjection, const glm::ivec2& viewportSize) const noexcept;
+	//Draws the full detail level
 	void draw() const;
+	//Draw the parts of level lod whose bounds intersect frustum, visible parts sharing a material are drawn with a single call
+	void draw(const Frustum& frustum, unsigned int lod = 0) const;
+	//Draw a line along the normal and one along the tangent of every vertex as GL_LINES for modelAttribsDisplay.vs
+	//aPos is where a line starts and aOffset its unit direction, xyz, with w 0 for normals and 1 for tangents
+	void drawAttributeLines() const;
+private:
+	void buildAttributeLines() const;
+	void deleteAttributeLines() const;
 };
\ No newline at end of file
@@ -0,0 +1,665 @@
+#include "NoraFileHandler.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <algorithm>
+#include "HashUtility.h"
+#include "ParallelUtility.h"
+#include "Stb\stb_image.h"
+
+//Defined in stb_image_write, not exposed through its header
+unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+namespace
+{
+	const int ZLIB_COMPRESSION_QUALITY = 5;
+	//Pixels per compressed block, small enough to give every core several blocks on large images
+	const uint32_t PIXELS_PER_BLOCK = 256 * 1024;
+
+	void setChunkType(NoraChunkEntry& entry, const char* type)
+	{
+		std::memcpy(entry.type, type, 4);
+	}
+
+	bool isChunkOfType(const NoraChunkEntry& entry, const char* type)
+	{
+		return std::memcmp(entry.type, type, 4) == 0;
+	}
+
+	//Append a chunk to the file and record it in the table of contents
+	void writeChunk(std::ofstream& file, std::vector<NoraChunkEntry>& toc, const char* type, uint32_t layerIndex,
+		NoraChunkCompression compression, const unsigned char* data, size_t storedSize, size_t rawSize)
+	{
+		NoraChunkEntry entry;
+		setChunkType(entry, type);
+		entry.layerIndex = layerIndex;
+		entry.compression = compression;
+		entry.checksum = HashUtility::crc32(data, storedSize);
+		entry.offset = static_cast<uint64_t>(file.tellp());
+		entry.storedSize = storedSize;
+		entry.rawSize = rawSize;
+		file.write(reinterpret_cast<const char*>(data), storedSize);
+		toc.push_back(entry);
+	}
+
+	//Read the previews that follow the project record in a PROJ chunk
+	bool parseThumbnails(const unsigned char* projectData, size_t size, NoraThumbnails& thumbnails)
+	{
+		if (size < sizeof(NoraProjectRecord) + sizeof(NoraThumbnailHeader))
+			return false;
+		NoraThumbnailHeader thumbnailHeader;
+		std::memcpy(&thumbnailHeader, projectData + sizeof(NoraProjectRecord), sizeof(NoraThumbnailHeader));
+		const size_t pixelCount = static_cast<size_t>(thumbnailHeader.width) * thumbnailHeader.height;
+		if (pixelCount == 0 || thumbnailHeader.width > NoraFileHandler::THUMBNAIL_SIZE || thumbnailHeader.height > NoraFileHandler::THUMBNAIL_SIZE ||
+			sizeof(NoraProjectRecord) + sizeof(NoraThumbnailHeader) + pixelCount * 4 > size)
+			return false;
+		const unsigned char* pixels = projectData + sizeof(NoraProjectRecord) + sizeof(NoraThumbnailHeader);
+		thumbnails.width = static_cast<int>(thumbnailHeader.width);
+		thumbnails.height = static_cast<int>(thumbnailHeader.height);
+		thumbnails.normalPixels.assign(pixels, pixels + pixelCount * 3);
+		thumbnails.heightPixels.assign(pixels + pixelCount * 3, pixels + pixelCount * 4);
+		return true;
+	}
+
+	//Box filter the first outputComponentCount channels of an image down to outputWidth x outputHeight
+	void downsamplePixels(const unsigned char* input, int inputWidth, int inputHeight, int inputComponentCount,
+		unsigned char* output, int outputWidth, int outputHeight, int outputComponentCount)
+	{
+		ParallelUtility::parallelFor(static_cast<size_t>(outputHeight), [&](size_t outputY)
+			{
+				const int startY = static_cast<int>(outputY * inputHeight / outputHeight);
+				const int endY = glm::max(startY + 1, static_cast<int>((outputY + 1) * inputHeight / outputHeight));
+				for (int outputX = 0; outputX < outputWidth; outputX++)
+				{
+					const int startX = outputX * inputWidth / outputWidth;
+					const int endX = glm::max(startX + 1, (outputX + 1) * inputWidth / outputWidth);
+					unsigned int sums[4] = { 0, 0, 0, 0 };
+					for (int y = startY; y < endY; y++)
+					{
+						const unsigned char* pixel = input + (static_cast<size_t>(y) * inputWidth + startX) * inputComponentCount;
+						for (int x = startX; x < endX; x++, pixel += inputComponentCount)
+						{
+							for (int channel = 0; channel < outputComponentCount; channel++)
+								sums[channel] += pixel[channel];
+						}
+					}
+					const unsigned int sampleCount = static_cast<unsigned int>((endY - startY) * (endX - startX));
+					unsigned char* outputPixel = output + (outputY * outputWidth + outputX) * outputComponentCount;
+					for (int channel = 0; channel < outputComponentCount; channel++)
+						outputPixel[channel] = static_cast<unsigned char>(sums[channel] / sampleCount);
+				}
+			});
+	}
+}
+
+NoraFileReader::NoraFileReader()
+{
+	std::memset(&fileHeader, 0, sizeof(NoraFileHeader));
+}
+
+bool NoraFileReader::open(const std::string& path)
+{
+	close();
+	if (!mappedFile.open(path))
+		return false;
+	this->path = path;
+	if (mappedFile.getSize() < sizeof(NoraFileHeader) || std::memcmp(mappedFile.getData(), "nora", 4) != 0)
+	{
+		std::cout << "\nNot a nora file : " << path;
+		close();
+		return false;
+	}
+	const unsigned short majorVersion = reinterpret_cast<const NoraFileHeader*>(mappedFile.getData())->majorVersion;
+	bool isOpened = false;
+	if (majorVersion == 1)
+		isOpened = openVersion1();
+	else if (majorVersion == NoraFileHandler::MAJOR_VERSION)
+		isOpened = openVersion2();
+	else
+		std::cout << "\nUnsupported nora file version " << majorVersion << " : " << path;
+
+	if (!isOpened)
+		close();
+	return isOpened;
+}
+
+void NoraFileReader::close()
+{
+	mappedFile.close();
+	path.clear();
+	layerInfos.clear();
+	layerDataChunks.clear();
+	hasChecksums = false;
+	std::memset(&fileHeader, 0, sizeof(NoraFileHeader));
+}
+
+bool NoraFileReader::isOpen() const noexcept
+{
+	return mappedFile.isOpen();
+}
+
+const std::string& NoraFileReader::getPath() const noexcept
+{
+	return path;
+}
+
+const NoraFileHeader& NoraFileReader::getFileHeader() const noexcept
+{
+	return fileHeader;
+}
+
+const LayerInfoData& NoraFileReader::getLayerInfo(int index) const
+{
+	return layerInfos.at(index);
+}
+
+bool NoraFileReader::openVersion1()
+{
+	std::memcpy(&fileHeader, mappedFile.getData(), sizeof(NoraFileHeader));
+	hasChecksums = false;
+	//Version 1 has no index, walk the layer headers to find where each layer's data lives
+	uint64_t offset = sizeof(NoraFileHeader);
+	for (unsigned int i = 0; i < fileHeader.numberOfLayers; i++)
+	{
+		if (offset + sizeof(LayerInfoData) > mappedFile.getSize())
+			return false;
+		LayerInfoData info;
+		std::memcpy(&info, mappedFile.getData() + offset, sizeof(LayerInfoData));
+		offset += sizeof(LayerInfoData);
+		if (offset + info.dataSize > mappedFile.getSize())
+			return false;
+		//Layer 0 has always been a raw pixel dump regardless of the stored format
+		if (i == 0)
+			info.format = ImageFormat::UNCOMPRESSED_RAW;
+
+		NoraChunkEntry entry;
+		setChunkType(entry, "PIXL");
+		entry.layerIndex = i;
+		entry.compression = NoraChunkCompression::NONE;
+		entry.checksum = 0;
+		entry.offset = offset;
+		entry.storedSize = info.dataSize;
+		entry.rawSize = info.dataSize;
+		layerInfos.push_back(info);
+		layerDataChunks.push_back(entry);
+		offset += info.dataSize;
+	}
+	return true;
+}
+
+bool NoraFileReader::openVersion2()
+{
+	if (mappedFile.getSize() < sizeof(NoraContainerHeader))
+		return false;
+	NoraContainerHeader containerHeader;
+	std::memcpy(&containerHeader, mappedFile.getData(), sizeof(NoraContainerHeader));
+	const uint64_t tocSize = static_cast<uint64_t>(containerHeader.chunkCount) * sizeof(NoraChunkEntry);
+	if (containerHeader.tocOffset + tocSize > mappedFile.getSize())
+	{
+		std::cout << "\nNora file is truncated : " << path;
+		return false;
+	}
+	const unsigned char* tocData = mappedFile.getData() + containerHeader.tocOffset;
+	if (HashUtility::crc32(tocData, static_cast<size_t>(tocSize)) != containerHeader.tocChecksum)
+	{
+		std::cout << "\nNora file table of contents is corrupted : " << path;
+		return false;
+	}
+	std::vector<NoraChunkEntry> toc(containerHeader.chunkCount);
+	std::memcpy(toc.data(), tocData, static_cast<size_t>(tocSize));
+	hasChecksums = true;
+
+	const NoraChunkEntry* projectChunk = findChunk(toc, "PROJ", 0);
+	if (projectChunk == nullptr || projectChunk->storedSize < sizeof(NoraProjectRecord) || !isChunkValid(*projectChunk))
+		return false;
+	NoraProjectRecord project;
+	std::memcpy(&project, mappedFile.getData() + projectChunk->offset, sizeof(NoraProjectRecord));
+
+	std::memcpy(fileHeader.nora, containerHeader.nora, 5);
+	fileHeader.majorVersion = containerHeader.majorVersion;
+	fileHeader.minorVersion = containerHeader.minorVersion;
+	fileHeader.numberOfLayers = project.numberOfLayers;
+	fileHeader.width = project.width;
+	fileHeader.height = project.height;
+
+	for (uint32_t i = 0; i < project.numberOfLayers; i++)
+	{
+		const NoraChunkEntry* layerChunk = findChunk(toc, "LAYR", i);
+		const NoraChunkEntry* dataChunk = findChunk(toc, "PIXL", i);
+		if (layerChunk == nullptr || dataChunk == nullptr || layerChunk->storedSize < sizeof(NoraLayerRecord) || !isChunkValid(*layerChunk))
+		{
+			std::cout << "\nNora file layer " << i << " is missing or corrupted : " << path;
+			return false;
+		}
+		if (dataChunk->offset + dataChunk->storedSize > mappedFile.getSize())
+			return false;
+		NoraLayerRecord record;
+		std::memcpy(&record, mappedFile.getData() + layerChunk->offset, sizeof(NoraLayerRecord));
+
+		LayerInfoData info;
+		std::memcpy(info.layerName, record.layerName, 100);
+		info.layerName[99] = '\0';
+		info.layerType = static_cast<LayerType>(record.layerType);
+		info.blendMode = static_cast<NormalBlendMethod>(record.blendMode);
+		info.layerStrength = record.layerStrength;
+		info.format = static_cast<ImageFormat>(record.format);
+		info.dataSize = static_cast<unsigned long>(dataChunk->rawSize);
+		layerInfos.push_back(info);
+		layerDataChunks.push_back(*dataChunk);
+	}
+	return true;
+}
+
+bool NoraFileReader::isChunkValid(const NoraChunkEntry& chunk) const
+{
+	if (chunk.offset + chunk.storedSize > mappedFile.getSize())
+		return false;
+	if (!hasChecksums)
+		return true;
+	return HashUtility::crc32(mappedFile.getData() + chunk.offset, static_cast<size_t>(getChecksummedSize(chunk))) == chunk.checksum;
+}
+
+uint64_t NoraFileReader::getChecksummedSize(const NoraChunkEntry& chunk) const
+{
+	if (chunk.compression != NoraChunkCompression::DELTA_BLOCKS || chunk.storedSize < sizeof(NoraPixelBlockHeader))
+		return chunk.storedSize;
+	//Blocks carry their own checksums which are checked while decompressing
+	NoraPixelBlockHeader blockHeader;
+	std::memcpy(&blockHeader, mappedFile.getData() + chunk.offset, sizeof(NoraPixelBlockHeader));
+	return glm::min<uint64_t>(chunk.storedSize, sizeof(NoraPixelBlockHeader) + static_cast<uint64_t>(blockHeader.blockCount) * sizeof(NoraPixelBlock));
+}
+
+const NoraChunkEntry* NoraFileReader::findChunk(const std::vector<NoraChunkEntry>& toc, const char* type, uint32_t layerIndex) const
+{
+	for (const NoraChunkEntry& entry : toc)
+	{
+		if (isChunkOfType(entry, type) && entry.layerIndex == layerIndex)
+			return &entry;
+	}
+	return nullptr;
+}
+
+bool NoraFileReader::readLayerPayload(int index, NoraLayerPayload& payload) const
+{
+	const NoraChunkEntry& chunk = layerDataChunks.at(index);
+	if (!isChunkValid(chunk))
+	{
+		std::cout << "\nChecksum mismatch in layer " << index << " : " << path;
+		return false;
+	}
+	const unsigned char* storedData = mappedFile.getData() + chunk.offset;
+	if (chunk.compression == NoraChunkCompression::NONE)
+	{
+		payload.storage.clear();
+		payload.data = storedData;
+		payload.size = static_cast<size_t>(chunk.storedSize);
+		return true;
+	}
+	payload.storage.resize(static_cast<size_t>(chunk.rawSize));
+	const bool isDecompressed = (chunk.compression == NoraChunkCompression::DELTA_BLOCKS) ?
+		NoraFileHandler::decompressPixelBlocks(storedData, static_cast<size_t>(chunk.storedSize), payload.storage.data(), payload.storage.size()) :
+		NoraFileHandler::decompressData(storedData, static_cast<size_t>(chunk.storedSize), payload.storage.data(), payload.storage.size());
+	if (!isDecompressed)
+	{
+		std::cout << "\nCould not decompress layer " << index << " : " << path;
+		payload.storage.clear();
+		return false;
+	}
+	payload.data = payload.storage.data();
+	payload.size = payload.storage.size();
+	return true;
+}
+
+bool NoraFileReader::readLayerPixels(int index, unsigned char* destination, size_t size) const
+{
+	const NoraChunkEntry& chunk = layerDataChunks.at(index);
+	if (chunk.rawSize != size)
+	{
+		std::cout << "\nLayer " << index << " size does not match the project resolution : " << path;
+		return false;
+	}
+	if (!isChunkValid(chunk))
+	{
+		std::cout << "\nChecksum mismatch in layer " << index << " : " << path;
+		return false;
+	}
+	const unsigned char* storedData = mappedFile.getData() + chunk.offset;
+	if (chunk.compression == NoraChunkCompression::NONE)
+	{
+		std::memcpy(destination, storedData, size);
+		return true;
+	}
+	if (chunk.compression == NoraChunkCompression::DELTA_BLOCKS)
+		return NoraFileHandler::decompressPixelBlocks(storedData, static_cast<size_t>(chunk.storedSize), destination, size);
+	return NoraFileHandler::decompressData(storedData, static_cast<size_t>(chunk.storedSize), destination, size);
+}
+
+bool NoraFileReader::readThumbnails(const std::string& path, NoraThumbnails& thumbnails)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if (!file)
+		return false;
+	NoraContainerHeader containerHeader;
+	if (!file.read(reinterpret_cast<char*>(&containerHeader), sizeof(NoraContainerHeader)) || std::memcmp(containerHeader.nora, "nora", 4) != 0 ||
+		containerHeader.majorVersion != NoraFileHandler::MAJOR_VERSION || containerHeader.minorVersion < 2)
+		return false;
+	std::vector<NoraChunkEntry> toc(containerHeader.chunkCount);
+	file.seekg(static_cast<std::streamoff>(containerHeader.tocOffset));
+	if (!file.read(reinterpret_cast<char*>(toc.data()), toc.size() * sizeof(NoraChunkEntry)) ||
+		HashUtility::crc32(toc.data(), toc.size() * sizeof(NoraChunkEntry)) != containerHeader.tocChecksum)
+		return false;
+	const NoraChunkEntry* projectChunk = nullptr;
+	for (const NoraChunkEntry& entry : toc)
+	{
+		if (isChunkOfType(entry, "PROJ"))
+			projectChunk = &entry;
+	}
+	if (projectChunk == nullptr || projectChunk->compression != NoraChunkCompression::NONE || projectChunk->storedSize > 1024 * 1024)
+		return false;
+	std::vector<unsigned char> projectData(static_cast<size_t>(projectChunk->storedSize));
+	file.seekg(static_cast<std::streamoff>(projectChunk->offset));
+	if (!file.read(reinterpret_cast<char*>(projectData.data()), projectData.size()) ||
+		HashUtility::crc32(projectData.data(), projectData.size()) != projectChunk->checksum)
+		return false;
+	return parseThumbnails(projectData.data(), projectData.size(), thumbnails);
+}
+
+NoraThumbnails NoraFileHandler::createThumbnails(const TextureData& texData, const unsigned char* normalPixels, int normalWidth, int normalHeight)
+{
+	NoraThumbnails thumbnails;
+	const glm::ivec2 res = texData.getRes();
+	if (res.x <= 0 || res.y <= 0 || texData.getTextureData() == nullptr)
+		return thumbnails;
+	//Keep the aspect ratio of the heightmap, the normal map is stretched over the same size
+	const float scale = glm::min(1.0f, static_cast<float>(THUMBNAIL_SIZE) / glm::max(res.x, res.y));
+	thumbnails.width = glm::max(1, static_cast<int>(res.x * scale));
+	thumbnails.height = glm::max(1, static_cast<int>(res.y * scale));
+	const size_t pixelCount = static_cast<size_t>(thumbnails.width) * thumbnails.height;
+	thumbnails.heightPixels.resize(pixelCount);
+	downsamplePixels(texData.getTextureData(), res.x, res.y, texData.getComponentCount(), thumbnails.heightPixels.data(), thumbnails.width, thumbnails.height, 1);
+	thumbnails.normalPixels.resize(pixelCount * 3);
+	if (normalPixels != nullptr && normalWidth > 0 && normalHeight > 0)
+		downsamplePixels(normalPixels, normalWidth, normalHeight, 3, thumbnails.normalPixels.data(), thumbnails.width, thumbnails.height, 3);
+	else
+		std::fill(thumbnails.normalPixels.begin(), thumbnails.normalPixels.end(), static_cast<unsigned char>(128));
+	return thumbnails;
+}
+
+bool NoraFileHandler::writeToDisk(const std::string& path, const TextureData& texData, const LayerManager& layerManager, const NoraThumbnails& thumbnails)
+{
+	const std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "\nCould not open file for writing : " << tempPath;
+		return false;
+	}
+	NoraContainerHeader containerHeader;
+	std::memset(&containerHeader, 0, sizeof(NoraContainerHeader));
+	std::memcpy(containerHeader.nora, "nora", 5);
+	containerHeader.majorVersion = MAJOR_VERSION;
+	containerHeader.minorVersion = MINOR_VERSION;
+	//Placeholder, rewritten once the table of contents location is known
+	file.write(reinterpret_cast<const char*>(&containerHeader), sizeof(NoraContainerHeader));
+
+	std::vector<NoraChunkEntry> toc;
+	const unsigned int numberOfLayers = static_cast<unsigned int>(layerManager.getLayerCount());
+
+	NoraProjectRecord project;
+	project.width = static_cast<uint32_t>(texData.getRes().x);
+	project.height = static_cast<uint32_t>(texData.getRes().y);
+	project.numberOfLayers = numberOfLayers;
+	project.componentCount = static_cast<uint32_t>(texData.getComponentCount());
+	NoraThumbnailHeader thumbnailHeader;
+	thumbnailHeader.width = static_cast<uint32_t>(thumbnails.width);
+	thumbnailHeader.height = static_cast<uint32_t>(thumbnails.height);
+	const size_t thumbnailPixelCount = static_cast<size_t>(thumbnails.width) * thumbnails.height;
+	if (thumbnails.normalPixels.size() != thumbnailPixelCount * 3 || thumbnails.heightPixels.size() != thumbnailPixelCount)
+	{
+		thumbnailHeader.width = 0;
+		thumbnailHeader.height = 0;
+	}
+	std::vector<unsigned char> projectData(sizeof(NoraProjectRecord) + sizeof(NoraThumbnailHeader));
+	std::memcpy(projectData.data(), &project, sizeof(NoraProjectRecord));
+	std::memcpy(projectData.data() + sizeof(NoraProjectRecord), &thumbnailHeader, sizeof(NoraThumbnailHeader));
+	if (thumbnailHeader.width != 0)
+	{
+		projectData.insert(projectData.end(), thumbnails.normalPixels.begin(), thumbnails.normalPixels.end());
+		projectData.insert(projectData.end(), thumbnails.heightPixels.begin(), thumbnails.heightPixels.end());
+	}
+	writeChunk(file, toc, "PROJ", 0, NoraChunkCompression::NONE, projectData.data(), projectData.size(), projectData.size());
+
+	for (unsigned int i = 0; i < numberOfLayers; i++)
+	{
+		NoraLayerRecord record;
+		std::memset(&record, 0, sizeof(NoraLayerRecord));
+		std::strncpy(record.layerName, layerManager.getLayerName(i), 99);
+		record.layerType = static_cast<uint32_t>(layerManager.getLayerType(i));
+		record.blendMode = static_cast<uint32_t>(layerManager.getNormalBlendMethod(i));
+		record.layerStrength = layerManager.getLayerStrength(i);
+		record.format = static_cast<uint32_t>((i == 0) ? ImageFormat::UNCOMPRESSED_RAW : ImageFormat::PNG);
+		writeChunk(file, toc, "LAYR", i, NoraChunkCompression::NONE, reinterpret_cast<const unsigned char*>(&record), sizeof(NoraLayerRecord), sizeof(NoraLayerRecord));
+	}
+
+	for (unsigned int i = 0; i < numberOfLayers; i++)
+	{
+		if (i == 0)
+		{
+			//Base heightmap is raw pixels, it is compressed in blocks straight from the texture data
+			const size_t rawSize = static_cast<size_t>(texData.getRes().x) * texData.getRes().y * texData.getComponentCount();
+			std::vector<unsigned char> compressed = compressPixelBlocks(texData.getTextureData(), texData.getRes().x, texData.getRes().y, texData.getComponentCount());
+			if (compressed.empty())
+			{
+				file.close();
+				std::filesystem::remove(tempPath);
+				return false;
+			}
+			const size_t checksummedSize = sizeof(NoraPixelBlockHeader) + reinterpret_cast<const NoraPixelBlockHeader*>(compressed.data())->blockCount * sizeof(NoraPixelBlock);
+			writeChunk(file, toc, "PIXL", i, NoraChunkCompression::DELTA_BLOCKS, compressed.data(), compressed.size(), rawSize);
+			toc.back().checksum = HashUtility::crc32(compressed.data(), checksummedSize);
+		}
+		else
+		{
+			//Other layers hold the contents of an image file which is already compressed
+			NoraLayerPayload payload;
+			if (!layerManager.getLayerImageData(i, payload))
+			{
+				std::cout << "\nCould not get image data of layer " << i;
+				file.close();
+				std::filesystem::remove(tempPath);
+				return false;
+			}
+			writeChunk(file, toc, "PIXL", i, NoraChunkCompression::NONE, payload.data, payload.size, payload.size);
+		}
+	}
+
+	containerHeader.chunkCount = static_cast<uint32_t>(toc.size());
+	containerHeader.tocOffset = static_cast<uint64_t>(file.tellp());
+	containerHeader.tocChecksum = HashUtility::crc32(toc.data(), toc.size() * sizeof(NoraChunkEntry));
+	file.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(NoraChunkEntry));
+	file.seekp(0, std::ios::beg);
+	file.write(reinterpret_cast<const char*>(&containerHeader), sizeof(NoraContainerHeader));
+	file.close();
+	if (file.fail())
+	{
+		std::cout << "\nFailed writing nora file : " << tempPath;
+		std::filesystem::remove(tempPath);
+		return false;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(tempPath, path, errorCode);
+	if (errorCode)
+	{
+		std::cout << "\nCould not replace " << path << " : " << errorCode.message();
+		return false;
+	}
+	return true;
+}
+
+std::vector<unsigned char> NoraFileHandler::compressData(const unsigned char* data, size_t size)
+{
+	std::vector<unsigned char> compressed;
+	int compressedSize = 0;
+	unsigned char* compressedData = stbi_zlib_compress(const_cast<unsigned char*>(data), static_cast<int>(size), &compressedSize, ZLIB_COMPRESSION_QUALITY);
+	if (compressedData == nullptr)
+		return compressed;
+	compressed.assign(compressedData, compressedData + compressedSize);
+	std::free(compressedData);
+	return compressed;
+}
+
+bool NoraFileHandler::decompressData(const unsigned char* data, size_t size, unsigned char* destination, size_t destinationSize)
+{
+	const int decodedSize = stbi_zlib_decode_buffer(reinterpret_cast<char*>(destination), static_cast<int>(destinationSize),
+		reinterpret_cast<const char*>(data), static_cast<int>(size));
+	return decodedSize >= 0 && static_cast<size_t>(decodedSize) == destinationSize;
+}
+
+std::vector<unsigned char> NoraFileHandler::compressPixelBlocks(const unsigned char* pixels, int width, int height, int componentCount)
+{
+	NoraPixelBlockHeader blockHeader;
+	blockHeader.width = static_cast<uint32_t>(width);
+	blockHeader.height = static_cast<uint32_t>(height);
+	blockHeader.componentCount = static_cast<uint32_t>(componentCount);
+	blockHeader.rowsPerBlock = glm::max(1u, PIXELS_PER_BLOCK / glm::max(1u, blockHeader.width));
+	blockHeader.blockCount = (blockHeader.height + blockHeader.rowsPerBlock - 1) / blockHeader.rowsPerBlock;
+	const size_t rowSize = static_cast<size_t>(width) * componentCount;
+	const int colourChannelCount = glm::min(componentCount, 3);
+	const bool hasAlpha = componentCount == 2 || componentCount == 4;
+
+	//Heightmaps are usually gray with an opaque alpha, only one channel needs to be stored for those
+	std::atomic<bool> isGray(true);
+	ParallelUtility::parallelFor(blockHeader.blockCount, [&](size_t blockIndex)
+		{
+			const uint32_t startRow = static_cast<uint32_t>(blockIndex) * blockHeader.rowsPerBlock;
+			const uint32_t endRow = glm::min(startRow + blockHeader.rowsPerBlock, blockHeader.height);
+			for (uint32_t row = startRow; row < endRow && isGray; row++)
+			{
+				const unsigned char* pixel = pixels + row * rowSize;
+				for (int x = 0; x < width; x++, pixel += componentCount)
+				{
+					if ((colourChannelCount == 3 && (pixel[0] != pixel[1] || pixel[0] != pixel[2])) || (hasAlpha && pixel[componentCount - 1] != 255))
+					{
+						isGray = false;
+						return;
+					}
+				}
+			}
+		});
+	blockHeader.storedChannelCount = isGray ? 1 : static_cast<uint32_t>(componentCount);
+
+	std::vector<std::vector<unsigned char>> compressedBlocks(blockHeader.blockCount);
+	std::atomic<bool> hasFailed(false);
+	ParallelUtility::parallelFor(blockHeader.blockCount, [&](size_t blockIndex)
+		{
+			const uint32_t startRow = static_cast<uint32_t>(blockIndex) * blockHeader.rowsPerBlock;
+			const uint32_t endRow = glm::min(startRow + blockHeader.rowsPerBlock, blockHeader.height);
+			std::vector<unsigned char> filtered(static_cast<size_t>(endRow - startRow) * width * blockHeader.storedChannelCount);
+			unsigned char* output = filtered.data();
+			for (uint32_t channel = 0; channel < blockHeader.storedChannelCount; channel++)
+			{
+				for (uint32_t row = startRow; row < endRow; row++)
+				{
+					const unsigned char* input = pixels + row * rowSize + channel;
+					unsigned char previous = 0;
+					for (int x = 0; x < width; x++, input += componentCount)
+					{
+						*output++ = static_cast<unsigned char>(*input - previous);
+						previous = *input;
+					}
+				}
+			}
+			compressedBlocks[blockIndex] = compressData(filtered.data(), filtered.size());
+			if (compressedBlocks[blockIndex].empty())
+				hasFailed = true;
+		});
+	std::vector<unsigned char> chunk;
+	if (hasFailed)
+		return chunk;
+
+	const size_t tableSize = blockHeader.blockCount * sizeof(NoraPixelBlock);
+	size_t chunkSize = sizeof(NoraPixelBlockHeader) + tableSize;
+	for (const std::vector<unsigned char>& block : compressedBlocks)
+		chunkSize += block.size();
+	chunk.resize(chunkSize);
+	std::memcpy(chunk.data(), &blockHeader, sizeof(NoraPixelBlockHeader));
+	NoraPixelBlock* const blockTable = reinterpret_cast<NoraPixelBlock*>(chunk.data() + sizeof(NoraPixelBlockHeader));
+	size_t offset = sizeof(NoraPixelBlockHeader) + tableSize;
+	for (uint32_t blockIndex = 0; blockIndex < blockHeader.blockCount; blockIndex++)
+	{
+		const std::vector<unsigned char>& block = compressedBlocks[blockIndex];
+		NoraPixelBlock blockEntry;
+		blockEntry.offset = offset;
+		blockEntry.storedSize = static_cast<uint32_t>(block.size());
+		blockEntry.checksum = HashUtility::crc32(block.data(), block.size());
+		std::memcpy(&blockTable[blockIndex], &blockEntry, sizeof(NoraPixelBlock));
+		std::memcpy(chunk.data() + offset, block.data(), block.size());
+		offset += block.size();
+	}
+	return chunk;
+}
+
+bool NoraFileHandler::decompressPixelBlocks(const unsigned char* data, size_t size, unsigned char* destination, size_t destinationSize)
+{
+	if (size < sizeof(NoraPixelBlockHeader))
+		return false;
+	NoraPixelBlockHeader blockHeader;
+	std::memcpy(&blockHeader, data, sizeof(NoraPixelBlockHeader));
+	const int width = static_cast<int>(blockHeader.width);
+	const int componentCount = static_cast<int>(blockHeader.componentCount);
+	const size_t rowSize = static_cast<size_t>(width) * componentCount;
+	const size_t tableSize = static_cast<size_t>(blockHeader.blockCount) * sizeof(NoraPixelBlock);
+	if (rowSize * blockHeader.height != destinationSize || blockHeader.rowsPerBlock == 0 ||
+		blockHeader.blockCount != (blockHeader.height + blockHeader.rowsPerBlock - 1) / blockHeader.rowsPerBlock ||
+		sizeof(NoraPixelBlockHeader) + tableSize > size || (blockHeader.storedChannelCount != 1 && blockHeader.storedChannelCount != blockHeader.componentCount))
+		return false;
+	const unsigned char* const blockTable = data + sizeof(NoraPixelBlockHeader);
+	const bool isGray = blockHeader.storedChannelCount == 1 && componentCount > 1;
+	const int colourChannelCount = glm::min(componentCount, 3);
+
+	std::atomic<bool> hasFailed(false);
+	ParallelUtility::parallelFor(blockHeader.blockCount, [&](size_t blockIndex)
+		{
+			NoraPixelBlock blockEntry;
+			std::memcpy(&blockEntry, blockTable + blockIndex * sizeof(NoraPixelBlock), sizeof(NoraPixelBlock));
+			if (blockEntry.offset + blockEntry.storedSize > size || HashUtility::crc32(data + blockEntry.offset, blockEntry.storedSize) != blockEntry.checksum)
+			{
+				hasFailed = true;
+				return;
+			}
+			const uint32_t startRow = static_cast<uint32_t>(blockIndex) * blockHeader.rowsPerBlock;
+			const uint32_t endRow = glm::min(startRow + blockHeader.rowsPerBlock, blockHeader.height);
+			std::vector<unsigned char> filtered(static_cast<size_t>(endRow - startRow) * width * blockHeader.storedChannelCount);
+			if (!decompressData(data + blockEntry.offset, blockEntry.storedSize, filtered.data(), filtered.size()))
+			{
+				hasFailed = true;
+				return;
+			}
+			const unsigned char* input = filtered.data();
+			for (uint32_t channel = 0; channel < blockHeader.storedChannelCount; channel++)
+			{
+				for (uint32_t row = startRow; row < endRow; row++)
+				{
+					unsigned char* output = destination + row * rowSize;
+					unsigned char value = 0;
+					for (int x = 0; x < width; x++, output += componentCount)
+					{
+						value = static_cast<unsigned char>(value + *input++);
+						if (!isGray)
+						{
+							output[channel] = value;
+							continue;
+						}
+						for (int colourChannel = 0; colourChannel < colourChannelCount; colourChannel++)
+							output[colourChannel] = value;
+						if (componentCount == 2 || componentCount == 4)
+							output[componentCount - 1] = 255;
+					}
+				}
+			}
+		});
+	return !hasFailed;
+}
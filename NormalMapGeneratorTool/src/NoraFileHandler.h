@@ -1,28 +1,44 @@
 #pragma once
-#include <iostream>
-#include <fstream>
+#include <cstdint>
+#include <string>
+#include <vector>
 #include "LayerManager.h"
 #include "TextureLoader.h"
 #include "TextureData.h"
-#include "FileExplorer.h"
-#include "Stb\stb_image.h"
+#include "MemoryMappedFile.h"
 /*
 Nora save file : .nora
-Header Defenition:
+
+Version 1 (read only):
 nora (text)
 [MAJOR VERSION] (unsigned short)
 [MINOR VERSION] (unsigned short)
 [NUMBER OF LAYERS] (unsigned int)
+[WIDTH] (unsigned int)
+[HEIGHT] (unsigned int)
 ------------------
-Layer info:
-[LAYER NAME SIZE] (unsigned int)
-[LAYER NAME] (char...)
-[LAYER TYPE] (LayerType)
-[BLEND MODE] (BlendMode)
-[LAYER STRENGTH] (float)
-[IMAGE FORMAT] (ImageFormat)
-[DATA SIZE (in bytes)] (unsigned long)
-////[DATA] (char...)
+Per layer:
+[LAYER INFO] (LayerInfoData)
+[DATA] (char...) : raw pixels for layer 0, image file contents for the other layers
+
+Version 2 (chunked container):
+[CONTAINER HEADER] (NoraContainerHeader) : magic, version, chunk count and location of the table of contents
+[CHUNK DATA] (char...) : PROJ chunk, one LAYR chunk per layer, then one PIXL chunk per layer
+[TABLE OF CONTENTS] (NoraChunkEntry...) : type, layer, offset, stored size, raw size, compression and CRC-32 of every chunk
+Chunks are located through the table of contents only, so the file is read through a memory mapping and
+layer pixel data is only touched when it is needed
+
+Raw pixel chunks (minor version 1 and up) use DELTA_BLOCKS compression:
+[BLOCK HEADER] (NoraPixelBlockHeader)
+[BLOCK TABLE] (NoraPixelBlock...)
+[BLOCK DATA] (char...) : zlib compressed rows, one plane per stored channel, every row delta filtered from left to right
+Gray images only store a single channel. Blocks are independent so they are compressed and decompressed in parallel,
+the chunk checksum covers the header and block table while every block carries its own CRC-32
+
+PROJ chunks (minor version 2 and up) end with the project previews, so a file can be browsed by reading that chunk only:
+[THUMBNAIL HEADER] (NoraThumbnailHeader)
+[NORMAL MAP] (char...) : composited normal map, RGB
+[HEIGHT MAP] (char...) : single channel
 */
 
 struct LayerInfoData
@@ -45,84 +61,141 @@ struct NoraFileHeader
 	unsigned int height;
 };
 
+enum class NoraChunkCompression : uint32_t { NONE = 0, ZLIB, DELTA_BLOCKS };
+
+//First bytes of a version 2 file, the magic and version fields share their offsets with NoraFileHeader
+struct NoraContainerHeader
+{
+	char nora[5];
+	uint16_t majorVersion;
+	uint16_t minorVersion;
+	uint32_t chunkCount;
+	uint32_t tocChecksum;
+	uint64_t tocOffset;
+};
+
+struct NoraChunkEntry
+{
+	char type[4];
+	uint32_t layerIndex;
+	NoraChunkCompression compression;
+	uint32_t checksum;
+	uint64_t offset;
+	uint64_t storedSize;
+	uint64_t rawSize;
+};
+
+struct NoraPixelBlockHeader
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t componentCount;
+	uint32_t storedChannelCount;
+	uint32_t rowsPerBlock;
+	uint32_t blockCount;
+};
+
+struct NoraPixelBlock
+{
+	uint64_t offset;
+	uint32_t storedSize;
+	uint32_t checksum;
+};
+
+//Contents of the PROJ chunk
+struct NoraProjectRecord
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t numberOfLayers;
+	uint32_t componentCount;
+};
+
+//Follows the project record in the PROJ chunk
+struct NoraThumbnailHeader
+{
+	uint32_t width;
+	uint32_t height;
+};
+
+//Low resolution previews of a project, rows are stored bottom to top like the texture data
+struct NoraThumbnails
+{
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> normalPixels;
+	std::vector<unsigned char> heightPixels;
+};
+
+//Contents of a LAYR chunk
+struct NoraLayerRecord
+{
+	char layerName[100];
+	uint32_t layerType;
+	uint32_t blendMode;
+	float layerStrength;
+	uint32_t format;
+};
+
+//Layer data read from a .nora file, points into the mapped file unless it had to be decompressed into storage
+struct NoraLayerPayload
+{
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+	std::vector<unsigned char> storage;
+};
+
+//Opens a .nora file through a memory mapping, layer data is decompressed and validated only when it is asked for
+class NoraFileReader
+{
+private:
+	MemoryMappedFile mappedFile;
+	std::string path;
+	NoraFileHeader fileHeader;
+	std::vector<LayerInfoData> layerInfos;
+	std::vector<NoraChunkEntry> layerDataChunks;
+	bool hasChecksums = false;
+public:
+	NoraFileReader();
+	//Map the file and read its header and layer table, no layer data is read
+	bool open(const std::string& path);
+	void close();
+	bool isOpen()const noexcept;
+	const std::string& getPath()const noexcept;
+	const NoraFileHeader& getFileHeader()const noexcept;
+	const LayerInfoData& getLayerInfo(int index)const;
+	//Get the stored data of a layer, decompressing it if needed
+	bool readLayerPayload(int index, NoraLayerPayload& payload)const;
+	//Decompress raw layer pixels straight into destination, size has to match the raw size of the layer
+	bool readLayerPixels(int index, unsigned char* destination, size_t size)const;
+	//Read only the previews of a .nora file without mapping it, returns false if the file has none
+	static bool readThumbnails(const std::string& path, NoraThumbnails& thumbnails);
+private:
+	bool openVersion1();
+	bool openVersion2();
+	bool isChunkValid(const NoraChunkEntry& chunk)const;
+	uint64_t getChecksummedSize(const NoraChunkEntry& chunk)const;
+	const NoraChunkEntry* findChunk(const std::vector<NoraChunkEntry>& toc, const char* type, uint32_t layerIndex)const;
+};
+
 class NoraFileHandler
 {
 public:
-	static void writeToDisk(const std::string& path, const TextureData& texData, const LayerManager& layerManager)
-	{
-		NoraFileHeader noraFileHeader;
-		noraFileHeader.nora[0] = 'n';
-		noraFileHeader.nora[1] = 'o';
-		noraFileHeader.nora[2] = 'r';
-		noraFileHeader.nora[3] = 'a';
-		noraFileHeader.nora[4] = '\0';
-
-		noraFileHeader.majorVersion = 1;
-		noraFileHeader.minorVersion = 4;
-		noraFileHeader.numberOfLayers = layerManager.getLayerCount();
-		noraFileHeader.width = static_cast<unsigned int>(texData.getRes().x);
-		noraFileHeader.height = static_cast<unsigned int>(texData.getRes().y);
-
-		std::vector<std::pair<LayerInfoData, unsigned char*>> layerInfos;
-
-		for (unsigned int i = 0; i < noraFileHeader.numberOfLayers; i++)
-		{
-			std::pair<LayerInfoData, unsigned char*> layerInfoPair;
-			std::memcpy(layerInfoPair.first.layerName, layerManager.getLayerName(i), 100);
-			layerInfoPair.first.layerType = layerManager.getLayerType(i);
-			layerInfoPair.first.blendMode = layerManager.getNormalBlendMethod(i);
-			layerInfoPair.first.layerStrength = layerManager.getLayerStrength(i);
-			layerInfoPair.first.format = ImageFormat::PNG;
-
-			if (i > 0)
-			{
-				std::ifstream ifs(layerManager.getImagePath(i), std::ios::binary | std::ios::ate);
-				const std::ifstream::pos_type pos = ifs.tellg();
-				layerInfoPair.first.dataSize = pos;
-				layerInfoPair.second = new unsigned char[pos];
-				ifs.seekg(0, std::ios::beg);
-				ifs.read((char*)(&layerInfoPair.second[0]), pos);
-				ifs.close();
-			}
-			else
-			{
-				layerInfoPair.first.dataSize = static_cast<unsigned long>(texData.getRes().x * texData.getRes().y * texData.getComponentCount());
-				layerInfoPair.second = new unsigned char[layerInfoPair.first.dataSize];
-				std::memset(layerInfoPair.second, '\0', layerInfoPair.first.dataSize);
-				std::memcpy(layerInfoPair.second, texData.getTextureData(), layerInfoPair.first.dataSize);
-			}
-			layerInfos.push_back(layerInfoPair);
-		}
-		std::ofstream myfile(path.c_str(), std::ios::binary);
-		myfile.write((char*)&noraFileHeader, sizeof(NoraFileHeader));
-
-		for (unsigned int i = 0; i < noraFileHeader.numberOfLayers; i++)
-		{
-			myfile.write((char*)&layerInfos[i].first, sizeof(LayerInfoData));
-			myfile.write((char*)(&layerInfos[i].second[0]), layerInfos[i].first.dataSize);
-		}
-		myfile.close();
-		for (unsigned int i = 0; i < noraFileHeader.numberOfLayers; i++)
-			delete[] layerInfos[i].second;
-	}
-
-	static std::vector<std::pair<LayerInfoData, unsigned char*>> readFromDisk(const std::string& path, NoraFileHeader& noraFile)
-	{
-		LayerInfoData info;
-		std::vector<std::pair<LayerInfoData, unsigned char*>> layerInfos;
-		std::ifstream myfile(path.c_str(), std::ios::binary);
-		myfile.read((char*)&noraFile, sizeof(NoraFileHeader));
-		for (unsigned int i = 0; i < noraFile.numberOfLayers; i++)
-		{
-			myfile.read((char*)&info, sizeof(LayerInfoData));
-			unsigned char* data = new unsigned char[info.dataSize];
-			myfile.read((char*)(&data[0]), info.dataSize);
-
-			int x, y, n;
-			stbi_info_from_memory(data, info.dataSize, &x, &y, &n);
-			layerInfos.push_back(std::pair<LayerInfoData, unsigned char*>(info, data));
-		}
-		myfile.close();
-		return layerInfos;
-	}
-};
\ No newline at end of file
+	static const unsigned short MAJOR_VERSION = 2;
+	static const unsigned short MINOR_VERSION = 2;
+	//Longest side of the project previews
+	static const int THUMBNAIL_SIZE = 128;
+	NoraFileHandler() = delete;
+	//Write the project as a version 2 file, the file is written next to path and swapped in once complete
+	static bool writeToDisk(const std::string& path, const TextureData& texData, const LayerManager& layerManager, const NoraThumbnails& thumbnails);
+	//Scale the heightmap and the composited normal map (RGB, any resolution) down to project previews
+	static NoraThumbnails createThumbnails(const TextureData& texData, const unsigned char* normalPixels, int normalWidth, int normalHeight);
+	//Compress data with zlib, returns an empty vector on failure
+	static std::vector<unsigned char> compressData(const unsigned char* data, size_t size);
+	//Decompress zlib data into destination which has to be exactly destinationSize bytes long
+	static bool decompressData(const unsigned char* data, size_t size, unsigned char* destination, size_t destinationSize);
+	//Build a DELTA_BLOCKS chunk from raw pixels, the blocks are filtered and compressed in parallel
+	static std::vector<unsigned char> compressPixelBlocks(const unsigned char* pixels, int width, int height, int componentCount);
+	//Decode a DELTA_BLOCKS chunk into destination, the blocks are validated and decompressed in parallel
+	static bool decompressPixelBlocks(const unsigned char* data, size_t size, unsigned char* destination, size_t destinationSize);
+};
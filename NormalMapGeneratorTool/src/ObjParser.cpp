@@ -0,0 +1,548 @@
+#include "ObjParser.h"
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+#include <GLM\glm.hpp>
+#include "MemoryMappedFile.h"
+#include "ParallelUtility.h"
+
+namespace
+{
+	//Smallest piece of the file a parse thread is given
+	const size_t MIN_CHUNK_SIZE = 1024 * 1024;
+	//Vertices are filled in blocks of this many in parallel
+	const size_t VERTEX_BLOCK_SIZE = 65536;
+	//Fraction of the parse that is done once every chunk has been read
+	const float CHUNKS_PROGRESS = 0.8f;
+	const int32_t NO_INDEX = std::numeric_limits<int32_t>::min();
+	const uint32_t UNUSED_VERTEX = 0xFFFFFFFFu;
+
+	enum : uint8_t { RELATIVE_POSITION = 1, RELATIVE_UV = 2, RELATIVE_NORMAL = 4 };
+
+	//A triangle corner, negative OBJ indices are kept relative to the start of their chunk until the chunks are stitched together
+	struct ObjCorner
+	{
+		int32_t position;
+		int32_t uv;
+		int32_t normal;
+		uint8_t relativeMask;
+	};
+
+	//An o, g or usemtl line, cornerIndex is the first corner that follows it in the chunk
+	struct ObjPartEvent
+	{
+		size_t cornerIndex;
+		bool isMaterial;
+		std::string materialName;
+	};
+
+	struct ObjChunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+		std::vector<float> positions;
+		std::vector<float> uvs;
+		std::vector<float> normals;
+		std::vector<ObjCorner> corners;
+		std::vector<ObjPartEvent> partEvents;
+		bool hasInvalidIndex = false;
+	};
+
+	//Corners that keep the same triangles together, in file order until they are sorted by material
+	struct ObjSegment
+	{
+		size_t firstCorner;
+		size_t cornerCount;
+		uint32_t materialIndex;
+	};
+
+	inline bool isSpace(char character) noexcept
+	{
+		return character == ' ' || character == '\t' || character == '\r';
+	}
+
+	inline void skipSpaces(const char*& cursor, const char* end) noexcept
+	{
+		while (cursor < end && isSpace(*cursor))
+			cursor++;
+	}
+
+	//Read count floats of a v, vt or vn line, components that are missing are 0
+	void parseFloats(const char*& cursor, const char* lineEnd, std::vector<float>& values, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float value = 0.0f;
+			skipSpaces(cursor, lineEnd);
+			ObjParser::parseFloat(cursor, lineEnd, value);
+			values.push_back(value);
+		}
+	}
+
+	//OBJ indices count from 1, negative ones count back from the last element defined before the face
+	int32_t toIndex(int objIndex, size_t chunkCount, uint8_t relativeFlag, ObjCorner& corner) noexcept
+	{
+		if (objIndex > 0)
+			return objIndex - 1;
+		if (objIndex == 0)
+			return NO_INDEX;
+		corner.relativeMask |= relativeFlag;
+		return static_cast<int32_t>(chunkCount) + objIndex;
+	}
+
+	void parseFace(const char*& cursor, const char* lineEnd, ObjChunk& chunk)
+	{
+		ObjCorner firstCorner = {};
+		ObjCorner previousCorner = {};
+		int cornerCount = 0;
+		while (true)
+		{
+			skipSpaces(cursor, lineEnd);
+			if (cursor >= lineEnd)
+				break;
+			ObjCorner corner = { NO_INDEX, NO_INDEX, NO_INDEX, 0 };
+			int value;
+			if (!ObjParser::parseInt(cursor, lineEnd, value))
+			{
+				chunk.hasInvalidIndex = true;
+				return;
+			}
+			corner.position = toIndex(value, chunk.positions.size() / 3, RELATIVE_POSITION, corner);
+			if (corner.position == NO_INDEX)
+				chunk.hasInvalidIndex = true;
+			if (cursor < lineEnd && *cursor == '/')
+			{
+				cursor++;
+				if (ObjParser::parseInt(cursor, lineEnd, value))
+					corner.uv = toIndex(value, chunk.uvs.size() / 2, RELATIVE_UV, corner);
+				if (cursor < lineEnd && *cursor == '/')
+				{
+					cursor++;
+					if (ObjParser::parseInt(cursor, lineEnd, value))
+						corner.normal = toIndex(value, chunk.normals.size() / 3, RELATIVE_NORMAL, corner);
+				}
+			}
+			//Polygons are fanned around their first corner
+			if (cornerCount == 0)
+				firstCorner = corner;
+			else if (cornerCount >= 2)
+			{
+				chunk.corners.push_back(firstCorner);
+				chunk.corners.push_back(previousCorner);
+				chunk.corners.push_back(corner);
+			}
+			previousCorner = corner;
+			cornerCount++;
+		}
+	}
+
+	void parseChunk(ObjChunk& chunk)
+	{
+		const char* cursor = chunk.begin;
+		while (cursor < chunk.end)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', chunk.end - cursor));
+			if (lineEnd == nullptr)
+				lineEnd = chunk.end;
+			skipSpaces(cursor, lineEnd);
+			const ptrdiff_t lineLength = lineEnd - cursor;
+			if (lineLength >= 2)
+			{
+				if (cursor[0] == 'v' && isSpace(cursor[1]))
+				{
+					cursor += 2;
+					parseFloats(cursor, lineEnd, chunk.positions, 3);
+				}
+				else if (cursor[0] == 'v' && lineLength >= 3 && isSpace(cursor[2]) && (cursor[1] == 't' || cursor[1] == 'n'))
+				{
+					const bool isUV = cursor[1] == 't';
+					cursor += 3;
+					parseFloats(cursor, lineEnd, isUV ? chunk.uvs : chunk.normals, isUV ? 2 : 3);
+				}
+				else if (cursor[0] == 'f' && isSpace(cursor[1]))
+				{
+					cursor += 2;
+					parseFace(cursor, lineEnd, chunk);
+				}
+				else if ((cursor[0] == 'o' || cursor[0] == 'g') && isSpace(cursor[1]))
+					chunk.partEvents.push_back({ chunk.corners.size(), false, std::string() });
+				else if (lineLength >= 7 && std::memcmp(cursor, "usemtl", 6) == 0 && isSpace(cursor[6]))
+				{
+					const char* nameBegin = cursor + 7;
+					skipSpaces(nameBegin, lineEnd);
+					const char* nameEnd = lineEnd;
+					while (nameEnd > nameBegin && isSpace(*(nameEnd - 1)))
+						nameEnd--;
+					chunk.partEvents.push_back({ chunk.corners.size(), true, std::string(nameBegin, nameEnd) });
+				}
+			}
+			cursor = (lineEnd < chunk.end) ? lineEnd + 1 : chunk.end;
+		}
+	}
+
+	//Make the chunk-relative indices absolute and check every index against the element counts of the whole file
+	void resolveChunk(ObjChunk& chunk, size_t positionBase, size_t uvBase, size_t normalBase, size_t positionCount, size_t uvCount, size_t normalCount)
+	{
+		for (ObjCorner& corner : chunk.corners)
+		{
+			if (corner.relativeMask & RELATIVE_POSITION)
+				corner.position += static_cast<int32_t>(positionBase);
+			if (corner.relativeMask & RELATIVE_UV)
+				corner.uv += static_cast<int32_t>(uvBase);
+			if (corner.relativeMask & RELATIVE_NORMAL)
+				corner.normal += static_cast<int32_t>(normalBase);
+			if (corner.position < 0 || static_cast<size_t>(corner.position) >= positionCount ||
+				(corner.uv != NO_INDEX && (corner.uv < 0 || static_cast<size_t>(corner.uv) >= uvCount)) ||
+				(corner.normal != NO_INDEX && (corner.normal < 0 || static_cast<size_t>(corner.normal) >= normalCount)))
+			{
+				chunk.hasInvalidIndex = true;
+				return;
+			}
+		}
+	}
+
+	struct ObjCornerHasher
+	{
+		size_t operator()(const ObjCorner& corner)const noexcept
+		{
+			size_t hash = static_cast<size_t>(static_cast<uint32_t>(corner.position));
+			hash = hash * 0x9E3779B1u ^ static_cast<uint32_t>(corner.uv);
+			return hash * 0x9E3779B1u ^ static_cast<uint32_t>(corner.normal);
+		}
+	};
+
+	struct ObjCornerEqual
+	{
+		bool operator()(const ObjCorner& first, const ObjCorner& second)const noexcept
+		{
+			return first.position == second.position && first.uv == second.uv && first.normal == second.normal;
+		}
+	};
+}
+
+bool ObjParser::parse(const std::string& path, MeshData& meshData, const std::function<bool(float)>& progress)
+{
+	MemoryMappedFile mappedFile;
+	if (!mappedFile.open(path))
+	{
+		std::cout << "\nCould not open OBJ file : " << path;
+		return false;
+	}
+	const char* const fileBegin = reinterpret_cast<const char*>(mappedFile.getData());
+	const char* const fileEnd = fileBegin + mappedFile.getSize();
+
+	//A few chunks per thread so threads that finish early can pick up more work
+	const size_t targetChunkSize = std::max(MIN_CHUNK_SIZE, mappedFile.getSize() / (ParallelUtility::getWorkerCount() * 4) + 1);
+	std::vector<ObjChunk> chunks;
+	for (const char* chunkBegin = fileBegin; chunkBegin < fileEnd;)
+	{
+		const char* chunkEnd = chunkBegin + std::min<size_t>(targetChunkSize, fileEnd - chunkBegin);
+		if (chunkEnd < fileEnd)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(chunkEnd, '\n', fileEnd - chunkEnd));
+			chunkEnd = (lineEnd == nullptr) ? fileEnd : lineEnd + 1;
+		}
+		chunks.emplace_back();
+		chunks.back().begin = chunkBegin;
+		chunks.back().end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	std::atomic<bool> isCancelled(false);
+	std::atomic<size_t> parsedChunkCount(0);
+	ParallelUtility::parallelFor(chunks.size(), [&](size_t index)
+	{
+		if (isCancelled)
+			return;
+		parseChunk(chunks[index]);
+		const float parsedFraction = static_cast<float>(++parsedChunkCount) / static_cast<float>(chunks.size());
+		if (progress && !progress(parsedFraction * CHUNKS_PROGRESS))
+			isCancelled = true;
+	});
+	if (isCancelled)
+		return false;
+
+	//Chunk offsets into the element lists of the whole file
+	std::vector<size_t> positionBases(chunks.size() + 1, 0), uvBases(chunks.size() + 1, 0), normalBases(chunks.size() + 1, 0), cornerBases(chunks.size() + 1, 0);
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		positionBases[i + 1] = positionBases[i] + chunks[i].positions.size() / 3;
+		uvBases[i + 1] = uvBases[i] + chunks[i].uvs.size() / 2;
+		normalBases[i + 1] = normalBases[i] + chunks[i].normals.size() / 3;
+		cornerBases[i + 1] = cornerBases[i] + chunks[i].corners.size();
+	}
+	const size_t positionCount = positionBases.back();
+	const size_t cornerCount = cornerBases.back();
+	if (cornerCount == 0 || positionCount >= static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+	{
+		std::cout << "\nOBJ file has no faces or too many vertices : " << path;
+		return false;
+	}
+	ParallelUtility::parallelFor(chunks.size(), [&](size_t index)
+	{
+		resolveChunk(chunks[index], positionBases[index], uvBases[index], normalBases[index], positionCount, uvBases.back(), normalBases.back());
+	});
+	for (const ObjChunk& chunk : chunks)
+	{
+		if (chunk.hasInvalidIndex)
+		{
+			std::cout << "\nOBJ file has a face with an invalid index : " << path;
+			return false;
+		}
+	}
+
+	std::vector<float> positions, uvs, normals;
+	positions.reserve(positionCount * 3);
+	uvs.reserve(uvBases.back() * 2);
+	normals.reserve(normalBases.back() * 3);
+	std::vector<ObjCorner> corners;
+	corners.reserve(cornerCount);
+	std::vector<ObjSegment> segments;
+	std::unordered_map<std::string, uint32_t> materialIndices;
+	materialIndices[std::string()] = 0;
+	uint32_t currentMaterial = 0;
+	size_t segmentStart = 0;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		ObjChunk& chunk = chunks[i];
+		for (const ObjPartEvent& partEvent : chunk.partEvents)
+		{
+			const size_t eventCorner = cornerBases[i] + partEvent.cornerIndex;
+			if (eventCorner > segmentStart)
+				segments.push_back({ segmentStart, eventCorner - segmentStart, currentMaterial });
+			segmentStart = eventCorner;
+			if (partEvent.isMaterial)
+				currentMaterial = materialIndices.emplace(partEvent.materialName, static_cast<uint32_t>(materialIndices.size())).first->second;
+		}
+		positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+		uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+		normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+		corners.insert(corners.end(), chunk.corners.begin(), chunk.corners.end());
+		//Chunk data is no longer needed, freeing it as we go keeps the peak memory down on huge files
+		chunk = ObjChunk();
+	}
+	if (cornerCount > segmentStart)
+		segments.push_back({ segmentStart, cornerCount - segmentStart, currentMaterial });
+	std::stable_sort(segments.begin(), segments.end(), [](const ObjSegment& first, const ObjSegment& second)
+	{
+		return first.materialIndex < second.materialIndex;
+	});
+
+	//Corners become vertices, most positions are used with a single uv and normal so only the exceptions go through the map
+	std::vector<uint32_t> firstVertexOfPosition(positionCount, UNUSED_VERTEX);
+	std::unordered_map<ObjCorner, uint32_t, ObjCornerHasher, ObjCornerEqual> extraVertices;
+	std::vector<ObjCorner> vertexCorners;
+	vertexCorners.reserve(positionCount);
+	meshData.indices.clear();
+	meshData.indices.reserve(cornerCount);
+	meshData.parts.clear();
+	auto getVertex = [&](const ObjCorner& corner)
+	{
+		uint32_t& firstVertex = firstVertexOfPosition[corner.position];
+		if (firstVertex == UNUSED_VERTEX)
+		{
+			firstVertex = static_cast<uint32_t>(vertexCorners.size());
+			vertexCorners.push_back(corner);
+			return firstVertex;
+		}
+		if (ObjCornerEqual()(vertexCorners[firstVertex], corner))
+			return firstVertex;
+		const auto insertResult = extraVertices.emplace(corner, static_cast<uint32_t>(vertexCorners.size()));
+		if (insertResult.second)
+			vertexCorners.push_back(corner);
+		return insertResult.first->second;
+	};
+	for (const ObjSegment& segment : segments)
+	{
+		MeshPart part = {};
+		part.firstIndex = static_cast<uint32_t>(meshData.indices.size());
+		part.indexCount = static_cast<uint32_t>(segment.cornerCount);
+		part.materialIndex = segment.materialIndex;
+		meshData.parts.push_back(part);
+		for (size_t i = segment.firstCorner; i < segment.firstCorner + segment.cornerCount; i++)
+			meshData.indices.push_back(getVertex(corners[i]));
+	}
+	corners = std::vector<ObjCorner>();
+	if (progress && !progress(CHUNKS_PROGRESS + (1.0f - CHUNKS_PROGRESS) * 0.5f))
+		return false;
+
+	//Normals the file does not have are smoothed over every triangle touching the position
+	const bool hasMissingNormals = std::any_of(vertexCorners.begin(), vertexCorners.end(), [](const ObjCorner& corner) { return corner.normal == NO_INDEX; });
+	std::vector<glm::vec3> smoothNormals;
+	if (hasMissingNormals)
+	{
+		smoothNormals.assign(positionCount, glm::vec3(0.0f));
+		for (size_t i = 0; i < meshData.indices.size(); i += 3)
+		{
+			const int32_t cornerPositions[3] = { vertexCorners[meshData.indices[i]].position, vertexCorners[meshData.indices[i + 1]].position,
+				vertexCorners[meshData.indices[i + 2]].position };
+			const glm::vec3 a(positions[cornerPositions[0] * 3], positions[cornerPositions[0] * 3 + 1], positions[cornerPositions[0] * 3 + 2]);
+			const glm::vec3 b(positions[cornerPositions[1] * 3], positions[cornerPositions[1] * 3 + 1], positions[cornerPositions[1] * 3 + 2]);
+			const glm::vec3 c(positions[cornerPositions[2] * 3], positions[cornerPositions[2] * 3 + 1], positions[cornerPositions[2] * 3 + 2]);
+			//Not normalized so larger triangles weigh more
+			const glm::vec3 faceNormal = glm::cross(b - a, c - a);
+			for (const int32_t position : cornerPositions)
+				smoothNormals[position] += faceNormal;
+		}
+	}
+
+	const size_t vertexCount = vertexCorners.size();
+	meshData.vertices.assign(vertexCount * MeshData::FLOATS_PER_VERTEX, 0.0f);
+	ParallelUtility::parallelFor((vertexCount + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE, [&](size_t block)
+	{
+		const size_t blockEnd = std::min(vertexCount, (block + 1) * VERTEX_BLOCK_SIZE);
+		for (size_t i = block * VERTEX_BLOCK_SIZE; i < blockEnd; i++)
+		{
+			const ObjCorner& corner = vertexCorners[i];
+			float* const vertex = &meshData.vertices[i * MeshData::FLOATS_PER_VERTEX];
+			std::memcpy(vertex, &positions[static_cast<size_t>(corner.position) * 3], 3 * sizeof(float));
+			glm::vec3 normal(0.0f, 1.0f, 0.0f);
+			if (corner.normal != NO_INDEX)
+				normal = glm::vec3(normals[corner.normal * 3], normals[corner.normal * 3 + 1], normals[corner.normal * 3 + 2]);
+			else if (glm::length(smoothNormals[corner.position]) > 0.0f)
+				normal = smoothNormals[corner.position];
+			if (glm::length(normal) > 0.0f)
+				normal = glm::normalize(normal);
+			vertex[3] = normal.x;
+			vertex[4] = normal.y;
+			vertex[5] = normal.z;
+			//V is flipped to match the aiProcess_FlipUVs imports
+			if (corner.uv != NO_INDEX)
+			{
+				vertex[6] = uvs[corner.uv * 2];
+				vertex[7] = 1.0f - uvs[corner.uv * 2 + 1];
+			}
+		}
+	});
+
+	//Tangent and bitangent follow the UV derivatives of every triangle touching the vertex
+	for (size_t i = 0; i < meshData.indices.size(); i += 3)
+	{
+		float* const corner0 = &meshData.vertices[static_cast<size_t>(meshData.indices[i]) * MeshData::FLOATS_PER_VERTEX];
+		float* const corner1 = &meshData.vertices[static_cast<size_t>(meshData.indices[i + 1]) * MeshData::FLOATS_PER_VERTEX];
+		float* const corner2 = &meshData.vertices[static_cast<size_t>(meshData.indices[i + 2]) * MeshData::FLOATS_PER_VERTEX];
+		const glm::vec3 edge1 = glm::vec3(corner1[0], corner1[1], corner1[2]) - glm::vec3(corner0[0], corner0[1], corner0[2]);
+		const glm::vec3 edge2 = glm::vec3(corner2[0], corner2[1], corner2[2]) - glm::vec3(corner0[0], corner0[1], corner0[2]);
+		const glm::vec2 deltaUV1 = glm::vec2(corner1[6], corner1[7]) - glm::vec2(corner0[6], corner0[7]);
+		const glm::vec2 deltaUV2 = glm::vec2(corner2[6], corner2[7]) - glm::vec2(corner0[6], corner0[7]);
+		const float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+		if (determinant == 0.0f)
+			continue;
+		const glm::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) / determinant;
+		//Negated as the UVs were flipped above, Assimp computes the basis it stores before aiProcess_FlipUVs
+		const glm::vec3 bitangent = (edge1 * deltaUV2.x - edge2 * deltaUV1.x) / determinant;
+		for (float* const corner : { corner0, corner1, corner2 })
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				corner[8 + axis] += tangent[axis];
+				corner[11 + axis] += bitangent[axis];
+			}
+		}
+	}
+	ParallelUtility::parallelFor((vertexCount + VERTEX_BLOCK_SIZE - 1) / VERTEX_BLOCK_SIZE, [&](size_t block)
+	{
+		const size_t blockEnd = std::min(vertexCount, (block + 1) * VERTEX_BLOCK_SIZE);
+		for (size_t i = block * VERTEX_BLOCK_SIZE; i < blockEnd; i++)
+		{
+			//Degenerate tangents are left at 0 for VertexPacking to repair
+			float* const vertex = &meshData.vertices[i * MeshData::FLOATS_PER_VERTEX];
+			for (int offset : { 8, 11 })
+			{
+				const float length = std::sqrt(vertex[offset] * vertex[offset] + vertex[offset + 1] * vertex[offset + 1] + vertex[offset + 2] * vertex[offset + 2]);
+				if (length > 0.0f)
+				{
+					for (int axis = 0; axis < 3; axis++)
+						vertex[offset + axis] /= length;
+				}
+			}
+		}
+	});
+	return !progress || progress(1.0f);
+}
+
+bool ObjParser::parseFloat(const char*& cursor, const char* end, float& value) noexcept
+{
+	//Powers of ten that are exact in a double
+	static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+		1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	const char* position = cursor;
+	bool isNegative = false;
+	if (position < end && (*position == '-' || *position == '+'))
+		isNegative = *position++ == '-';
+
+	//Digits past the 19th do not fit the mantissa, they only move the decimal point
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digitCount = 0;
+	int significantDigitCount = 0;
+	for (; position < end && *position >= '0' && *position <= '9'; position++, digitCount++)
+	{
+		if (significantDigitCount < 19)
+		{
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*position - '0');
+			significantDigitCount += (mantissa != 0) ? 1 : 0;
+		}
+		else
+			exponent++;
+	}
+	if (position < end && *position == '.')
+	{
+		for (position++; position < end && *position >= '0' && *position <= '9'; position++, digitCount++)
+		{
+			if (significantDigitCount < 19)
+			{
+				mantissa = mantissa * 10 + static_cast<uint64_t>(*position - '0');
+				significantDigitCount += (mantissa != 0) ? 1 : 0;
+				exponent--;
+			}
+		}
+	}
+	if (digitCount == 0)
+		return false;
+	if (position < end && (*position == 'e' || *position == 'E'))
+	{
+		const char* exponentPosition = position + 1;
+		int exponentValue;
+		if (parseInt(exponentPosition, end, exponentValue))
+		{
+			exponent += exponentValue;
+			position = exponentPosition;
+		}
+	}
+
+	double result = static_cast<double>(mantissa);
+	if (exponent != 0 && mantissa != 0)
+	{
+		const int absoluteExponent = std::abs(exponent);
+		const double scale = (absoluteExponent <= 22) ? POWERS_OF_TEN[absoluteExponent] : std::pow(10.0, absoluteExponent);
+		result = (exponent < 0) ? result / scale : result * scale;
+	}
+	value = static_cast<float>(isNegative ? -result : result);
+	cursor = position;
+	return true;
+}
+
+bool ObjParser::parseInt(const char*& cursor, const char* end, int& value) noexcept
+{
+	const char* position = cursor;
+	bool isNegative = false;
+	if (position < end && (*position == '-' || *position == '+'))
+		isNegative = *position++ == '-';
+	if (position >= end || *position < '0' || *position > '9')
+		return false;
+	int64_t result = 0;
+	for (; position < end && *position >= '0' && *position <= '9'; position++)
+	{
+		if (result <= std::numeric_limits<int32_t>::max())
+			result = result * 10 + (*position - '0');
+	}
+	result = std::min<int64_t>(result, std::numeric_limits<int32_t>::max());
+	value = static_cast<int>(isNegative ? -result : result);
+	cursor = position;
+	return true;
+}
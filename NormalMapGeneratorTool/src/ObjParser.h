@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <functional>
+#include "MeshData.h"
+/*
+Wavefront .obj reader for large files that bypasses Assimp
+The file is memory mapped and cut into chunks at line boundaries, the chunks are parsed in parallel and then stitched
+into the MeshData layout MeshLoader produces. Reads v, vt, vn, f (polygons are fanned into triangles), o, g and usemtl,
+a new part starts at every o, g and usemtl line. Everything else is skipped, materials are only told apart by name
+Normals missing from the file are smoothed per position, tangents are accumulated from the UV derivatives
+*/
+class ObjParser
+{
+public:
+	//.obj files this size and up are read by ObjParser, smaller ones are left to Assimp which reads every feature
+	static const size_t LARGE_FILE_SIZE = 16 * 1024 * 1024;
+	ObjParser() = delete;
+	//progress is called with the fraction parsed and the parse is abandoned when it returns false
+	//Vertex positions are left unscaled
+	static bool parse(const std::string& path, MeshData& meshData, const std::function<bool(float)>& progress = nullptr);
+	//Parse a float at cursor in the usual decimal and exponent notation, cursor is moved past it
+	//Returns false and leaves cursor where it was if there is no number
+	static bool parseFloat(const char*& cursor, const char* end, float& value) noexcept;
+	static bool parseInt(const char*& cursor, const char* end, int& value) noexcept;
+};
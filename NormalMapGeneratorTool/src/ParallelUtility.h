@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <algorithm>
+//Helpers for splitting CPU heavy work over the available hardware threads
+class ParallelUtility
+{
+public:
+	ParallelUtility() = delete;
+	//Number of threads worth running work on, at least 1
+	static unsigned int getWorkerCount() noexcept
+	{
+		const unsigned int hardwareThreadCount = std::thread::hardware_concurrency();
+		return (hardwareThreadCount == 0) ? 1 : hardwareThreadCount;
+	}
+	//Call func(index) for every index in [0, count), indices are handed out to the workers one at a time
+	//The calling thread takes part in the work and the call returns once every index is done
+	static void parallelFor(size_t count, const std::function<void(size_t)>& func)
+	{
+		if (count == 0)
+			return;
+		const size_t workerCount = std::min<size_t>(getWorkerCount(), count);
+		std::atomic<size_t> nextIndex(0);
+		auto worker = [&]()
+		{
+			for (size_t index = nextIndex++; index < count; index = nextIndex++)
+				func(index);
+		};
+		std::vector<std::thread> threads;
+		threads.reserve(workerCount - 1);
+		for (size_t i = 1; i < workerCount; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+};
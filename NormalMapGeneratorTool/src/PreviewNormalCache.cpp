@@ -0,0 +1,73 @@
+#include "PreviewNormalCache.h"
+#include <iostream>
+#include <GL\glew.h>
+#include "GLutil.h"
+
+bool PreviewNormalBakeKey::operator==(const PreviewNormalBakeKey& other) const noexcept
+{
+	return heightmapVersion == other.heightmapVersion && resolution == other.resolution && methodIndex == other.methodIndex &&
+		heightmapStrength == other.heightmapStrength && flipXYdir == other.flipXYdir;
+}
+
+void PreviewNormalCache::init()
+{
+	glGenFramebuffers(1, &framebuffer);
+	glGenTextures(1, &texture);
+	GL::bindTexture(TextureType::TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GL::bindTexture(TextureType::TEXTURE_2D, 0);
+	hasBake = false;
+}
+
+bool PreviewNormalCache::isOutdated(const PreviewNormalBakeKey& key) const noexcept
+{
+	return !hasBake || !(bakedKey == key);
+}
+
+void PreviewNormalCache::beginBake(const PreviewNormalBakeKey& key)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	if (textureResolution != key.resolution)
+	{
+		textureResolution = key.resolution;
+		GL::bindTexture(TextureType::TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, textureResolution.x, textureResolution.y, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "\nPreview normal framebuffer is not complete";
+	}
+	GL::setViewport(glm::ivec2(0), textureResolution);
+}
+
+void PreviewNormalCache::endBake(const PreviewNormalBakeKey& key)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GL::bindTexture(TextureType::TEXTURE_2D, texture);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	bakedKey = key;
+	hasBake = true;
+}
+
+unsigned int PreviewNormalCache::getTexture() const noexcept
+{
+	return texture;
+}
+
+void PreviewNormalCache::destroy()
+{
+	if (texture != 0)
+		GL::deleteTexture(texture);
+	if (framebuffer != 0)
+		glDeleteFramebuffers(1, &framebuffer);
+	texture = 0;
+	framebuffer = 0;
+	textureResolution = glm::ivec2(0);
+	hasBake = false;
+}
+
+PreviewNormalCache::~PreviewNormalCache()
+{
+}
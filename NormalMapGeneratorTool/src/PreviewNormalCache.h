@@ -0,0 +1,41 @@
+#pragma once
+#include <GLM\common.hpp>
+//Settings a baked normal texture was derived with, the bake is reused for as long as they stay the same
+struct PreviewNormalBakeKey
+{
+	unsigned int heightmapVersion = 0;
+	glm::ivec2 resolution = glm::ivec2(0);
+	int methodIndex = 0;
+	float heightmapStrength = 0.0f;
+	bool flipXYdir = false;
+	bool operator==(const PreviewNormalBakeKey& other)const noexcept;
+};
+
+/*
+Normal texture derived from the heightmap for the 3D preview
+The normals are drawn once at heightmap resolution and mipmapped, the preview samples them instead of deriving
+them from neighbouring heightmap texels for every fragment
+*/
+class PreviewNormalCache
+{
+private:
+	unsigned int framebuffer = 0;
+	unsigned int texture = 0;
+	glm::ivec2 textureResolution = glm::ivec2(0);
+	PreviewNormalBakeKey bakedKey;
+	bool hasBake = false;
+public:
+	PreviewNormalCache() = default;
+	PreviewNormalCache(const PreviewNormalCache&) = delete;
+	PreviewNormalCache& operator=(const PreviewNormalCache&) = delete;
+	void init();
+	//True if the cached normals were not baked with key
+	bool isOutdated(const PreviewNormalBakeKey& key)const noexcept;
+	//Bind the bake target at the resolution of key and set the viewport to cover it
+	void beginBake(const PreviewNormalBakeKey& key);
+	//Generate the mipmaps of the freshly drawn normals and remember what they were baked with
+	void endBake(const PreviewNormalBakeKey& key);
+	unsigned int getTexture()const noexcept;
+	void destroy();
+	~PreviewNormalCache();
+};
@@ -0,0 +1,40 @@
+#include "PreviewResolution.h"
+
+void PreviewResolution::setDisplaySize(const glm::vec2& size) noexcept
+{
+	displaySize = glm::max(glm::ivec2(glm::ceil(size)), glm::ivec2(1));
+}
+
+void PreviewResolution::onInteraction(double time) noexcept
+{
+	lastInteractionTime = time;
+}
+
+bool PreviewResolution::isInteracting(double time) const noexcept
+{
+	return time - lastInteractionTime < REFINE_DELAY_SECONDS;
+}
+
+glm::ivec2 PreviewResolution::getRenderSize(double time, const glm::ivec2& textureSize) const noexcept
+{
+	glm::vec2 size = displaySize;
+	if (isInteracting(time))
+		size *= INTERACTION_SCALE;
+	return glm::clamp(glm::ivec2(size), glm::ivec2(1), glm::max(textureSize, glm::ivec2(1)));
+}
+
+bool PreviewResolution::isOutdated(double time, const glm::ivec2& textureSize) const noexcept
+{
+	return getRenderSize(time, textureSize) != renderedSize;
+}
+
+void PreviewResolution::setRenderedSize(const glm::ivec2& size, const glm::ivec2& textureSize) noexcept
+{
+	renderedSize = size;
+	renderedUV = glm::vec2(size) / glm::vec2(glm::max(textureSize, glm::ivec2(1)));
+}
+
+glm::vec2 PreviewResolution::getRenderedUV() const noexcept
+{
+	return renderedUV;
+}
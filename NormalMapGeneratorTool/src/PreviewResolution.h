@@ -0,0 +1,32 @@
+#pragma once
+#include <GLM\common.hpp>
+/*
+Chooses the resolution the 3D preview is rendered at
+The preview is sized to the image it is shown in rather than to the window. While the camera is orbited or zoomed it
+drops to a reduced scale and goes back to full scale once the input has been idle for REFINE_DELAY_SECONDS
+*/
+class PreviewResolution
+{
+private:
+	static constexpr float INTERACTION_SCALE = 0.5f;
+	static constexpr double REFINE_DELAY_SECONDS = 0.2;
+	glm::ivec2 displaySize = glm::ivec2(300, 300);
+	glm::ivec2 renderedSize = glm::ivec2(0);
+	glm::vec2 renderedUV = glm::vec2(1.0f);
+	double lastInteractionTime = -1.0e9;
+public:
+	//Size of the image the preview is shown in, in pixels
+	void setDisplaySize(const glm::vec2& size) noexcept;
+	//Camera input happened at time, the next frames are rendered at the reduced scale
+	void onInteraction(double time) noexcept;
+	//True until the input has been idle for REFINE_DELAY_SECONDS
+	bool isInteracting(double time)const noexcept;
+	//Resolution to render at, limited to the size of the target texture
+	glm::ivec2 getRenderSize(double time, const glm::ivec2& textureSize)const noexcept;
+	//True if the last rendered frame does not match the resolution wanted now
+	bool isOutdated(double time, const glm::ivec2& textureSize)const noexcept;
+	//Remember the part of the target texture the last frame was rendered into
+	void setRenderedSize(const glm::ivec2& size, const glm::ivec2& textureSize) noexcept;
+	//Texture coordinate of the top right corner of the rendered part of the target
+	glm::vec2 getRenderedUV()const noexcept;
+};
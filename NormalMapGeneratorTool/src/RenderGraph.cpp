@@ -0,0 +1,133 @@
+#include "RenderGraph.h"
+#include <GL\glew.h>
+#include <chrono>
+
+void RenderGraph::init()
+{
+	isTimerQuerySupported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+}
+
+void RenderGraph::beginFrame()
+{
+	passes.clear();
+	consumedResources.clear();
+	upToDateResources.clear();
+}
+
+void RenderGraph::addPass(const std::string& name, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs,
+	const std::function<void()>& execute)
+{
+	Pass pass;
+	pass.name = name;
+	pass.inputs = inputs;
+	pass.outputs = outputs;
+	pass.execute = execute;
+	passes.push_back(std::move(pass));
+}
+
+void RenderGraph::consume(const std::string& resource)
+{
+	consumedResources.insert(resource);
+}
+
+void RenderGraph::markUpToDate(const std::string& resource)
+{
+	upToDateResources.insert(resource);
+}
+
+void RenderGraph::execute()
+{
+	readFinishedQueries();
+
+	//Passes are added in execution order, so every writer of a resource a pass reads comes before it
+	std::vector<bool> isPassNeeded(passes.size(), false);
+	std::unordered_set<std::string> neededResources(consumedResources);
+	for (int i = static_cast<int>(passes.size()) - 1; i >= 0; i--)
+	{
+		for (const std::string& output : passes[i].outputs)
+		{
+			if (neededResources.count(output) != 0)
+			{
+				isPassNeeded[i] = true;
+				break;
+			}
+		}
+		if (!isPassNeeded[i])
+			continue;
+		for (const std::string& input : passes[i].inputs)
+		{
+			if (upToDateResources.count(input) == 0)
+				neededResources.insert(input);
+		}
+	}
+
+	timings.clear();
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		PassTimer& timer = passTimers[passes[i].name];
+		if (isPassNeeded[i])
+		{
+			//A query still in flight is not reused, the pass goes untimed on the GPU until its result arrives
+			const bool shouldTimeGpu = isTimerQuerySupported && !timer.isQueryPending;
+			if (shouldTimeGpu)
+			{
+				if (timer.queryId == 0)
+					glGenQueries(1, &timer.queryId);
+				glBeginQuery(GL_TIME_ELAPSED, timer.queryId);
+			}
+			const auto startTime = std::chrono::steady_clock::now();
+			passes[i].execute();
+			timer.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			if (shouldTimeGpu)
+			{
+				glEndQuery(GL_TIME_ELAPSED);
+				timer.isQueryPending = true;
+			}
+		}
+		RenderPassTiming timing;
+		timing.name = passes[i].name;
+		timing.wasExecuted = isPassNeeded[i];
+		timing.cpuMs = timer.cpuMs;
+		timing.gpuMs = timer.gpuMs;
+		timings.push_back(timing);
+	}
+}
+
+const std::vector<RenderPassTiming>& RenderGraph::getTimings() const noexcept
+{
+	return timings;
+}
+
+void RenderGraph::destroy()
+{
+	for (auto& passTimer : passTimers)
+	{
+		if (passTimer.second.queryId != 0)
+			glDeleteQueries(1, &passTimer.second.queryId);
+	}
+	passTimers.clear();
+	passes.clear();
+	timings.clear();
+}
+
+RenderGraph::~RenderGraph()
+{
+}
+
+void RenderGraph::readFinishedQueries()
+{
+	for (auto& passTimer : passTimers)
+	{
+		PassTimer& timer = passTimer.second;
+		if (!timer.isQueryPending)
+			continue;
+		GLint isAvailable = GL_FALSE;
+		glGetQueryObjectiv(timer.queryId, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+		if (isAvailable == GL_FALSE)
+			continue;
+		GLuint64 elapsedNs = 0;
+		glGetQueryObjectui64v(timer.queryId, GL_QUERY_RESULT, &elapsedNs);
+		timer.gpuMs = static_cast<double>(elapsedNs) / 1000000.0;
+		timer.isQueryPending = false;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+//Time spent in a pass the last time it ran
+struct RenderPassTiming
+{
+	std::string name;
+	bool wasExecuted = false;
+	double cpuMs = 0.0;
+	//Negative until the GPU has reported a result, stays negative if timer queries are not supported
+	double gpuMs = -1.0;
+};
+
+/*
+Declarative description of the passes drawn in a frame
+Passes are added every frame in execution order together with the resources they read and write. Resources read
+outside of the graph (by the UI or when saving) are marked with consume(). execute() walks the passes backwards from
+the consumed resources and only runs the passes that contribute to one of them. Resources kept from an earlier frame
+are marked with markUpToDate() so reading them does not run their writers again
+*/
+class RenderGraph
+{
+private:
+	struct Pass
+	{
+		std::string name;
+		std::vector<std::string> inputs;
+		std::vector<std::string> outputs;
+		std::function<void()> execute;
+	};
+	struct PassTimer
+	{
+		unsigned int queryId = 0;
+		bool isQueryPending = false;
+		double cpuMs = 0.0;
+		double gpuMs = -1.0;
+	};
+	std::vector<Pass> passes;
+	std::unordered_set<std::string> consumedResources;
+	std::unordered_set<std::string> upToDateResources;
+	std::unordered_map<std::string, PassTimer> passTimers;
+	std::vector<RenderPassTiming> timings;
+	bool isTimerQuerySupported = false;
+public:
+	RenderGraph() = default;
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+	//Has to be called after the GL context is created
+	void init();
+	//Drop the passes and consumed resources of the previous frame
+	void beginFrame();
+	//A pass that reads and writes the same resource draws on top of it, so the passes writing it before are kept
+	void addPass(const std::string& name, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs,
+		const std::function<void()>& execute);
+	//Mark a resource as used outside of the graph this frame
+	void consume(const std::string& resource);
+	//Mark a resource whose content from an earlier frame can be read as is
+	void markUpToDate(const std::string& resource);
+	//Cull the passes that nothing consumes and run the rest in the order they were added
+	void execute();
+	//Timings of the passes added this frame, culled passes keep the timing of their last run
+	const std::vector<RenderPassTiming>& getTimings()const noexcept;
+	void destroy();
+	~RenderGraph();
+private:
+	void readFinishedQueries();
+};
@@ -2,7 +2,14 @@
 #include <GL\glew.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
+#include <cstring>
+#include <filesystem>
+#include "HashUtility.h"
+#include "GLutil.h"
+
+std::string ShaderProgram::cacheDirectory;
 
 ShaderProgram::ShaderProgram()
 {
@@ -17,50 +24,82 @@ ShaderProgram::~ShaderProgram()
 {
 }
 
+void ShaderProgram::setCacheDirectory(const std::string& directory)
+{
+	cacheDirectory = directory;
+	if (!cacheDirectory.empty())
+	{
+		std::error_code errorCode;
+		std::filesystem::create_directories(cacheDirectory, errorCode);
+	}
+}
+
+void ShaderProgram::setDefine(const std::string& name, int value)
+{
+	defines += "#define " + name + " " + std::to_string(value) + "\n";
+}
+
 void ShaderProgram::compileShaders(const std::string & vertexShaderPath, const std::string & fragmentShaderPath)
 {
 	programID = glCreateProgram();
-	vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	if (vertexShaderID == 0)
-		std::cout << "ERROR : Vertex shader creation";
-	fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-	if (fragmentShaderID == 0)
-		std::cout << "ERROR : Fragment shader creation";
-	compileShader(vertexShaderPath, vertexShaderID);
-	compileShader(fragmentShaderPath, fragmentShaderID);
+	uniformLocations.clear();
+	attributeNames.clear();
+	attributeCount = 0;
+	this->vertexShaderPath = vertexShaderPath;
+	this->fragmentShaderPath = fragmentShaderPath;
+	geometryShaderPath.clear();
+	readShaderSource(vertexShaderPath, vertexShaderSource);
+	readShaderSource(fragmentShaderPath, fragmentShaderSource);
+	insertDefines(vertexShaderSource);
+	insertDefines(fragmentShaderSource);
+	geometryShaderSource.clear();
 }
 
 void ShaderProgram::compileShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& geometryShaderPath)
 {
-	programID = glCreateProgram();
+	compileShaders(vertexShaderPath, fragmentShaderPath);
+	this->geometryShaderPath = geometryShaderPath;
+	readShaderSource(geometryShaderPath, geometryShaderSource);
+	insertDefines(geometryShaderSource);
+}
+
+void ShaderProgram::linkShaders()
+{
+	const uint64_t cacheKey = getCacheKey();
+	if (loadProgramBinary(cacheKey))
+	{
+		std::cout << "\nLoaded from cache : " << vertexShaderPath;
+		return;
+	}
+
 	vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
 	if (vertexShaderID == 0)
 		std::cout << "ERROR : Vertex shader creation";
 	fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
 	if (fragmentShaderID == 0)
 		std::cout << "ERROR : Fragment shader creation";
-	geometryShaderID = glCreateShader(GL_GEOMETRY_SHADER);
-	if (geometryShaderID == 0)
-		std::cout << "ERROR : Geometry shader creation";
-
-	compileShader(vertexShaderPath, vertexShaderID);
-	compileShader(fragmentShaderPath, fragmentShaderID);
-	compileShader(geometryShaderPath, geometryShaderID);
-}
+	compileShader(vertexShaderPath, vertexShaderSource, vertexShaderID);
+	compileShader(fragmentShaderPath, fragmentShaderSource, fragmentShaderID);
+	if (!geometryShaderPath.empty())
+	{
+		geometryShaderID = glCreateShader(GL_GEOMETRY_SHADER);
+		if (geometryShaderID == 0)
+			std::cout << "ERROR : Geometry shader creation";
+		compileShader(geometryShaderPath, geometryShaderSource, geometryShaderID);
+	}
 
-void ShaderProgram::linkShaders()
-{
 	glAttachShader(programID, vertexShaderID);
 	glAttachShader(programID, fragmentShaderID);
 	if (geometryShaderID != 0)
 		glAttachShader(programID, geometryShaderID);
 
+	if (!cacheDirectory.empty() && GLEW_ARB_get_program_binary)
+		glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(programID);
 	GLint isLinked = 0;
 	glGetProgramiv(programID, GL_LINK_STATUS, &isLinked);
 	if (isLinked == GL_FALSE)
 	{
-		GLint maxLength = 0;
 		glGetProgramiv(programID, GL_INFO_LOG_LENGTH, (int *)&isLinked);
 		GLchar infoLog[1024]; //std::vector<char> infoLog(2000);
 		glGetProgramInfoLog(programID, 1024, NULL, &infoLog[0]);
@@ -75,6 +114,7 @@ void ShaderProgram::linkShaders()
 	else
 	{
 		std::cout << "\nLinked successfully";
+		saveProgramBinary(cacheKey);
 	}
 
 	glDetachShader(programID, vertexShaderID);
@@ -91,30 +131,36 @@ void ShaderProgram::linkShaders()
 
 void ShaderProgram::addAttribute(const std::string & attributeName)
 {
+	attributeNames.push_back(attributeName);
 	glBindAttribLocation(programID, attributeCount++, attributeName.c_str());
 }
 
+void ShaderProgram::bindUniformBlock(const std::string& blockName, UniformBlockBinding binding)
+{
+	const GLuint blockIndex = glGetUniformBlockIndex(programID, blockName.c_str());
+	if (blockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(programID, blockIndex, static_cast<GLuint>(binding));
+}
+
 void ShaderProgram::use()
 {
-	glUseProgram(programID);
-	for (int i = 0; i < attributeCount; i++)
-	{
-		glEnableVertexAttribArray(i);
-	}
+	//Attribute arrays are enabled once in the vertex array objects of the meshes, they do not depend on the program
+	GL::useProgram(programID);
 }
 
 void ShaderProgram::unuse()
 {
-	glUseProgram(0);
-	for (int i = 0; i < attributeCount; i++)
-	{
-		glDisableVertexAttribArray(i);
-	}
+	GL::useProgram(0);
 }
 
 GLint ShaderProgram::getUniformLocation(const std::string & uniformName)const
 {
-	return glGetUniformLocation(programID, uniformName.c_str());
+	auto locationIt = uniformLocations.find(uniformName);
+	if (locationIt != uniformLocations.end())
+		return locationIt->second;
+	const GLint location = glGetUniformLocation(programID, uniformName.c_str());
+	uniformLocations.emplace(uniformName, location);
+	return location;
 }
 
 void ShaderProgram::applyShaderUniformMatrix(int uniformId, const glm::mat4& matrixValue)
@@ -142,23 +188,9 @@ void ShaderProgram::applyShaderBool(int uniformId, bool value)
 	glUniform1i(uniformId, value);
 }
 
-void ShaderProgram::compileShader(const std::string & filePath, unsigned int ID)
+void ShaderProgram::compileShader(const std::string & filePath, const std::string& source, unsigned int ID)
 {
-	std::ifstream shaderFile(filePath);
-	if (shaderFile.fail())
-	{
-		perror(filePath.c_str());
-		std::cout << "ERROR : file : " << filePath << " couldnt be loaded";
-		return;
-	}
-	std::string fileContents = "";
-	std::string line;
-	while (std::getline(shaderFile, line))
-	{
-		fileContents += line + "\n";
-	}
-	shaderFile.close();
-	const char* charPointer = fileContents.c_str();
+	const char* charPointer = source.c_str();
 	glShaderSource(ID, 1, &charPointer, nullptr);
 	glCompileShader(ID);
 
@@ -183,3 +215,114 @@ void ShaderProgram::compileShader(const std::string & filePath, unsigned int ID)
 		std::cout << "Compiled Correctly : " << filePath;
 	}
 }
+
+bool ShaderProgram::readShaderSource(const std::string& filePath, std::string& source)
+{
+	std::ifstream shaderFile(filePath, std::ios::binary);
+	if (shaderFile.fail())
+	{
+		perror(filePath.c_str());
+		std::cout << "ERROR : file : " << filePath << " couldnt be loaded";
+		source.clear();
+		return false;
+	}
+	std::ostringstream contents;
+	contents << shaderFile.rdbuf();
+	source = contents.str();
+	return true;
+}
+
+void ShaderProgram::insertDefines(std::string& source) const
+{
+	if (defines.empty() || source.empty())
+		return;
+	//GLSL only allows comments and whitespace before #version, so the defines go on the line after it
+	size_t insertPosition = 0;
+	const size_t versionPosition = source.find("#version");
+	if (versionPosition != std::string::npos)
+	{
+		const size_t lineEnd = source.find('\n', versionPosition);
+		insertPosition = (lineEnd == std::string::npos) ? source.size() : lineEnd + 1;
+		if (lineEnd == std::string::npos)
+			source += '\n';
+	}
+	source.insert(insertPosition, defines);
+}
+
+uint64_t ShaderProgram::getCacheKey() const
+{
+	uint64_t key = HashUtility::fnv1a64(vertexShaderSource);
+	key = HashUtility::fnv1a64(fragmentShaderSource, key);
+	key = HashUtility::fnv1a64(geometryShaderSource, key);
+	//Attribute locations are fixed when linking, a binary linked with other bindings must not be reused
+	for (size_t location = 0; location < attributeNames.size(); location++)
+	{
+		key = HashUtility::fnv1a64(&location, sizeof(location), key);
+		key = HashUtility::fnv1a64(attributeNames[location], key);
+	}
+	//Binaries are only valid for the driver that produced them
+	const GLenum driverStrings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (const GLenum driverString : driverStrings)
+	{
+		const GLubyte* value = glGetString(driverString);
+		if (value != nullptr)
+			key = HashUtility::fnv1a64(std::string(reinterpret_cast<const char*>(value)), key);
+	}
+	return key;
+}
+
+std::string ShaderProgram::getCachePath(uint64_t key) const
+{
+	return cacheDirectory + HashUtility::toHexString(key) + ".nshader";
+}
+
+bool ShaderProgram::loadProgramBinary(uint64_t key)
+{
+	if (cacheDirectory.empty() || !GLEW_ARB_get_program_binary)
+		return false;
+	std::ifstream file(getCachePath(key), std::ios::binary);
+	if (!file)
+		return false;
+	ProgramBinaryHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(ProgramBinaryHeader)) || std::memcmp(header.magic, "NSPB", 4) != 0 || header.key != key)
+		return false;
+	std::vector<char> binary(header.binaryLength);
+	if (!file.read(binary.data(), binary.size()) || HashUtility::crc32(binary.data(), binary.size()) != header.checksum)
+		return false;
+
+	glProgramBinary(programID, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+	GLint isLinked = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &isLinked);
+	if (isLinked == GL_FALSE)
+	{
+		//Usually a driver update that kept the version string, the program is compiled from source and the cache rewritten
+		std::cout << "\nCached program binary was rejected : " << getCachePath(key);
+		return false;
+	}
+	return true;
+}
+
+void ShaderProgram::saveProgramBinary(uint64_t key) const
+{
+	if (cacheDirectory.empty() || !GLEW_ARB_get_program_binary)
+		return;
+	GLint binaryLength = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+		return;
+	std::vector<char> binary(binaryLength);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(programID, binaryLength, &binaryLength, &binaryFormat, binary.data());
+
+	ProgramBinaryHeader header;
+	std::memcpy(header.magic, "NSPB", 4);
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = static_cast<uint32_t>(binaryLength);
+	header.checksum = HashUtility::crc32(binary.data(), static_cast<size_t>(binaryLength));
+	header.key = key;
+	std::ofstream file(getCachePath(key), std::ios::binary | std::ios::trunc);
+	if (!file)
+		return;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(ProgramBinaryHeader));
+	file.write(binary.data(), binaryLength);
+}
@@ -1,19 +1,45 @@
 #pragma once
 #include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 #include <GLM\glm.hpp>
+#include "UniformBuffer.h"
+/*
+Linked programs are cached on disk with glGetProgramBinary when a cache directory is set
+Cache file : [HEADER] (ProgramBinaryHeader) followed by the driver's program binary
+The file name is a hash of the shader sources and the GL vendor, renderer and version, so editing a shader or
+updating the driver picks a new file. A binary the driver rejects is replaced by compiling from source
+*/
+struct ProgramBinaryHeader
+{
+	char magic[4];
+	uint32_t binaryFormat;
+	uint32_t binaryLength;
+	uint32_t checksum;
+	uint64_t key;
+};
+
 class ShaderProgram
 {
 public:
 	ShaderProgram();
 	~ShaderProgram();
-	//Compiler vertex shader and fragment shader
+	//Set where program binaries are cached, caching is off while this is empty
+	static void setCacheDirectory(const std::string& directory);
+	//Add a #define after the #version line of every stage, has to be called before compileShaders
+	void setDefine(const std::string& name, int value);
+	//Read the vertex shader and fragment shader sources, they are compiled by linkShaders unless the program is cached
 	void compileShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
 	void compileShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::string& geometryShaderPath);
-	//Link shaders and create program
+	//Link shaders and create program, loading the cached binary instead when there is a valid one
 	void linkShaders();
 	void addAttribute(const std::string& attributeName);
+	//Read the named uniform block from the buffer attached to binding, blocks the program does not use are ignored
+	void bindUniformBlock(const std::string& blockName, UniformBlockBinding binding);
 	void use();
 	void unuse();
+	//Locations are looked up once per name and remembered
 	int getUniformLocation(const std::string& uniformName)const;
 	static void applyShaderUniformMatrix(int uniformId, const glm::mat4& matrixValue);
 	static void applyShaderVector3(int uniformId, const glm::vec3& value);
@@ -21,8 +47,21 @@ public:
 	static void applyShaderInt(int uniformId, int value);
 	static void applyShaderBool(int uniformId, bool value);
 private:
+	static std::string cacheDirectory;
 	unsigned int programID, vertexShaderID, fragmentShaderID, geometryShaderID;
-	void compileShader(const std::string& filePath, unsigned int ID);
+	std::string vertexShaderPath, fragmentShaderPath, geometryShaderPath;
+	std::string vertexShaderSource, fragmentShaderSource, geometryShaderSource;
+	std::string defines;
+	mutable std::unordered_map<std::string, int> uniformLocations;
+	//Names bound with addAttribute, the index is the location
+	std::vector<std::string> attributeNames;
+	void compileShader(const std::string& filePath, const std::string& source, unsigned int ID);
+	static bool readShaderSource(const std::string& filePath, std::string& source);
+	void insertDefines(std::string& source)const;
+	uint64_t getCacheKey()const;
+	std::string getCachePath(uint64_t key)const;
+	bool loadProgramBinary(uint64_t key);
+	void saveProgramBinary(uint64_t key)const;
 	int attributeCount;
 };
 
@@ -0,0 +1,71 @@
+#include "ShaderVariantSet.h"
+#include <iostream>
+
+void ShaderVariantSet::init(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::vector<std::string>& featureNames)
+{
+	this->vertexShaderPath = vertexShaderPath;
+	this->fragmentShaderPath = fragmentShaderPath;
+	this->featureNames = featureNames;
+	if (this->featureNames.size() > MAX_FEATURE_COUNT)
+	{
+		std::cout << "\nShader variant set has more than " << MAX_FEATURE_COUNT << " features : " << fragmentShaderPath;
+		this->featureNames.resize(MAX_FEATURE_COUNT);
+	}
+	variants.clear();
+	uniformBlocks.clear();
+	attributeNames.clear();
+}
+
+void ShaderVariantSet::addAttribute(const std::string& attributeName)
+{
+	if (!variants.empty())
+		std::cout << "\nAttribute " << attributeName << " added after variants were linked : " << vertexShaderPath;
+	attributeNames.push_back(attributeName);
+}
+
+void ShaderVariantSet::addUniformBlock(const std::string& blockName, UniformBlockBinding binding)
+{
+	uniformBlocks.emplace_back(blockName, binding);
+	for (auto& variant : variants)
+		variant.second->bindUniformBlock(blockName, binding);
+}
+
+ShaderProgram& ShaderVariantSet::getVariant(std::initializer_list<int> featureValues)
+{
+	//One byte per feature value
+	uint64_t key = 0;
+	size_t featureIndex = 0;
+	for (const int value : featureValues)
+	{
+		if (featureIndex < featureNames.size())
+			key |= static_cast<uint64_t>(value & 0xFF) << (featureIndex * 8);
+		featureIndex++;
+	}
+
+	auto variantIt = variants.find(key);
+	if (variantIt != variants.end())
+		return *variantIt->second;
+
+	std::unique_ptr<ShaderProgram> program(new ShaderProgram());
+	featureIndex = 0;
+	for (const int value : featureValues)
+	{
+		if (featureIndex < featureNames.size())
+			program->setDefine(featureNames[featureIndex], value & 0xFF);
+		featureIndex++;
+	}
+	program->compileShaders(vertexShaderPath, fragmentShaderPath);
+	for (const std::string& attributeName : attributeNames)
+		program->addAttribute(attributeName);
+	program->linkShaders();
+	for (const auto& uniformBlock : uniformBlocks)
+		program->bindUniformBlock(uniformBlock.first, uniformBlock.second);
+	ShaderProgram& variant = *program;
+	variants.emplace(key, std::move(program));
+	return variant;
+}
+
+size_t ShaderVariantSet::getVariantCount() const noexcept
+{
+	return variants.size();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <initializer_list>
+#include "ShaderProgram.h"
+/*
+Permutations of one shader, every feature is a preprocessor define the shader turns into a constant
+A program is compiled and linked the first time its combination of feature values is asked for and kept after that,
+so mode switches pick a specialised program instead of branching per pixel on a uniform
+*/
+class ShaderVariantSet
+{
+private:
+	static const size_t MAX_FEATURE_COUNT = 8;
+	std::string vertexShaderPath, fragmentShaderPath;
+	std::vector<std::string> featureNames;
+	std::vector<std::pair<std::string, UniformBlockBinding>> uniformBlocks;
+	std::vector<std::string> attributeNames;
+	std::unordered_map<uint64_t, std::unique_ptr<ShaderProgram>> variants;
+public:
+	ShaderVariantSet() = default;
+	ShaderVariantSet(const ShaderVariantSet&) = delete;
+	ShaderVariantSet& operator=(const ShaderVariantSet&) = delete;
+	//featureNames are the defines the shaders check, at most 8 of them
+	void init(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const std::vector<std::string>& featureNames);
+	//Bind a uniform block on every variant, including the ones compiled later
+	void addUniformBlock(const std::string& blockName, UniformBlockBinding binding);
+	//Bind the next attribute location to attributeName, has to be called before the first variant is compiled
+	void addAttribute(const std::string& attributeName);
+	//Get the program with every feature defined to the value at the same index, values have to be in [0, 255]
+	ShaderProgram& getVariant(std::initializer_list<int> featureValues);
+	size_t getVariantCount()const noexcept;
+};
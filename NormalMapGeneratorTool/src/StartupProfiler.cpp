@@ -0,0 +1,81 @@
+#include "StartupProfiler.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+
+std::chrono::steady_clock::time_point StartupProfiler::processStartTime = std::chrono::steady_clock::now();
+std::vector<StartupProfiler::Phase> StartupProfiler::phases;
+std::string StartupProfiler::currentPhaseName;
+std::chrono::steady_clock::time_point StartupProfiler::currentPhaseStartTime;
+double StartupProfiler::startupMs = -1.0;
+
+StartupProfiler::ScopedTimer::ScopedTimer(const std::string& phaseName) : phaseName(phaseName), startTime(std::chrono::steady_clock::now())
+{
+}
+
+StartupProfiler::ScopedTimer::~ScopedTimer()
+{
+	StartupProfiler::addPhase(phaseName, startTime, std::chrono::steady_clock::now());
+}
+
+void StartupProfiler::init()
+{
+	processStartTime = std::chrono::steady_clock::now();
+	phases.clear();
+	currentPhaseName.clear();
+	startupMs = -1.0;
+}
+
+void StartupProfiler::beginPhase(const std::string& name)
+{
+	endPhase();
+	currentPhaseName = name;
+	currentPhaseStartTime = std::chrono::steady_clock::now();
+}
+
+void StartupProfiler::endPhase()
+{
+	if (currentPhaseName.empty())
+		return;
+	addPhase(currentPhaseName, currentPhaseStartTime, std::chrono::steady_clock::now());
+	currentPhaseName.clear();
+}
+
+void StartupProfiler::addPhase(const std::string& name, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime)
+{
+	Phase phase;
+	phase.name = name;
+	phase.startMs = std::chrono::duration<double, std::milli>(startTime - processStartTime).count();
+	phase.durationMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	phases.push_back(phase);
+}
+
+double StartupProfiler::getElapsedMs()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - processStartTime).count();
+}
+
+void StartupProfiler::finishStartup()
+{
+	if (startupMs < 0.0)
+		startupMs = getElapsedMs();
+}
+
+bool StartupProfiler::writeReport(const std::string& path)
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), errorCode);
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "\nCould not write start up report : " << path;
+		return false;
+	}
+	file << std::fixed << std::setprecision(2);
+	file << "Phase,Start (ms),Duration (ms)\n";
+	for (const Phase& phase : phases)
+		file << phase.name << "," << phase.startMs << "," << phase.durationMs << "\n";
+	file << "Total," << 0.0 << "," << ((startupMs < 0.0) ? getElapsedMs() : startupMs) << "\n";
+	return true;
+}
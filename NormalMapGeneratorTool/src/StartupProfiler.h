@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+//Records how long each start up phase takes and writes the timings to a report
+class StartupProfiler
+{
+public:
+	//Times the phase it is named after from construction until it goes out of scope
+	class ScopedTimer
+	{
+	private:
+		std::string phaseName;
+		std::chrono::steady_clock::time_point startTime;
+	public:
+		explicit ScopedTimer(const std::string& phaseName);
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+		~ScopedTimer();
+	};
+private:
+	struct Phase
+	{
+		std::string name;
+		double startMs;
+		double durationMs;
+	};
+	static std::chrono::steady_clock::time_point processStartTime;
+	static std::vector<Phase> phases;
+	static std::string currentPhaseName;
+	static std::chrono::steady_clock::time_point currentPhaseStartTime;
+	//Milliseconds from init until finishStartup, negative until then
+	static double startupMs;
+public:
+	StartupProfiler() = delete;
+	//Set the point all phases are measured from, called first thing in main
+	static void init();
+	//End the running phase, if any, and start timing the next one. Used where a scope cannot wrap the phase
+	static void beginPhase(const std::string& name);
+	static void endPhase();
+	static void addPhase(const std::string& name, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime);
+	//Milliseconds since init
+	static double getElapsedMs();
+	//Stop the start up total, phases recorded later such as deferred loads are still listed but not counted in it
+	static void finishStartup();
+	//Write every recorded phase and the start up total to path, the total is the time so far if finishStartup was not called yet
+	static bool writeReport(const std::string& path);
+};
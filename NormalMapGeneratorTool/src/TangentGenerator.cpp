@@ -0,0 +1,407 @@
+#include "TangentGenerator.h"
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <GLM\glm.hpp>
+#include "HashUtility.h"
+#include "ParallelUtility.h"
+
+namespace
+{
+	enum : uint8_t { ORIENT_PRESERVING = 1, GROUP_WITH_ANY = 2, DEGENERATE = 4 };
+	//Triangles and groups are handed to the threads in blocks of this many
+	const size_t WORK_BLOCK_SIZE = 4096;
+	const int NO_NEIGHBOUR = -1;
+	const int NO_GROUP = -1;
+
+	struct TriangleInfo
+	{
+		glm::vec3 tangentS;
+		glm::vec3 tangentT;
+		//Triangle across the edge from corner i to corner i + 1
+		int faceNeighbours[3];
+		int assignedGroups[3];
+		uint8_t flags;
+	};
+
+	//The triangles around one vertex that share a tangent
+	struct TangentGroup
+	{
+		uint32_t vertex;
+		bool isOrientPreserving;
+		size_t firstFace;
+		size_t faceCount;
+	};
+
+	//An edge with its vertices sorted, forward tells if the triangle runs from the smaller to the larger vertex
+	struct TriangleEdge
+	{
+		uint32_t smallerVertex;
+		uint32_t largerVertex;
+		uint32_t triangle;
+		uint32_t corner;
+		bool isForward;
+	};
+
+	struct CornerTangent
+	{
+		glm::vec3 tangent;
+		float sign;
+	};
+
+	inline bool isNotZero(float value) noexcept
+	{
+		return std::fabs(value) > FLT_MIN;
+	}
+
+	inline bool isNotZero(const glm::vec3& vector) noexcept
+	{
+		return isNotZero(vector.x) || isNotZero(vector.y) || isNotZero(vector.z);
+	}
+
+	inline glm::vec3 normalizeIfNotZero(const glm::vec3& vector) noexcept
+	{
+		return isNotZero(vector) ? vector * (1.0f / std::sqrt(glm::dot(vector, vector))) : vector;
+	}
+
+	template<typename Func>
+	void parallelForBlocks(size_t count, const Func& func)
+	{
+		ParallelUtility::parallelFor((count + WORK_BLOCK_SIZE - 1) / WORK_BLOCK_SIZE, [&](size_t block)
+		{
+			const size_t blockEnd = std::min(count, (block + 1) * WORK_BLOCK_SIZE);
+			for (size_t i = block * WORK_BLOCK_SIZE; i < blockEnd; i++)
+				func(i);
+		});
+	}
+
+	//-0 turned into +0 with a compare, /fp:fast may drop an added +0
+	inline float toPositiveZero(float value) noexcept
+	{
+		return (value == 0.0f) ? 0.0f : value;
+	}
+
+	//Floats a vertex is welded on, the UV as the reference is given it and -0 turned into +0 so the hash agrees with ==
+	const int WELD_KEY_SIZE = 8;
+	void getWeldKey(const float* vertex, float* key) noexcept
+	{
+		for (int i = 0; i < 7; i++)
+			key[i] = toPositiveZero(vertex[i]);
+		key[7] = toPositiveZero(1.0f - vertex[7]);
+	}
+
+	int findCorner(const uint32_t* triangleVertices, uint32_t vertex) noexcept
+	{
+		return (triangleVertices[0] == vertex) ? 0 : ((triangleVertices[1] == vertex) ? 1 : 2);
+	}
+}
+
+void TangentGenerator::generateMikkTSpace(MeshData& mesh)
+{
+	const size_t triangleCount = mesh.indices.size() / 3;
+	const unsigned int vertexCount = mesh.getVertexCount();
+	if (triangleCount == 0)
+		return;
+	const float* const vertices = mesh.vertices.data();
+
+	//Corners are referred to by a welded vertex, identical position, normal and UV count as one vertex like in the reference
+	std::vector<uint32_t> weldedVertices(vertexCount);
+	std::vector<uint32_t> representatives;
+	{
+		//Floats are compared with == as in the reference, so +0 and -0 weld while NaNs never do
+		auto hashVertex = [vertices](uint32_t index)
+		{
+			float key[WELD_KEY_SIZE];
+			getWeldKey(&vertices[static_cast<size_t>(index) * MeshData::FLOATS_PER_VERTEX], key);
+			return static_cast<size_t>(HashUtility::fnv1a64(key, sizeof(key)));
+		};
+		auto areVerticesEqual = [vertices](uint32_t first, uint32_t second)
+		{
+			float firstKey[WELD_KEY_SIZE], secondKey[WELD_KEY_SIZE];
+			getWeldKey(&vertices[static_cast<size_t>(first) * MeshData::FLOATS_PER_VERTEX], firstKey);
+			getWeldKey(&vertices[static_cast<size_t>(second) * MeshData::FLOATS_PER_VERTEX], secondKey);
+			for (int i = 0; i < WELD_KEY_SIZE; i++)
+			{
+				if (firstKey[i] != secondKey[i])
+					return false;
+			}
+			return true;
+		};
+		std::unordered_map<uint32_t, uint32_t, decltype(hashVertex), decltype(areVerticesEqual)> weldedIds(vertexCount, hashVertex, areVerticesEqual);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			const auto insertResult = weldedIds.emplace(i, static_cast<uint32_t>(representatives.size()));
+			if (insertResult.second)
+				representatives.push_back(i);
+			weldedVertices[i] = insertResult.first->second;
+		}
+	}
+	auto getPosition = [&](uint32_t weldedVertex)
+	{
+		const float* vertex = &vertices[static_cast<size_t>(representatives[weldedVertex]) * MeshData::FLOATS_PER_VERTEX];
+		return glm::vec3(vertex[0], vertex[1], vertex[2]);
+	};
+	auto getNormal = [&](uint32_t weldedVertex)
+	{
+		const float* vertex = &vertices[static_cast<size_t>(representatives[weldedVertex]) * MeshData::FLOATS_PER_VERTEX];
+		return glm::vec3(vertex[3], vertex[4], vertex[5]);
+	};
+	//The UVs were flipped on import, the basis is built from the UVs as they are stored in the file
+	auto getTexCoord = [&](uint32_t weldedVertex)
+	{
+		const float* vertex = &vertices[static_cast<size_t>(representatives[weldedVertex]) * MeshData::FLOATS_PER_VERTEX];
+		return glm::vec2(vertex[6], 1.0f - vertex[7]);
+	};
+	std::vector<uint32_t> triangleVertices(triangleCount * 3);
+	for (size_t i = 0; i < triangleVertices.size(); i++)
+		triangleVertices[i] = weldedVertices[mesh.indices[i]];
+
+	//First order tangents of every triangle
+	std::vector<TriangleInfo> triangleInfos(triangleCount);
+	parallelForBlocks(triangleCount, [&](size_t triangle)
+	{
+		TriangleInfo& info = triangleInfos[triangle];
+		const uint32_t* const corners = &triangleVertices[triangle * 3];
+		info.tangentS = glm::vec3(0.0f);
+		info.tangentT = glm::vec3(0.0f);
+		for (int i = 0; i < 3; i++)
+		{
+			info.faceNeighbours[i] = NO_NEIGHBOUR;
+			info.assignedGroups[i] = NO_GROUP;
+		}
+		//Until proven otherwise the triangle has no usable UV derivatives
+		info.flags = GROUP_WITH_ANY;
+		const glm::vec3 position1 = getPosition(corners[0]);
+		const glm::vec3 position2 = getPosition(corners[1]);
+		const glm::vec3 position3 = getPosition(corners[2]);
+		if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2] ||
+			position1 == position2 || position2 == position3 || position1 == position3)
+		{
+			info.flags |= DEGENERATE;
+			return;
+		}
+		const glm::vec2 texCoord1 = getTexCoord(corners[0]);
+		const glm::vec2 texCoord2 = getTexCoord(corners[1]);
+		const glm::vec2 texCoord3 = getTexCoord(corners[2]);
+		const float t21x = texCoord2.x - texCoord1.x;
+		const float t21y = texCoord2.y - texCoord1.y;
+		const float t31x = texCoord3.x - texCoord1.x;
+		const float t31y = texCoord3.y - texCoord1.y;
+		const glm::vec3 edge1 = position2 - position1;
+		const glm::vec3 edge2 = position3 - position1;
+		const float signedAreaSTx2 = t21x * t31y - t21y * t31x;
+		info.tangentS = t31y * edge1 - t21y * edge2;
+		info.tangentT = -t31x * edge1 + t21x * edge2;
+		info.flags |= (signedAreaSTx2 > 0.0f) ? ORIENT_PRESERVING : 0;
+		if (isNotZero(signedAreaSTx2))
+		{
+			const float absoluteArea = std::fabs(signedAreaSTx2);
+			const float lengthS = std::sqrt(glm::dot(info.tangentS, info.tangentS));
+			const float lengthT = std::sqrt(glm::dot(info.tangentT, info.tangentT));
+			const float sign = (info.flags & ORIENT_PRESERVING) ? 1.0f : -1.0f;
+			if (isNotZero(lengthS))
+				info.tangentS = (sign / lengthS) * info.tangentS;
+			if (isNotZero(lengthT))
+				info.tangentT = (sign / lengthT) * info.tangentT;
+			if (isNotZero(lengthS / absoluteArea) && isNotZero(lengthT / absoluteArea))
+				info.flags &= ~GROUP_WITH_ANY;
+		}
+	});
+
+	//Neighbours across edges, an edge is paired with the first unpaired edge running the other way in sorted order
+	{
+		std::vector<TriangleEdge> edges;
+		edges.reserve(triangleCount * 3);
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			if (triangleInfos[triangle].flags & DEGENERATE)
+				continue;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t from = triangleVertices[triangle * 3 + corner];
+				const uint32_t to = triangleVertices[triangle * 3 + (corner + 1) % 3];
+				edges.push_back({ std::min(from, to), std::max(from, to), triangle, corner, from < to });
+			}
+		}
+		std::sort(edges.begin(), edges.end(), [](const TriangleEdge& first, const TriangleEdge& second)
+		{
+			if (first.smallerVertex != second.smallerVertex)
+				return first.smallerVertex < second.smallerVertex;
+			if (first.largerVertex != second.largerVertex)
+				return first.largerVertex < second.largerVertex;
+			if (first.triangle != second.triangle)
+				return first.triangle < second.triangle;
+			return first.corner < second.corner;
+		});
+		for (size_t blockStart = 0; blockStart < edges.size();)
+		{
+			size_t blockEnd = blockStart + 1;
+			while (blockEnd < edges.size() && edges[blockEnd].smallerVertex == edges[blockStart].smallerVertex &&
+				edges[blockEnd].largerVertex == edges[blockStart].largerVertex)
+				blockEnd++;
+			for (size_t i = blockStart; i < blockEnd; i++)
+			{
+				int& neighbour = triangleInfos[edges[i].triangle].faceNeighbours[edges[i].corner];
+				if (neighbour != NO_NEIGHBOUR)
+					continue;
+				for (size_t j = i + 1; j < blockEnd; j++)
+				{
+					int& otherNeighbour = triangleInfos[edges[j].triangle].faceNeighbours[edges[j].corner];
+					if (otherNeighbour == NO_NEIGHBOUR && edges[j].isForward != edges[i].isForward)
+					{
+						neighbour = static_cast<int>(edges[j].triangle);
+						otherNeighbour = static_cast<int>(edges[i].triangle);
+						break;
+					}
+				}
+			}
+			blockStart = blockEnd;
+		}
+	}
+
+	//Grow a group from every corner that has none yet. The traversal order matches the reference's recursion, which decides
+	//the orientation triangles without usable UVs pick up and the order group members are summed in
+	std::vector<TangentGroup> groups;
+	std::vector<uint32_t> groupFaces;
+	groupFaces.reserve(triangleCount * 3);
+	std::vector<int> pendingFaces;
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		TriangleInfo& info = triangleInfos[triangle];
+		if (info.flags & (GROUP_WITH_ANY | DEGENERATE))
+			continue;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (info.assignedGroups[corner] != NO_GROUP)
+				continue;
+			const int groupIndex = static_cast<int>(groups.size());
+			TangentGroup group = { triangleVertices[triangle * 3 + corner], (info.flags & ORIENT_PRESERVING) != 0, groupFaces.size(), 0 };
+			info.assignedGroups[corner] = groupIndex;
+			groupFaces.push_back(triangle);
+			pendingFaces.clear();
+			pendingFaces.push_back(info.faceNeighbours[(corner > 0) ? corner - 1 : 2]);
+			pendingFaces.push_back(info.faceNeighbours[corner]);
+			while (!pendingFaces.empty())
+			{
+				const int face = pendingFaces.back();
+				pendingFaces.pop_back();
+				if (face == NO_NEIGHBOUR)
+					continue;
+				TriangleInfo& faceInfo = triangleInfos[face];
+				const int faceCorner = findCorner(&triangleVertices[face * 3], group.vertex);
+				if (faceInfo.assignedGroups[faceCorner] != NO_GROUP)
+					continue;
+				if ((faceInfo.flags & GROUP_WITH_ANY) && faceInfo.assignedGroups[0] == NO_GROUP &&
+					faceInfo.assignedGroups[1] == NO_GROUP && faceInfo.assignedGroups[2] == NO_GROUP)
+				{
+					faceInfo.flags &= ~ORIENT_PRESERVING;
+					faceInfo.flags |= group.isOrientPreserving ? ORIENT_PRESERVING : 0;
+				}
+				if (((faceInfo.flags & ORIENT_PRESERVING) != 0) != group.isOrientPreserving)
+					continue;
+				faceInfo.assignedGroups[faceCorner] = groupIndex;
+				groupFaces.push_back(static_cast<uint32_t>(face));
+				//Left is visited before right, so it goes on the stack last
+				pendingFaces.push_back(faceInfo.faceNeighbours[(faceCorner > 0) ? faceCorner - 1 : 2]);
+				pendingFaces.push_back(faceInfo.faceNeighbours[faceCorner]);
+			}
+			group.faceCount = groupFaces.size() - group.firstFace;
+			groups.push_back(group);
+		}
+	}
+
+	//Corners nothing reaches keep the reference's default basis
+	std::vector<CornerTangent> cornerTangents(triangleCount * 3);
+	for (size_t i = 0; i < cornerTangents.size(); i++)
+		cornerTangents[i] = { glm::vec3(1.0f, 0.0f, 0.0f), (triangleInfos[i / 3].flags & ORIENT_PRESERVING) ? 1.0f : -1.0f };
+	parallelForBlocks(groups.size(), [&](size_t groupIndex)
+	{
+		const TangentGroup& group = groups[groupIndex];
+		const glm::vec3 normal = getNormal(group.vertex);
+		glm::vec3 tangentSum(0.0f);
+		for (size_t i = group.firstFace; i < group.firstFace + group.faceCount; i++)
+		{
+			const uint32_t face = groupFaces[i];
+			const TriangleInfo& info = triangleInfos[face];
+			if (info.flags & GROUP_WITH_ANY)
+				continue;
+			const uint32_t* const corners = &triangleVertices[face * 3];
+			const int corner = findCorner(corners, group.vertex);
+			const glm::vec3 tangent = normalizeIfNotZero(info.tangentS - glm::dot(normal, info.tangentS) * normal);
+			//Weighted by the angle the triangle spans at the vertex
+			const glm::vec3 position = getPosition(corners[corner]);
+			glm::vec3 toPrevious = getPosition(corners[(corner > 0) ? corner - 1 : 2]) - position;
+			glm::vec3 toNext = getPosition(corners[(corner < 2) ? corner + 1 : 0]) - position;
+			toPrevious = normalizeIfNotZero(toPrevious - glm::dot(normal, toPrevious) * normal);
+			toNext = normalizeIfNotZero(toNext - glm::dot(normal, toNext) * normal);
+			const float angle = static_cast<float>(std::acos(static_cast<double>(glm::clamp(glm::dot(toPrevious, toNext), -1.0f, 1.0f))));
+			tangentSum += angle * tangent;
+		}
+		const CornerTangent result = { normalizeIfNotZero(tangentSum), group.isOrientPreserving ? 1.0f : -1.0f };
+		for (size_t i = group.firstFace; i < group.firstFace + group.faceCount; i++)
+		{
+			const uint32_t face = groupFaces[i];
+			cornerTangents[face * 3 + findCorner(&triangleVertices[face * 3], group.vertex)] = result;
+		}
+	});
+
+	//Degenerate triangles copy the basis of the first proper corner using the same vertex
+	std::vector<int64_t> firstCornerOfVertex(representatives.size(), -1);
+	for (size_t i = 0; i < cornerTangents.size(); i++)
+	{
+		if (!(triangleInfos[i / 3].flags & DEGENERATE) && firstCornerOfVertex[triangleVertices[i]] < 0)
+			firstCornerOfVertex[triangleVertices[i]] = static_cast<int64_t>(i);
+	}
+	for (size_t i = 0; i < cornerTangents.size(); i++)
+	{
+		if ((triangleInfos[i / 3].flags & DEGENERATE) && firstCornerOfVertex[triangleVertices[i]] >= 0)
+			cornerTangents[i] = cornerTangents[firstCornerOfVertex[triangleVertices[i]]];
+	}
+
+	//Write the corners back, a vertex is duplicated for every distinct basis its corners ended up with
+	std::vector<int64_t> firstCornerOfOriginal(vertexCount, -1);
+	std::unordered_map<uint32_t, std::vector<uint32_t>> splitsOfVertex;
+	std::vector<CornerTangent> splitTangents;
+	auto isSameBasis = [](const CornerTangent& first, const CornerTangent& second)
+	{
+		return first.tangent == second.tangent && first.sign == second.sign;
+	};
+	float copiedVertex[MeshData::FLOATS_PER_VERTEX];
+	for (size_t i = 0; i < cornerTangents.size(); i++)
+	{
+		const uint32_t original = mesh.indices[i];
+		const CornerTangent& cornerTangent = cornerTangents[i];
+		int64_t& firstCorner = firstCornerOfOriginal[original];
+		uint32_t vertex = original;
+		if (firstCorner < 0)
+			firstCorner = static_cast<int64_t>(i);
+		else if (!isSameBasis(cornerTangents[firstCorner], cornerTangent))
+		{
+			std::vector<uint32_t>& splits = splitsOfVertex[original];
+			const auto splitIt = std::find_if(splits.begin(), splits.end(), [&](uint32_t split)
+			{
+				return isSameBasis(splitTangents[split - vertexCount], cornerTangent);
+			});
+			if (splitIt != splits.end())
+				vertex = *splitIt;
+			else
+			{
+				vertex = mesh.getVertexCount();
+				std::memcpy(copiedVertex, &mesh.vertices[static_cast<size_t>(original) * MeshData::FLOATS_PER_VERTEX], sizeof(copiedVertex));
+				mesh.vertices.insert(mesh.vertices.end(), copiedVertex, copiedVertex + MeshData::FLOATS_PER_VERTEX);
+				splits.push_back(vertex);
+				splitTangents.push_back(cornerTangent);
+			}
+			mesh.indices[i] = vertex;
+		}
+		float* const vertexData = &mesh.vertices[static_cast<size_t>(vertex) * MeshData::FLOATS_PER_VERTEX];
+		const glm::vec3 bitangent = cornerTangent.sign * glm::cross(glm::vec3(vertexData[3], vertexData[4], vertexData[5]), cornerTangent.tangent);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			vertexData[8 + axis] = cornerTangent.tangent[axis];
+			vertexData[11 + axis] = bitangent[axis];
+		}
+	}
+}
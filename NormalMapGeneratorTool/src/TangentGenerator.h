@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include "MeshData.h"
+//Tangent basis preview meshes are imported with, the values are stored in mesh cache files
+enum class TangentSpace : uint32_t
+{
+	IMPORTED = 0, //Assimp's aiProcess_CalcTangentSpace, or the UV derivatives for files read by ObjParser
+	MIKKTSPACE = 1 //The basis most engines and bakers use, see TangentGenerator
+};
+
+/*
+MikkTSpace tangent basis following the reference implementation by Morten Mikkelsen
+Vertices are welded on position, normal and UV, then the triangles around every vertex are split into groups that are
+connected through shared edges and agree on the UV orientation. Every group gets the angle weighted average of its
+triangles' tangents projected onto the vertex normal, so a vertex whose corners end up in different groups is split
+The groups are independent and are evaluated in parallel. Subgroups are not formed, which is what the reference does
+with its default angular threshold of 180 degrees
+*/
+class TangentGenerator
+{
+public:
+	TangentGenerator() = delete;
+	//Replace the tangents and bitangents of mesh, the bitangent is sign * cross(normal, tangent) as the shaders rebuild it
+	static void generateMikkTSpace(MeshData& mesh);
+};
@@ -1,6 +1,8 @@
 #include "TextureData.h"
 #include "TextureLoader.h"
+#include "GLutil.h"
 #include <iostream>
+#include <cstdlib>
 TextureData::TextureData()
 {
 	data = nullptr;
@@ -16,7 +18,7 @@ void TextureData::setTextureDataNonAlloc(unsigned char * data, int width, int he
 	this->componentCount = componentCount;
 	if (this->data != nullptr)
 	{
-		delete[] this->data;
+		std::free(this->data);
 		this->data = nullptr;
 	}
 	this->data = data;
@@ -29,10 +31,10 @@ void TextureData::setTextureData(unsigned char * data, int width, int height, in
 	this->componentCount = componentCount;
 	if (this->data != nullptr)
 	{
-		delete[] this->data;
+		std::free(this->data);
 		this->data = nullptr;
 	}
-	this->data = new unsigned char[width * height * componentCount];
+	this->data = static_cast<unsigned char*>(std::malloc(static_cast<size_t>(width) * height * componentCount));
 	std::memcpy(this->data, data, width * height * componentCount);
 }
 
@@ -54,7 +56,9 @@ int TextureData::getComponentCount()const noexcept
 void TextureData::setTexId(unsigned int texId)
 {
 	if (this->texId != 0 && this->texId != texId)
-		glDeleteTextures(1, &(this->texId));
+		GL::deleteTexture(this->texId);
+	if (this->texId != texId)
+		version++;
 	this->texId = texId;
 }
 
@@ -105,21 +109,27 @@ void TextureData::setTexelRangeWithColour(int beginIndex, int endIndex, ColourDa
 	}
 }
 
-void TextureData::updateTexture()
+bool TextureData::updateTexture()
 {
 	if (!requiresUpdate)
-		return;
-	GLint currentTexture;
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTexture);
+		return false;
+	requiresUpdate = false;
 	GLenum format = TextureManager::getTextureFormatFromData(componentCount);
-	glBindTexture(GL_TEXTURE_2D, texId);
+	GL::bindTexture(TextureType::TEXTURE_2D, texId);
 	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
-	glBindTexture(GL_TEXTURE_2D, currentTexture);
+	version++;
+	return true;
 }
 
 void TextureData::updateTextureData(unsigned char * data)
 {
 	std::memcpy(this->data, data, width * height * componentCount);
+	requiresUpdate = true;
+}
+
+unsigned int TextureData::getVersion()const noexcept
+{
+	return version;
 }
 
 ColourData TextureData::getTexelColor(int x, int y)const noexcept
@@ -148,17 +158,17 @@ void TextureData::setTextureDirty()noexcept
 void TextureData::clearRawData()
 {
 	if (data != nullptr)
-		delete[] data;
+		std::free(data);
 	data = nullptr;
 }
 
 TextureData::~TextureData()
 {
 	if (texId != 0)
-		glDeleteTextures(1, &texId);
+		GL::deleteTexture(texId);
 	if (data != nullptr)
 	{
-		delete[] data;
+		std::free(data);
 		data = nullptr;
 	}
 }
@@ -14,9 +14,12 @@ private:
 	int componentCount = 0;
 	unsigned int texId = 0;
 	bool requiresUpdate = false;
+	unsigned int version = 0;
 public:
 	TextureData();
+	//Take ownership of data without copying it, data has to be allocated with malloc (stb_image buffers are)
 	void setTextureDataNonAlloc(unsigned char* data, int width, int height, int componentCount);
+	//Copy data into a new buffer owned by the texture data
 	void setTextureData(unsigned char* data, int width, int height, int componentCount);
 	unsigned char* const getTextureData()const;
 	glm::ivec2 getRes()const noexcept;
@@ -26,8 +29,11 @@ public:
 	void setTexelColor(int r, int g, int b, int a, int x, int y);
 	void setTexelColor(ColourData& colourData, int x, int y);
 	void setTexelRangeWithColour(int beginIndex, int endIndex, ColourData& colourData);
-	void updateTexture();
+	//Upload the pixels to the texture if they changed since the last upload, returns true if they were uploaded
+	bool updateTexture();
 	void updateTextureData(unsigned char* data);
+	//Changes whenever the texture is replaced or new pixels are uploaded to it
+	unsigned int getVersion()const noexcept;
 	ColourData getTexelColor(int x, int y)const noexcept;
 	ColourData getTexColorAsUV(float x, float y)const noexcept;
 	//Set the texture as dirty so that it can be updated
@@ -11,9 +11,9 @@ void TextureManager::getRawImageDataFromFile(const std::string& path, std::vecto
 	stbi_set_flip_vertically_on_load(flipImage);
 	unsigned char* ldata = stbi_load(path.c_str(), &width, &height, &nrComponents, 4);
 	nrComponents = 4;
-	const unsigned int size = width * height * nrComponents;
-	for (unsigned int i = 0; i < size; i++)
-		data.push_back(ldata[i]);
+	if (ldata == nullptr)
+		return;
+	data.assign(ldata, ldata + static_cast<size_t>(width) * height * nrComponents);
 	stbi_image_free(ldata);
 }
 
@@ -23,18 +23,23 @@ void TextureManager::getTextureDataFromFile(const std::string& path, TextureData
 	stbi_set_flip_vertically_on_load(true);
 	unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, 4);
 	nrComponents = 4;
+	//The decoded buffer is handed over as is, texture data releases it with free like stbi_image_free
 	if (data)
-		textureData.setTextureData(data, width, height, nrComponents);
-	stbi_image_free(data);
+		textureData.setTextureDataNonAlloc(data, width, height, nrComponents);
+}
+
+bool TextureManager::getImageInfo(const std::string& path, int& width, int& height, int& componentCount)
+{
+	width = 0;
+	height = 0;
+	componentCount = 0;
+	return stbi_info(path.c_str(), &width, &height, &componentCount) != 0;
 }
 
 glm::ivec2 TextureManager::getImageDimensions(const std::string& path)
 {
 	int width, height, nrComponents;
-	stbi_set_flip_vertically_on_load(true);
-	unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, 4);
-	nrComponents = 4;
-	stbi_image_free(data);
+	getImageInfo(path, width, height, nrComponents);
 	return glm::ivec2(width, height);
 }
 
@@ -63,7 +68,7 @@ unsigned int TextureManager::createTextureFromFile(const std::string& path, bool
 			format = GL_RGBA;
 			internalFormat = (linearColourSpace) ? GL_RGBA : GL_SRGB_ALPHA;
 		}
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		GL::bindTexture(TextureType::TEXTURE_2D, textureID);
 		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 		glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -85,7 +90,7 @@ unsigned int TextureManager::createCubemapFromFile(const std::vector<std::string
 {
 	unsigned int textureID;
 	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, textureID);
 
 	int width = 0, height = 0, nrChannels = 0;
 	for (unsigned int i = 0; i < paths.size(); i++)
@@ -110,7 +115,7 @@ unsigned int TextureManager::createCubemapFromFile(const std::vector<std::string
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	GL::bindTexture(TextureType::TEXTURE_CUBE_MAP, 0);
 	return textureID;
 }
 
@@ -129,7 +134,7 @@ unsigned int TextureManager::createTextureFromData(const TextureData& textureDat
 			format = GL_RGB;
 		else if (textureData.getComponentCount() == 4)
 			format = GL_RGBA;
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		GL::bindTexture(TextureType::TEXTURE_2D, textureID);
 		glTexImage2D(GL_TEXTURE_2D, 0, format, textureData.getRes().x, textureData.getRes().y, 0, format, GL_UNSIGNED_BYTE, data);
 		glGenerateMipmap(GL_TEXTURE_2D);
 
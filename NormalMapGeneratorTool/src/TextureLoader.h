@@ -14,6 +14,8 @@ public:
 	TextureManager(const TextureManager&) = delete;
 	static void getRawImageDataFromFile(const std::string& path, std::vector<unsigned char>& data, int &width, int &height, bool flipImage);
 	static void getTextureDataFromFile(const std::string & path, TextureData & textureData);
+	//Read the resolution and channel count from the image header without decoding the pixels
+	static bool getImageInfo(const std::string& path, int& width, int& height, int& componentCount);
 	static glm::ivec2 getImageDimensions(const std::string& path);
 	static unsigned int createTextureFromFile(const std::string& path, bool linearColourSpace = false, TextureFilterType textureFilterType = TextureFilterType::LINEAR)noexcept;
 	static unsigned int createCubemapFromFile(const std::vector<std::string>& paths);
@@ -0,0 +1,51 @@
+#include "UniformBuffer.h"
+#include <GL\glew.h>
+#include <cstring>
+#include <iostream>
+
+void UniformBuffer::init(size_t size, UniformBlockBinding binding)
+{
+	bindingPoint = static_cast<unsigned int>(binding);
+	glGenBuffers(1, &bufferId);
+	glBindBuffer(GL_UNIFORM_BUFFER, bufferId);
+	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferId);
+	uploadedData.assign(size, 0);
+	hasData = false;
+}
+
+bool UniformBuffer::update(const void* data, size_t size)
+{
+	if (bufferId == 0 || size > uploadedData.size())
+	{
+		std::cout << "\nUniform buffer " << bindingPoint << " is not initialized or too small for " << size << " bytes";
+		return false;
+	}
+	if (hasData && std::memcmp(uploadedData.data(), data, size) == 0)
+		return false;
+	std::memcpy(uploadedData.data(), data, size);
+	hasData = true;
+	glBindBuffer(GL_UNIFORM_BUFFER, bufferId);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	return true;
+}
+
+unsigned int UniformBuffer::getBindingPoint() const noexcept
+{
+	return bindingPoint;
+}
+
+void UniformBuffer::destroy()
+{
+	if (bufferId != 0)
+		glDeleteBuffers(1, &bufferId);
+	bufferId = 0;
+	uploadedData.clear();
+	hasData = false;
+}
+
+UniformBuffer::~UniformBuffer()
+{
+}
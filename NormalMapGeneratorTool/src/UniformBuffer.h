@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM\glm.hpp>
+//Binding points of the uniform blocks shared between shader programs
+enum class UniformBlockBinding : unsigned int
+{
+	CAMERA = 0, PREVIEW_LIGHTING = 1, NORMAL_VIEW = 2
+};
+
+//CameraBlock, std140 layout
+struct CameraUniforms
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 cameraPosition;
+	float padding;
+};
+
+//PreviewLightingBlock in modelView.fs, std140 layout
+struct PreviewLightingUniforms
+{
+	glm::vec3 lightPosition;
+	float lightIntensity;
+	glm::vec3 lightColour;
+	float roughness;
+	glm::vec3 diffuseColour;
+	float metalness;
+	float heightmapStrength;
+	float heightmapWidth;
+	float heightmapHeight;
+	float padding;
+	//Irradiance of the environment, see IblData
+	glm::vec4 irradianceSH[9];
+	float prefilteredMaxLod;
+	float padding2[3];
+};
+
+//NormalViewBlock in normalPanel.fs, std140 layout
+struct NormalViewUniforms
+{
+	glm::vec3 lightDirection;
+	float heightmapWidth;
+	float heightmapHeight;
+	float specularity;
+	float specularStrength;
+	float lightIntensity;
+	int32_t flipXYdir;
+	int32_t redChannel;
+	int32_t greenChannel;
+	int32_t blueChannel;
+};
+
+static_assert(sizeof(CameraUniforms) == 144, "CameraUniforms does not match the std140 layout of CameraBlock");
+static_assert(sizeof(PreviewLightingUniforms) == 224, "PreviewLightingUniforms does not match the std140 layout of PreviewLightingBlock");
+static_assert(sizeof(NormalViewUniforms) == 48, "NormalViewUniforms does not match the std140 layout of NormalViewBlock");
+
+//Uniform buffer object bound to a fixed binding point, keeps a copy of the last upload so unchanged data is not sent again
+class UniformBuffer
+{
+private:
+	unsigned int bufferId = 0;
+	unsigned int bindingPoint = 0;
+	std::vector<unsigned char> uploadedData;
+	bool hasData = false;
+public:
+	UniformBuffer() = default;
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+	//Create the buffer with room for size bytes and attach it to the binding point
+	void init(size_t size, UniformBlockBinding binding);
+	//Upload data if it differs from the last upload, returns true when the buffer was written
+	bool update(const void* data, size_t size);
+	template<typename T>
+	bool update(const T& block)
+	{
+		return update(&block, sizeof(T));
+	}
+	unsigned int getBindingPoint()const noexcept;
+	void destroy();
+	~UniformBuffer();
+};
@@ -0,0 +1,175 @@
+#include "VertexPacking.h"
+#include <cstring>
+#include <cstddef>
+#include <GL\glew.h>
+#include <GLM\glm.hpp>
+#include <GLM\gtc\packing.hpp>
+
+namespace
+{
+	template<typename Vertex>
+	void packAttributes(const float* source, Vertex& vertex) noexcept
+	{
+		glm::vec3 normal(source[3], source[4], source[5]);
+		normal = (glm::dot(normal, normal) < 1.0e-12f) ? glm::vec3(0, 0, 1) : glm::normalize(normal);
+		const glm::vec3 tangent(source[8], source[9], source[10]);
+		const glm::vec3 bitangent(source[11], source[12], source[13]);
+		const glm::vec2 encodedNormal = VertexPacking::encodeOctahedral(normal);
+		//Degenerate UVs leave Assimp without a tangent, any direction perpendicular to the normal keeps the shading stable
+		glm::vec3 orthogonalTangent = tangent - normal * glm::dot(normal, tangent);
+		if (glm::dot(orthogonalTangent, orthogonalTangent) < 1.0e-12f)
+			orthogonalTangent = glm::cross(normal, (glm::abs(normal.x) < 0.9f) ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0));
+		const glm::vec2 encodedTangent = VertexPacking::encodeOctahedral(glm::normalize(orthogonalTangent));
+		const float bitangentSign = (glm::dot(glm::cross(normal, orthogonalTangent), bitangent) < 0.0f) ? -1.0f : 1.0f;
+
+		vertex.normal[0] = VertexPacking::toSnorm16(encodedNormal.x);
+		vertex.normal[1] = VertexPacking::toSnorm16(encodedNormal.y);
+		vertex.uv[0] = glm::packHalf1x16(source[6]);
+		vertex.uv[1] = glm::packHalf1x16(source[7]);
+		vertex.tangent[0] = VertexPacking::toSnorm16(encodedTangent.x);
+		vertex.tangent[1] = VertexPacking::toSnorm16(encodedTangent.y);
+		vertex.tangent[2] = 0;
+		vertex.tangent[3] = VertexPacking::toSnorm16(bitangentSign);
+	}
+}
+
+unsigned int VertexPacking::getStride(VertexFormat format) noexcept
+{
+	return (format == VertexFormat::PACKED_QUANTIZED_POSITION) ? sizeof(QuantizedPackedVertex) : sizeof(PackedVertex);
+}
+
+std::vector<unsigned char> VertexPacking::pack(const MeshData& mesh, VertexFormat format)
+{
+	const unsigned int vertexCount = mesh.getVertexCount();
+	std::vector<unsigned char> packedVertices(static_cast<size_t>(vertexCount) * getStride(format));
+	if (format == VertexFormat::PACKED_QUANTIZED_POSITION)
+	{
+		float extent = 0.0f;
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const float* source = &mesh.vertices[i * MeshData::FLOATS_PER_VERTEX];
+			extent = glm::max(extent, glm::max(glm::abs(source[0]), glm::max(glm::abs(source[1]), glm::abs(source[2]))));
+		}
+		//w stores 1 / extent, extents below 1 are rounded up so w stays in snorm range
+		const int16_t reciprocalExtent = toSnorm16(1.0f / glm::max(extent, 1.0f));
+		QuantizedPackedVertex* const vertices = reinterpret_cast<QuantizedPackedVertex*>(packedVertices.data());
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const float* source = &mesh.vertices[i * MeshData::FLOATS_PER_VERTEX];
+			for (int axis = 0; axis < 3; axis++)
+				vertices[i].position[axis] = static_cast<int16_t>(glm::clamp(glm::round(source[axis] * reciprocalExtent), -32767.0f, 32767.0f));
+			vertices[i].position[3] = reciprocalExtent;
+			packAttributes(source, vertices[i]);
+		}
+	}
+	else
+	{
+		PackedVertex* const vertices = reinterpret_cast<PackedVertex*>(packedVertices.data());
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const float* source = &mesh.vertices[i * MeshData::FLOATS_PER_VERTEX];
+			std::memcpy(vertices[i].position, source, sizeof(vertices[i].position));
+			packAttributes(source, vertices[i]);
+		}
+	}
+	return packedVertices;
+}
+
+std::vector<glm::vec3> VertexPacking::unpackPositions(const PackedMesh& mesh)
+{
+	return unpackPositions(mesh.vertices.data(), mesh.vertexCount, mesh.format);
+}
+
+std::vector<glm::vec3> VertexPacking::unpackPositions(const unsigned char* packedVertices, unsigned int vertexCount, VertexFormat format)
+{
+	std::vector<glm::vec3> positions(vertexCount);
+	if (format == VertexFormat::PACKED_QUANTIZED_POSITION)
+	{
+		const QuantizedPackedVertex* const vertices = reinterpret_cast<const QuantizedPackedVertex*>(packedVertices);
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			//The same divide by w the vertex shaders do
+			const float w = static_cast<float>(vertices[i].position[3]);
+			positions[i] = glm::vec3(vertices[i].position[0], vertices[i].position[1], vertices[i].position[2]) / w;
+		}
+	}
+	else
+	{
+		const PackedVertex* const vertices = reinterpret_cast<const PackedVertex*>(packedVertices);
+		for (unsigned int i = 0; i < vertexCount; i++)
+			positions[i] = glm::vec3(vertices[i].position[0], vertices[i].position[1], vertices[i].position[2]);
+	}
+	return positions;
+}
+
+void VertexPacking::unpackNormalsAndTangents(const unsigned char* packedVertices, unsigned int vertexCount, VertexFormat format,
+	std::vector<glm::vec3>& normals, std::vector<glm::vec3>& tangents)
+{
+	normals.resize(vertexCount);
+	tangents.resize(vertexCount);
+	const unsigned int stride = getStride(format);
+	const size_t normalOffset = (format == VertexFormat::PACKED_QUANTIZED_POSITION) ? offsetof(QuantizedPackedVertex, normal) : offsetof(PackedVertex, normal);
+	const size_t tangentOffset = (format == VertexFormat::PACKED_QUANTIZED_POSITION) ? offsetof(QuantizedPackedVertex, tangent) : offsetof(PackedVertex, tangent);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const unsigned char* vertex = packedVertices + static_cast<size_t>(i) * stride;
+		int16_t normal[2];
+		int16_t tangent[2];
+		std::memcpy(normal, vertex + normalOffset, sizeof(normal));
+		std::memcpy(tangent, vertex + tangentOffset, sizeof(tangent));
+		normals[i] = decodeOctahedral(glm::vec2(normal[0], normal[1]) / 32767.0f);
+		tangents[i] = decodeOctahedral(glm::vec2(tangent[0], tangent[1]) / 32767.0f);
+	}
+}
+
+void VertexPacking::setAttributePointers(VertexFormat format)
+{
+	const GLsizei stride = static_cast<GLsizei>(getStride(format));
+	glEnableVertexAttribArray(0);
+	if (format == VertexFormat::PACKED_QUANTIZED_POSITION)
+	{
+		glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedPackedVertex, position));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedPackedVertex, normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(QuantizedPackedVertex, uv));
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedPackedVertex, tangent));
+	}
+	else
+	{
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, uv));
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, tangent));
+	}
+}
+
+glm::vec2 VertexPacking::encodeOctahedral(const glm::vec3& direction) noexcept
+{
+	const glm::vec3 n = direction / (glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z));
+	glm::vec2 encoded(n.x, n.y);
+	if (n.z < 0.0f)
+	{
+		const glm::vec2 signNotZero((encoded.x >= 0.0f) ? 1.0f : -1.0f, (encoded.y >= 0.0f) ? 1.0f : -1.0f);
+		encoded = (glm::vec2(1.0f) - glm::abs(glm::vec2(encoded.y, encoded.x))) * signNotZero;
+	}
+	return encoded;
+}
+
+glm::vec3 VertexPacking::decodeOctahedral(const glm::vec2& encoded) noexcept
+{
+	glm::vec3 direction(encoded, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+	const float fold = glm::max(-direction.z, 0.0f);
+	direction.x += (direction.x >= 0.0f) ? -fold : fold;
+	direction.y += (direction.y >= 0.0f) ? -fold : fold;
+	return glm::normalize(direction);
+}
+
+int16_t VertexPacking::toSnorm16(float value) noexcept
+{
+	return static_cast<int16_t>(glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
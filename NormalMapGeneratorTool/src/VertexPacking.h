@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM\glm.hpp>
+#include "MeshData.h"
+#include "TangentGenerator.h"
+//Layouts preview meshes are uploaded in, the values are stored in mesh cache files
+enum class VertexFormat : uint32_t
+{
+	PACKED = 1, //Float position
+	PACKED_QUANTIZED_POSITION = 2 //16 bit position, w holds the reciprocal of the mesh extent
+};
+
+/*
+Normal and tangent are octahedral encoded into two 16 bit snorms, the tangent keeps the bitangent sign in w.
+UVs are half floats. The vertex shaders read the position as a vec4 and divide by w, a float position leaves w at 1
+*/
+struct PackedVertex
+{
+	float position[3];
+	int16_t normal[2];
+	uint16_t uv[2];
+	int16_t tangent[4];
+};
+
+struct QuantizedPackedVertex
+{
+	int16_t position[4];
+	int16_t normal[2];
+	uint16_t uv[2];
+	int16_t tangent[4];
+};
+
+//Packed vertices and indices of a mesh, built off the GL thread and uploaded with ModelObject::updateMeshData
+//indices holds every LOD with the full detail level first, parts holds the same number of parts for each level
+struct PackedMesh
+{
+	VertexFormat format = VertexFormat::PACKED;
+	TangentSpace tangentSpace = TangentSpace::IMPORTED;
+	unsigned int vertexCount = 0;
+	unsigned int lodCount = 1;
+	std::vector<unsigned char> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<MeshPart> parts;
+};
+
+static_assert(sizeof(PackedVertex) == 28, "PackedVertex has to match the attribute offsets set in VertexPacking");
+static_assert(sizeof(QuantizedPackedVertex) == 24, "QuantizedPackedVertex has to match the attribute offsets set in VertexPacking");
+
+class VertexPacking
+{
+public:
+	//Vertex shader inputs in attribute location order, bound with ShaderProgram::addAttribute before linking
+	static constexpr const char* ATTRIBUTE_NAMES[] = { "aPos", "aNormal", "aTexCoords", "aTangent" };
+	VertexPacking() = delete;
+	static unsigned int getStride(VertexFormat format) noexcept;
+	//Convert the float vertices of mesh to format
+	static std::vector<unsigned char> pack(const MeshData& mesh, VertexFormat format);
+	//Float positions of the packed vertices of mesh
+	static std::vector<glm::vec3> unpackPositions(const PackedMesh& mesh);
+	static std::vector<glm::vec3> unpackPositions(const unsigned char* vertices, unsigned int vertexCount, VertexFormat format);
+	//Unit normals and tangents of vertexCount packed vertices
+	static void unpackNormalsAndTangents(const unsigned char* vertices, unsigned int vertexCount, VertexFormat format,
+		std::vector<glm::vec3>& normals, std::vector<glm::vec3>& tangents);
+	//Point attributes 0 to 3 (position, normal, uv, tangent) at the bound vertex buffer
+	static void setAttributePointers(VertexFormat format);
+	//Map a unit vector onto the octahedron and unfold it into [-1, 1]^2
+	static glm::vec2 encodeOctahedral(const glm::vec3& direction) noexcept;
+	//Inverse of encodeOctahedral, matches DecodeOctahedral in the vertex shaders
+	static glm::vec3 decodeOctahedral(const glm::vec2& encoded) noexcept;
+	static int16_t toSnorm16(float value) noexcept;
+};
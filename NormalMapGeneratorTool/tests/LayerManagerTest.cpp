@@ -0,0 +1,127 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <filesystem>
+#include "LayerManager.h"
+#include "NoraFileHandler.h"
+#include "FrameBufferSystem.h"
+#include "FileExplorer.h"
+#include "TextureLoader.h"
+#include "Stb\stb_image_write.h"
+#include "Tests.h"
+
+//LayerManager is linked against these instead of the GL backed classes, so the tests run without a context
+namespace
+{
+	struct CreatedTexture
+	{
+		int width;
+		int height;
+	};
+	std::vector<CreatedTexture> createdTextures;
+}
+
+FileOpenDialog* FileOpenDialog::instance = nullptr;
+void FileOpenDialog::displayDialog(FileType, std::function<void(std::string)>) noexcept {}
+
+FrameBufferSystem::FrameBufferSystem() {}
+FrameBufferSystem::~FrameBufferSystem() {}
+void FrameBufferSystem::init(const glm::ivec2&, const glm::ivec2&) {}
+void FrameBufferSystem::bindFrameBuffer() const noexcept {}
+unsigned int FrameBufferSystem::getColourTexture() const noexcept { return 0; }
+void FrameBufferSystem::updateTextureDimensions(const glm::ivec2&) noexcept {}
+
+unsigned int TextureManager::createTextureFromData(const TextureData& textureData, TextureFilterType)
+{
+	createdTextures.push_back({ textureData.getRes().x, textureData.getRes().y });
+	return static_cast<unsigned int>(createdTextures.size()) + 100;
+}
+
+unsigned int TextureManager::createTextureFromFile(const std::string&, bool, TextureFilterType)noexcept
+{
+	return 0;
+}
+
+GLenum TextureManager::getTextureFormatFromData(int componentCount)noexcept
+{
+	return (componentCount == 4) ? GL_RGBA : GL_RGB;
+}
+
+namespace
+{
+	bool check(bool condition, const std::string& message)
+	{
+		if (!condition)
+			std::cout << "\nFAILED : " << message;
+		return condition;
+	}
+
+	bool writeLayerImage(const std::string& path, int width, int height)
+	{
+		std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+		for (size_t i = 0; i < pixels.size(); i++)
+			pixels[i] = static_cast<unsigned char>(i * 7);
+		return stbi_write_png(path.c_str(), width, height, 3, pixels.data(), width * 3) != 0;
+	}
+
+	//A project opened from a .nora file and saved before layer output is turned on releases the file with its layers
+	//still undecoded, they have to be decoded from the copied payloads once the layers are blended
+	bool testSaveBeforeLayerOutput(const std::filesystem::path& directory)
+	{
+		const std::string firstImagePath = (directory / "layer_1.png").string();
+		const std::string secondImagePath = (directory / "layer_2.png").string();
+		const std::string projectPath = (directory / "project.nora").string();
+		const std::string savedPath = (directory / "saved.nora").string();
+		if (!check(writeLayerImage(firstImagePath, 8, 4) && writeLayerImage(secondImagePath, 5, 6), "writing layer images"))
+			return false;
+
+		std::vector<unsigned char> heightPixels(16 * 16 * 4, 128);
+		TextureData heightMapTexData;
+		heightMapTexData.setTextureData(heightPixels.data(), 16, 16, 4);
+		{
+			LayerManager sourceLayers;
+			sourceLayers.init(glm::vec2(64), glm::vec2(64));
+			sourceLayers.addLayer(1, LayerType::HEIGHT_MAP, "Base");
+			sourceLayers.addLayer(2, LayerType::HEIGHT_MAP, "", firstImagePath);
+			sourceLayers.addLayer(3, LayerType::NORMAL_MAP, "", secondImagePath);
+			if (!check(NoraFileHandler::writeToDisk(projectPath, heightMapTexData, sourceLayers, NoraThumbnails()), "writing the project"))
+				return false;
+		}
+
+		std::shared_ptr<NoraFileReader> reader = std::make_shared<NoraFileReader>();
+		if (!check(reader->open(projectPath), "opening the project"))
+			return false;
+		LayerManager layerManager;
+		layerManager.init(glm::vec2(64), glm::vec2(64));
+		layerManager.initWithNoraFile(reader);
+		reader.reset();
+		bool hasPassed = check(layerManager.getLayerCount() == 3, "layer count after opening");
+		hasPassed = check(!layerManager.loadPendingLayerData(false), "no layer decoded while layer output is off") && hasPassed;
+
+		layerManager.detachFromNoraFile();
+		hasPassed = check(NoraFileHandler::writeToDisk(savedPath, heightMapTexData, layerManager, NoraThumbnails()), "saving the project") && hasPassed;
+
+		createdTextures.clear();
+		int loadedCount = 0;
+		while (loadedCount < layerManager.getLayerCount() && layerManager.loadPendingLayerData(true))
+			loadedCount++;
+		hasPassed = check(loadedCount == 2, "both layers decoded once layer output is on") && hasPassed;
+		for (int i = 1; i < layerManager.getLayerCount(); i++)
+			hasPassed = check(layerManager.isLayerResident(i) && layerManager.getInputTexId(i) != 0, "layer " + std::to_string(i) + " is blended") && hasPassed;
+		hasPassed = check(createdTextures.size() == 2 && createdTextures[0].width == 8 && createdTextures[0].height == 4 &&
+			createdTextures[1].width == 5 && createdTextures[1].height == 6, "decoded layer sizes") && hasPassed;
+		return hasPassed;
+	}
+}
+
+bool runLayerManagerTests()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "NormalMapGeneratorToolTests";
+	std::error_code errorCode;
+	std::filesystem::create_directories(directory, errorCode);
+	const bool hasPassed = testSaveBeforeLayerOutput(directory);
+	std::filesystem::remove_all(directory, errorCode);
+	std::cout << "\nLayerManager : " << (hasPassed ? "passed" : "failed");
+	return hasPassed;
+}
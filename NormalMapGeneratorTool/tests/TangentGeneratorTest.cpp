@@ -0,0 +1,272 @@
+/*
+Compares TangentGenerator::generateMikkTSpace with the reference MikkTSpace implementation by Morten Mikkelsen
+Every triangle corner has to get exactly the tangent and sign the reference gives it through m_setTSpaceBasic
+The reference is not part of the tree, the test project downloads mikktspace.h and mikktspace.c from
+https://github.com/mmikk/MikkTSpace into includes\MikkTSpace\ before building when they are missing
+*/
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <GLM\glm.hpp>
+#include <MikkTSpace\mikktspace.h>
+#include "MeshData.h"
+#include "TangentGenerator.h"
+#include "Tests.h"
+
+namespace
+{
+	struct TestMesh
+	{
+		std::string name;
+		MeshData mesh;
+	};
+
+	//UVs are stored flipped like the imported meshes, see the flip in TangentGenerator
+	uint32_t addVertex(MeshData& mesh, const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv)
+	{
+		const uint32_t index = mesh.getVertexCount();
+		const float vertex[MeshData::FLOATS_PER_VERTEX] = { position.x, position.y, position.z, normal.x, normal.y, normal.z, uv.x, 1.0f - uv.y,
+			0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + MeshData::FLOATS_PER_VERTEX);
+		return index;
+	}
+
+	void addTriangle(MeshData& mesh, uint32_t a, uint32_t b, uint32_t c)
+	{
+		mesh.indices.push_back(a);
+		mesh.indices.push_back(b);
+		mesh.indices.push_back(c);
+	}
+
+	//Bumpy grid with smooth normals, mirrorU mirrors the UVs of the right half around a shared seam column
+	TestMesh createGrid(const std::string& name, int size, bool mirrorU)
+	{
+		TestMesh testMesh;
+		testMesh.name = name;
+		for (int y = 0; y <= size; y++)
+		{
+			for (int x = 0; x <= size; x++)
+			{
+				const float u = static_cast<float>(x) / size;
+				const float v = static_cast<float>(y) / size;
+				const float height = 0.2f * std::sin(u * 5.0f) * std::cos(v * 3.0f);
+				const glm::vec3 normal = glm::normalize(glm::vec3(-std::cos(u * 5.0f) * std::cos(v * 3.0f), 1.0f, std::sin(u * 5.0f) * std::sin(v * 3.0f) * 0.6f));
+				const float mirroredU = (mirrorU && u > 0.5f) ? 1.0f - u : u;
+				addVertex(testMesh.mesh, glm::vec3(u, height, v), normal, glm::vec2(mirroredU, v));
+			}
+		}
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const uint32_t corner = static_cast<uint32_t>(y * (size + 1) + x);
+				addTriangle(testMesh.mesh, corner, corner + size + 1, corner + 1);
+				addTriangle(testMesh.mesh, corner + 1, corner + size + 1, corner + size + 2);
+			}
+		}
+		return testMesh;
+	}
+
+	//Hard edged cube with 4 vertices per face
+	TestMesh createCube()
+	{
+		TestMesh testMesh;
+		testMesh.name = "cube";
+		const glm::vec3 normals[6] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+		for (const glm::vec3& normal : normals)
+		{
+			const glm::vec3 side = (std::fabs(normal.y) > 0.5f) ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+			const glm::vec3 other = glm::cross(normal, side);
+			const uint32_t first = addVertex(testMesh.mesh, normal - side - other, normal, glm::vec2(0, 0));
+			addVertex(testMesh.mesh, normal + side - other, normal, glm::vec2(1, 0));
+			addVertex(testMesh.mesh, normal + side + other, normal, glm::vec2(1, 1));
+			addVertex(testMesh.mesh, normal - side + other, normal, glm::vec2(0, 1));
+			addTriangle(testMesh.mesh, first, first + 1, first + 2);
+			addTriangle(testMesh.mesh, first, first + 2, first + 3);
+		}
+		return testMesh;
+	}
+
+	//UV sphere, the seam column is duplicated and the pole rows collapse to single positions
+	TestMesh createSphere(int rings, int segments)
+	{
+		TestMesh testMesh;
+		testMesh.name = "sphere";
+		for (int ring = 0; ring <= rings; ring++)
+		{
+			const float v = static_cast<float>(ring) / rings;
+			const float theta = v * 3.14159265f;
+			for (int segment = 0; segment <= segments; segment++)
+			{
+				const float u = static_cast<float>(segment) / segments;
+				const float phi = u * 6.28318531f;
+				const glm::vec3 position(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+				addVertex(testMesh.mesh, position, position, glm::vec2(u, v));
+			}
+		}
+		for (int ring = 0; ring < rings; ring++)
+		{
+			for (int segment = 0; segment < segments; segment++)
+			{
+				const uint32_t corner = static_cast<uint32_t>(ring * (segments + 1) + segment);
+				addTriangle(testMesh.mesh, corner, corner + 1, corner + segments + 1);
+				addTriangle(testMesh.mesh, corner + 1, corner + segments + 2, corner + segments + 1);
+			}
+		}
+		return testMesh;
+	}
+
+	//A fan with a repeated index, a zero area triangle, a triangle of one repeated position, one without UV area and a
+	//triangle sharing its vertices with a proper one so the degenerate corners have a basis to copy
+	TestMesh createDegenerates()
+	{
+		TestMesh testMesh = createGrid("degenerate", 3, false);
+		MeshData& mesh = testMesh.mesh;
+		const glm::vec3 up(0, 1, 0);
+		addTriangle(mesh, 0, 0, 1);
+		addTriangle(mesh, 5, 6, 5);
+		const uint32_t a = addVertex(mesh, glm::vec3(2, 0, 0), up, glm::vec2(0.1f, 0.1f));
+		const uint32_t b = addVertex(mesh, glm::vec3(3, 0, 0), up, glm::vec2(0.2f, 0.1f));
+		const uint32_t c = addVertex(mesh, glm::vec3(4, 0, 0), up, glm::vec2(0.3f, 0.2f));
+		addTriangle(mesh, a, b, c);
+		const uint32_t d = addVertex(mesh, glm::vec3(5, 0, 0), up, glm::vec2(0.4f, 0.4f));
+		const uint32_t e = addVertex(mesh, glm::vec3(5, 0, 0), up, glm::vec2(0.5f, 0.4f));
+		const uint32_t f = addVertex(mesh, glm::vec3(6, 0, 1), up, glm::vec2(0.5f, 0.5f));
+		addTriangle(mesh, d, e, f);
+		const uint32_t g = addVertex(mesh, glm::vec3(7, 0, 0), up, glm::vec2(0.6f, 0.6f));
+		const uint32_t h = addVertex(mesh, glm::vec3(8, 0, 0), up, glm::vec2(0.6f, 0.6f));
+		const uint32_t i = addVertex(mesh, glm::vec3(8, 0, 1), up, glm::vec2(0.6f, 0.6f));
+		addTriangle(mesh, g, h, i);
+		return testMesh;
+	}
+
+	//Every other triangle of a grid uses copies of its vertices with the zero components stored as -0, which the
+	//reference welds with the originals since it compares the floats with ==
+	TestMesh createSignedZeroGrid()
+	{
+		TestMesh testMesh = createGrid("signed zero grid", 8, false);
+		MeshData& mesh = testMesh.mesh;
+		const unsigned int vertexCount = mesh.getVertexCount();
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			std::vector<float> vertex(mesh.vertices.begin() + static_cast<size_t>(i) * MeshData::FLOATS_PER_VERTEX,
+				mesh.vertices.begin() + static_cast<size_t>(i + 1) * MeshData::FLOATS_PER_VERTEX);
+			for (float& value : vertex)
+			{
+				if (value == 0.0f)
+					value = -0.0f;
+			}
+			mesh.vertices.insert(mesh.vertices.end(), vertex.begin(), vertex.end());
+		}
+		for (size_t i = 3; i < mesh.indices.size(); i += 6)
+		{
+			for (size_t corner = i; corner < i + 3; corner++)
+				mesh.indices[corner] += vertexCount;
+		}
+		return testMesh;
+	}
+
+	struct ReferenceCorner
+	{
+		glm::vec3 tangent;
+		float sign;
+	};
+
+	struct ReferenceMesh
+	{
+		const MeshData* mesh;
+		std::vector<ReferenceCorner> corners;
+	};
+
+	const float* getReferenceVertex(const SMikkTSpaceContext* context, int face, int corner)
+	{
+		const MeshData& mesh = *static_cast<ReferenceMesh*>(context->m_pUserData)->mesh;
+		return &mesh.vertices[static_cast<size_t>(mesh.indices[face * 3 + corner]) * MeshData::FLOATS_PER_VERTEX];
+	}
+
+	std::vector<ReferenceCorner> runReference(const MeshData& mesh)
+	{
+		ReferenceMesh referenceMesh;
+		referenceMesh.mesh = &mesh;
+		referenceMesh.corners.resize(mesh.indices.size());
+		SMikkTSpaceInterface referenceInterface = {};
+		referenceInterface.m_getNumFaces = [](const SMikkTSpaceContext* context)
+		{
+			return static_cast<int>(static_cast<ReferenceMesh*>(context->m_pUserData)->mesh->indices.size() / 3);
+		};
+		referenceInterface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext*, const int) { return 3; };
+		referenceInterface.m_getPosition = [](const SMikkTSpaceContext* context, float position[], const int face, const int corner)
+		{
+			const float* const vertex = getReferenceVertex(context, face, corner);
+			position[0] = vertex[0];
+			position[1] = vertex[1];
+			position[2] = vertex[2];
+		};
+		referenceInterface.m_getNormal = [](const SMikkTSpaceContext* context, float normal[], const int face, const int corner)
+		{
+			const float* const vertex = getReferenceVertex(context, face, corner);
+			normal[0] = vertex[3];
+			normal[1] = vertex[4];
+			normal[2] = vertex[5];
+		};
+		referenceInterface.m_getTexCoord = [](const SMikkTSpaceContext* context, float texCoord[], const int face, const int corner)
+		{
+			const float* const vertex = getReferenceVertex(context, face, corner);
+			texCoord[0] = vertex[6];
+			texCoord[1] = 1.0f - vertex[7];
+		};
+		referenceInterface.m_setTSpaceBasic = [](const SMikkTSpaceContext* context, const float tangent[], const float sign, const int face, const int corner)
+		{
+			ReferenceCorner& referenceCorner = static_cast<ReferenceMesh*>(context->m_pUserData)->corners[face * 3 + corner];
+			referenceCorner.tangent = glm::vec3(tangent[0], tangent[1], tangent[2]);
+			referenceCorner.sign = sign;
+		};
+		SMikkTSpaceContext context;
+		context.m_pInterface = &referenceInterface;
+		context.m_pUserData = &referenceMesh;
+		genTangSpaceDefault(&context);
+		return referenceMesh.corners;
+	}
+
+	bool compareWithReference(const TestMesh& testMesh)
+	{
+		const std::vector<ReferenceCorner> expected = runReference(testMesh.mesh);
+		MeshData generated = testMesh.mesh;
+		TangentGenerator::generateMikkTSpace(generated);
+		size_t mismatchCount = 0;
+		for (size_t i = 0; i < generated.indices.size(); i++)
+		{
+			const float* const vertex = &generated.vertices[static_cast<size_t>(generated.indices[i]) * MeshData::FLOATS_PER_VERTEX];
+			const glm::vec3 normal(vertex[3], vertex[4], vertex[5]);
+			const glm::vec3 tangent(vertex[8], vertex[9], vertex[10]);
+			const glm::vec3 bitangent(vertex[11], vertex[12], vertex[13]);
+			const float sign = (glm::dot(bitangent, glm::cross(normal, tangent)) < 0.0f) ? -1.0f : 1.0f;
+			if (tangent == expected[i].tangent && sign == expected[i].sign)
+				continue;
+			if (mismatchCount++ < 5)
+			{
+				std::cout << "\n" << testMesh.name << " corner " << i << " : (" << tangent.x << ", " << tangent.y << ", " << tangent.z << ") " << sign
+					<< " expected (" << expected[i].tangent.x << ", " << expected[i].tangent.y << ", " << expected[i].tangent.z << ") " << expected[i].sign;
+			}
+		}
+		std::cout << "\n" << testMesh.name << " : " << ((mismatchCount == 0) ? "matches" : std::to_string(mismatchCount) + " corners differ");
+		return mismatchCount == 0;
+	}
+}
+
+bool runTangentGeneratorTests()
+{
+	std::vector<TestMesh> testMeshes;
+	testMeshes.push_back(createGrid("grid", 16, false));
+	testMeshes.push_back(createGrid("mirrored grid", 16, true));
+	testMeshes.push_back(createCube());
+	testMeshes.push_back(createSphere(12, 24));
+	testMeshes.push_back(createDegenerates());
+	testMeshes.push_back(createSignedZeroGrid());
+	bool isMatching = true;
+	for (const TestMesh& testMesh : testMeshes)
+		isMatching = compareWithReference(testMesh) && isMatching;
+	std::cout << "\nTangentGenerator : " << (isMatching ? "passed" : "failed");
+	return isMatching;
+}
@@ -0,0 +1,15 @@
+/*
+Tests of the parts of the tool that run without a window or GL context
+NormalMapGeneratorToolTests.vcxproj runs them after every build, a failing test fails the build
+*/
+#include <iostream>
+#include "Tests.h"
+
+int main()
+{
+	bool hasPassed = true;
+	hasPassed = runLayerManagerTests() && hasPassed;
+	hasPassed = runTangentGeneratorTests() && hasPassed;
+	std::cout << (hasPassed ? "\nAll tests passed\n" : "\nTests failed\n");
+	return hasPassed ? 0 : 1;
+}
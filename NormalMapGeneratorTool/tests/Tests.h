@@ -0,0 +1,4 @@
+#pragma once
+//Each returns true if every check passed, failures are printed to std::cout
+bool runLayerManagerTests();
+bool runTangentGeneratorTests();